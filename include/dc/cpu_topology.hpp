@@ -0,0 +1,82 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/list.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+/// A physical core and the logical CPUs (SMT siblings) it runs.
+struct CpuCore {
+  /// OS CPU numbers of the hardware threads on this core, as used for thread
+  /// affinity. Never empty.
+  List<u32> cpus;
+
+  /// Socket the core sits in.
+  u32 package = 0;
+
+  /// NUMA node the core belongs to, in [0, CpuTopology::nodeCount).
+  u32 node = 0;
+};
+
+/// The CPUs this process may run on, grouped by physical core.
+///
+/// On Linux this is read from /sys/devices/system/cpu and
+/// /sys/devices/system/node, limited to the CPUs in the affinity mask of the
+/// process. Elsewhere, or if sysfs can not be read, every logical CPU is
+/// reported as a core of its own on a single node.
+struct CpuTopology {
+  /// Ordered by the lowest CPU number on each core.
+  List<CpuCore> cores;
+
+  /// Number of NUMA nodes with at least one usable CPU. Node numbers are
+  /// remapped to be dense.
+  u32 nodeCount = 1;
+
+  [[nodiscard]] u32 coreCount() const {
+    return static_cast<u32>(cores.getSize());
+  }
+
+  /// Number of logical CPUs, that is hardware threads, over all cores.
+  [[nodiscard]] u32 logicalCpuCount() const;
+};
+
+/// Discover the CPU topology. Not cheap, it reads a few files per CPU, so do
+/// it once and keep the result.
+[[nodiscard]] CpuTopology queryCpuTopology();
+
+/// Parse a Linux CPU list, such as "0-3,8,10-11", appending the CPU numbers to
+/// out. Same format is used for node lists.
+/// @return false if the text is malformed. out may then be partially filled.
+[[nodiscard]] bool parseCpuList(const char* text, List<u32>& out);
+
+/// Restrict the calling thread to the given logical CPUs.
+/// @return false if the platform does not support it or the OS refused, the
+///         thread then keeps its old affinity.
+bool setCurrentThreadAffinity(const u32* cpus, usize count);
+
+}  // namespace dc
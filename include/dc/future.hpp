@@ -0,0 +1,252 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/assert.hpp>
+#include <dc/job/job.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/macros.hpp>
+#include <dc/result.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <memory>
+#include <optional>
+
+namespace dc {
+
+namespace detail {
+
+/// What a Future and the job producing its value share. One allocation holds
+/// the value and the counter the job completes, which is what awaiting and
+/// continuations work on.
+template <typename T>
+struct FutureState {
+  explicit FutureState(JobSystem* system) noexcept : counter(1u, system) {}
+
+  DC_DELETE_COPY(FutureState);
+  DC_DELETE_MOVE(FutureState);
+
+  /// Run the function and keep what it returns. Called by the job, before it
+  /// decrements the counter, which publishes the value.
+  template <typename Fn, typename... Args>
+  void produce(Fn& fn, Args&&... args) {
+    value.emplace(fn(dc::forward<Args>(args)...));
+  }
+
+  JobCounter counter;
+  std::optional<T> value;
+};
+
+template <>
+struct FutureState<void> {
+  explicit FutureState(JobSystem* system) noexcept : counter(1u, system) {}
+
+  DC_DELETE_COPY(FutureState);
+  DC_DELETE_MOVE(FutureState);
+
+  template <typename Fn, typename... Args>
+  void produce(Fn& fn, Args&&... args) {
+    fn(dc::forward<Args>(args)...);
+  }
+
+  JobCounter counter;
+};
+
+/// What a continuation of a Future<T> returns.
+template <typename T, typename Fn>
+struct ThenResult {
+  using Type = InvokeResultT<DecayT<Fn>&, T&&>;
+};
+
+template <typename Fn>
+struct ThenResult<void, Fn> {
+  using Type = InvokeResultT<DecayT<Fn>&>;
+};
+
+/// The counter of the state, sharing ownership of the whole state. Set on the
+/// job that produces the value, so the state outlives it.
+template <typename T>
+std::shared_ptr<JobCounter> futureCounter(
+    const std::shared_ptr<FutureState<T>>& state) {
+  return std::shared_ptr<JobCounter>(state, &state->counter);
+}
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Future
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// The value a job returns, once it has run. See JobSystem::submit().
+///
+/// The value and the completion counter live in a single shared allocation,
+/// so a job that returns a value costs no more than a batch of one. A job
+/// that can fail returns a dc::Result, and the future then holds the Result.
+///
+/// Move-only, the value can be taken out once, by get(), tryGet() or then().
+/// A default constructed future is empty.
+///
+/// Usage:
+/// @code
+///   dc::Future<s32> sum = js.submit([&data] { return add(data); });
+///   dc::Future<dc::Result<Mesh, LoadErr>> mesh =
+///       js.submit([path] { return loadMesh(path); });
+///
+///   dc::Future<f32> mean =
+///       sum.then([count](s32 total) { return f32(total) / count; });
+///   f32 value = mean.get();  // helps run jobs until it is there
+/// @endcode
+template <typename T>
+class [[nodiscard]] Future {
+ public:
+  /// Construct an empty future.
+  Future() = default;
+
+  explicit Future(std::shared_ptr<detail::FutureState<T>> state)
+      : m_state(dc::move(state)) {}
+
+  DC_DELETE_COPY(Future);
+  DC_DEFAULT_MOVE(Future);
+
+  /// False for an empty future, or one whose value was taken.
+  [[nodiscard]] bool isValid() const { return m_state != nullptr; }
+
+  /// True once the job has run and the value is there.
+  [[nodiscard]] bool isReady() const {
+    DC_ASSERT(m_state, "Future is empty");
+    return m_state->counter.isDone();
+  }
+
+  /// Block until the value is there, running pending jobs meanwhile. See
+  /// JobSystem::await().
+  void await() const {
+    DC_ASSERT(m_state, "Future is empty");
+    JobSystem* system = m_state->counter.system();
+    system->await(m_state->counter);
+  }
+
+  /// Wait for the value, see await(), and take it out of the future, which
+  /// is empty after.
+  T get() {
+    await();
+    return take();
+  }
+
+  /// Take the value if it is there, without blocking. The future is empty
+  /// after, unless it returns None.
+  [[nodiscard]] Option<T> tryGet()
+    requires(!isSame<T, void>)
+  {
+    if (!isReady()) return None;
+    // After isReady(), so not mistaken for a moved-from value.
+    return Some<T>(take());
+  }
+
+  /// For Future<void>: true if the job has run. The future is empty after.
+  [[nodiscard]] bool tryGet()
+    requires(isSame<T, void>)
+  {
+    if (!isReady()) return false;
+    m_state.reset();
+    return true;
+  }
+
+  /// Run the function on the value once it is there, as a job of its own.
+  /// The value is moved into the function, and the future is empty after.
+  ///
+  /// The function is stored in a Job together with two pointers, so it gets
+  /// kJobCaptureBytes - 24 bytes of captures.
+  /// @return A future for what the function returns.
+  template <typename Fn>
+  Future<typename detail::ThenResult<T, Fn>::Type> then(
+      Fn&& fn, JobPriority priority = JobPriority::Normal);
+
+  /// A handle that completes along with the future, for whenAll() and for
+  /// co_await in a Task. Does not give access to the value.
+  [[nodiscard]] JobHandle handle() const {
+    DC_ASSERT(m_state, "Future is empty");
+    return JobHandle{detail::futureCounter(m_state)};
+  }
+
+ private:
+  T take() {
+    DC_ASSERT(m_state, "Future is empty");
+    std::shared_ptr<detail::FutureState<T>> state = dc::move(m_state);
+    if constexpr (!isSame<T, void>) return dc::move(*state->value);
+  }
+
+  std::shared_ptr<detail::FutureState<T>> m_state;
+};
+
+template <typename T>
+template <typename Fn>
+Future<typename detail::ThenResult<T, Fn>::Type> Future<T>::then(
+    Fn&& fn, JobPriority priority) {
+  DC_ASSERT(m_state, "Cannot chain onto an empty Future");
+  using U = typename detail::ThenResult<T, Fn>::Type;
+
+  JobSystem* system = m_state->counter.system();
+  auto next = std::make_shared<detail::FutureState<U>>(system);
+
+  // Keeps the state alive until the continuation has moved the value out,
+  // the job that produced it is gone by then.
+  std::shared_ptr<detail::FutureState<T>> prev = dc::move(m_state);
+  JobCounter& prevCounter = prev->counter;
+
+  Job job{[prev = dc::move(prev), next = next.get(),
+           fn = dc::forward<Fn>(fn)]() mutable {
+            if constexpr (isSame<T, void>) {
+              next->produce(fn);
+            } else {
+              next->produce(fn, dc::move(*prev->value));
+            }
+          },
+          priority};
+  job.counter = detail::futureCounter(next);
+  prevCounter.addContinuation(dc::move(job));
+
+  return Future<U>{dc::move(next)};
+}
+
+template <typename Fn>
+auto JobSystem::submit(Fn&& fn, JobPriority priority)
+    -> Future<InvokeResultT<DecayT<Fn>&>> {
+  using T = InvokeResultT<DecayT<Fn>&>;
+  auto state = std::make_shared<detail::FutureState<T>>(this);
+
+  // The job holds the state through its counter, a plain pointer is enough.
+  Job job{[state = state.get(), fn = dc::forward<Fn>(fn)]() mutable {
+            state->produce(fn);
+          },
+          priority};
+  job.counter = detail::futureCounter(state);
+  add(dc::move(job));
+
+  return Future<T>{dc::move(state)};
+}
+
+}  // namespace dc
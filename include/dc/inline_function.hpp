@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <dc/assert.hpp>
+#include <dc/macros.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <new>
+#include <type_traits>
+
+namespace dc {
+
+template <typename Signature, usize Capacity = 48>
+class InlineFunction;
+
+/// Move-only callable wrapper that stores the callable inside the object.
+///
+/// Unlike std::function it never allocates: a callable that does not fit in
+/// Capacity bytes is a compile error rather than a heap allocation. Capture
+/// less, or capture by pointer, to make it fit.
+///
+/// The callable must be nothrow move constructible, since moving an
+/// InlineFunction moves the callable along with it, and may not be aligned
+/// stricter than a pointer.
+///
+/// Usage:
+/// @code
+///   dc::InlineFunction<s32(s32), 16> addTen = [ten = 10](s32 x) {
+///     return x + ten;
+///   };
+///   addTen(5);  // 15
+/// @endcode
+template <typename R, typename... Args, usize Capacity>
+class InlineFunction<R(Args...), Capacity> {
+ public:
+  static constexpr usize kCapacity = Capacity;
+  static constexpr usize kAlignment = alignof(void*);
+
+  /// Construct an empty function. Calling it is an error.
+  InlineFunction() = default;
+
+  template <typename Fn>
+    requires(!isSame<DecayT<Fn>, InlineFunction>)
+  InlineFunction(Fn&& fn) {
+    using Stored = DecayT<Fn>;
+    static_assert(std::is_invocable_r_v<R, Stored&, Args...>,
+                  "Cannot call 'Fn' with the arguments of the signature.");
+    static_assert(sizeof(Stored) <= Capacity,
+                  "Callable does not fit in the InlineFunction, capture less.");
+    static_assert(alignof(Stored) <= kAlignment,
+                  "Callable is over aligned for the InlineFunction.");
+    static_assert(std::is_nothrow_move_constructible_v<Stored>,
+                  "Callable must be nothrow move constructible.");
+
+    new (m_storage) Stored(static_cast<Fn&&>(fn));
+    m_ops = &kOps<Stored>;
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept : m_ops(other.m_ops) {
+    if (m_ops) {
+      m_ops->relocate(m_storage, other.m_storage);
+      other.m_ops = nullptr;
+    }
+  }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (&other != this) {
+      reset();
+      if (other.m_ops) {
+        other.m_ops->relocate(m_storage, other.m_storage);
+        m_ops = other.m_ops;
+        other.m_ops = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  DC_DELETE_COPY(InlineFunction);
+
+  ~InlineFunction() { reset(); }
+
+  R operator()(Args... args) {
+    DC_ASSERT(m_ops, "Called an empty InlineFunction.");
+    return m_ops->invoke(m_storage, static_cast<Args&&>(args)...);
+  }
+
+  /// Destroy the callable, leaving the function empty.
+  void reset() {
+    if (m_ops) {
+      m_ops->destroy(m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+  [[nodiscard]] bool isEmpty() const { return m_ops == nullptr; }
+
+  explicit operator bool() const { return m_ops != nullptr; }
+
+ private:
+  /// Type erased operations on the stored callable. One static instance per
+  /// callable type, so an InlineFunction only carries a single pointer on top
+  /// of its storage.
+  struct Ops {
+    R (*invoke)(void* storage, Args&&... args);
+
+    /// Move construct into dst and destroy src.
+    void (*relocate)(void* dst, void* src);
+
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Stored>
+  static constexpr Ops kOps = {
+      [](void* storage, Args&&... args) -> R {
+        return (*static_cast<Stored*>(storage))(static_cast<Args&&>(args)...);
+      },
+      [](void* dst, void* src) {
+        Stored* from = static_cast<Stored*>(src);
+        new (dst) Stored(dc::move(*from));
+        from->~Stored();
+      },
+      [](void* storage) { static_cast<Stored*>(storage)->~Stored(); },
+  };
+
+  alignas(kAlignment) std::byte m_storage[Capacity];
+  const Ops* m_ops = nullptr;
+};
+
+}  // namespace dc
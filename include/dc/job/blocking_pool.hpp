@@ -0,0 +1,113 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <dc/job/job.hpp>
+#include <dc/list.hpp>
+#include <dc/macros.hpp>
+#include <dc/types.hpp>
+#include <mutex>
+#include <thread>
+
+namespace dc {
+
+/// Threads for jobs that block, such as file reads, fsync or sleeps, kept
+/// apart from the compute workers. See JobSystem::addBlocking().
+///
+/// A blocked thread costs no CPU, so the pool is not sized by the number of
+/// cores. A thread is started whenever a job arrives and there are more
+/// queued jobs than idle threads, up to maxThreads, and a thread stops again
+/// once it has been idle for idleTimeout. Threads that stopped are joined
+/// when the next one starts. Jobs run in the order they were added.
+///
+/// Thread-safe. A single mutex guards the queue, which is fine for jobs that
+/// spend far longer blocked than it takes to hand them over.
+class BlockingPool {
+ public:
+  BlockingPool(u32 maxThreads, u64 idleTimeoutNs);
+
+  /// Waits for the queued jobs, see stop().
+  ~BlockingPool();
+
+  DC_DELETE_COPY(BlockingPool);
+  DC_DELETE_MOVE(BlockingPool);
+
+  /// Queue a job, starting a thread for it if none is idle. Once stopped, or
+  /// if no thread can be started at all, runs the job on the calling thread.
+  void add(Job&& job);
+
+  /// Run what is queued, then join every thread.
+  void stop();
+
+  /// Threads running right now, busy or idle.
+  [[nodiscard]] u32 threadCount() const;
+
+  /// Jobs run by the pool's threads so far.
+  [[nodiscard]] u64 jobsRun() const {
+    return m_jobsRun.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void threadLoop();
+
+  /// Join the threads that stopped. Called under m_mutex.
+  void joinExited();
+
+  /// Jobs waiting for a thread. Called under m_mutex.
+  [[nodiscard]] u64 queuedCount() const {
+    return m_jobs.getSize() - m_nextJob;
+  }
+
+  /// Take the oldest queued job. Called under m_mutex.
+  [[nodiscard]] Job takeJob();
+
+  u32 m_maxThreads;
+  std::chrono::nanoseconds m_idleTimeout;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_ready;
+
+  /// Queued jobs from m_nextJob on, oldest first. The slots before it were
+  /// taken already, and are reused once they are half of the list.
+  List<Job> m_jobs;
+  u64 m_nextJob = 0;
+
+  /// Every thread not joined yet, and the ids of the ones that stopped.
+  List<std::thread> m_threads;
+  List<std::thread::id> m_exited;
+
+  /// Threads that have not stopped, and how many of them wait for a job.
+  u32 m_running = 0;
+  u32 m_idle = 0;
+
+  bool m_stopping = false;
+
+  std::atomic<u64> m_jobsRun{0};
+};
+
+}  // namespace dc
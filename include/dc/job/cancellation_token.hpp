@@ -0,0 +1,88 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <dc/assert.hpp>
+#include <dc/macros.hpp>
+#include <memory>
+
+namespace dc {
+
+/// Shared flag that cancels batches of jobs, see JobSystem::add().
+///
+/// Jobs of a batch added with a token are skipped once it is cancelled, as
+/// long as they have not started yet. They still count as done, so awaiting
+/// the batch returns as soon as the running jobs finish. Running jobs are not
+/// interrupted; long ones capture a copy of the token and poll isCancelled().
+///
+/// Copies share the flag, so one token can cancel every batch of a request.
+/// A default constructed token is empty and never cancelled, it costs
+/// nothing to pass one along.
+///
+/// Usage:
+/// @code
+///   const dc::CancellationToken token = dc::CancellationToken::create();
+///   dc::JobHandle handle = js.add(jobs, token);
+///   // ... the request timed out ...
+///   token.cancel();
+///   handle.await();  // only waits for the jobs already running
+/// @endcode
+class CancellationToken {
+ public:
+  /// An empty token, it can not be cancelled.
+  CancellationToken() = default;
+
+  DC_DEFAULT_COPY(CancellationToken);
+  DC_DEFAULT_MOVE(CancellationToken);
+
+  /// A token of its own that can be cancelled.
+  [[nodiscard]] static CancellationToken create() {
+    CancellationToken token;
+    token.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    return token;
+  }
+
+  /// Cancel every batch that shares the token. Thread-safe, and may be called
+  /// more than once. Must not be called on an empty token.
+  void cancel() const {
+    DC_ASSERT(m_cancelled, "Cannot cancel an empty CancellationToken");
+    m_cancelled->store(true, std::memory_order_relaxed);
+  }
+
+  /// Cheap enough to poll in a loop. Thread-safe.
+  [[nodiscard]] bool isCancelled() const {
+    return m_cancelled && m_cancelled->load(std::memory_order_relaxed);
+  }
+
+  /// False for an empty token.
+  [[nodiscard]] bool canBeCancelled() const { return m_cancelled != nullptr; }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+}  // namespace dc
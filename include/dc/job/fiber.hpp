@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/job/scratch_arena.hpp>
+#include <dc/macros.hpp>
+#include <dc/platform.hpp>
+#include <dc/types.hpp>
+
+/// Fibers need a hand-written context switch, which only exists for x86-64
+/// Linux. Elsewhere JobSystem ignores FiberConfig::enabled.
+#if defined(DC_PLATFORM_LINUX) && defined(__x86_64__)
+#define DC_JOB_FIBERS 1
+#else
+#define DC_JOB_FIBERS 0
+#endif
+
+namespace dc {
+
+struct JobCounter;
+struct PooledJob;
+struct Worker;
+
+/// Saved state of a suspended execution context: a fiber, or the worker
+/// thread's own stack.
+struct FiberContext {
+  /// Stack pointer to resume at. The callee-saved registers are on the stack.
+  void* stackPointer = nullptr;
+
+  /// Bounds of the stack, for AddressSanitizer, which has to be told about
+  /// every stack switch.
+  const void* stackBottom = nullptr;
+  usize stackSize = 0;
+};
+
+/// A user-space stack that jobs run on, so that a job can be suspended in the
+/// middle and resumed later, possibly on another worker thread.
+struct Fiber {
+  /// Map a stack with a guard page below it, and prepare the context so that
+  /// the first switch to it calls entry(fiber).
+  /// @return nullptr if the stack could not be mapped.
+  [[nodiscard]] static Fiber* create(usize stackSize, void (*entry)(Fiber*));
+
+  /// Unmap the stack. The fiber must not be running.
+  static void destroy(Fiber* fiber);
+
+  DC_DELETE_COPY(Fiber);
+  DC_DELETE_MOVE(Fiber);
+
+  FiberContext context;
+
+  /// The worker currently running the fiber. Updated on every resume.
+  Worker* worker = nullptr;
+
+  /// The job the fiber runs, nullptr while the fiber is free.
+  PooledJob* job = nullptr;
+
+  /// Set while the fiber is switching out to wait for the counter. The worker
+  /// registers the resume once it is off the fiber's stack.
+  JobCounter* waitingOn = nullptr;
+
+  /// When the job started, for tracing.
+  u64 beginNs = 0;
+
+  /// Scratch arena the job allocated from. Kept while the job waits.
+  ScratchHolds scratchHolds;
+
+ private:
+  Fiber() = default;
+
+  /// The whole mapping, guard page included.
+  void* m_mapping = nullptr;
+  usize m_mappingSize = 0;
+};
+
+/// Save the calling context into from and resume to. Returns when something
+/// switches back to from, which may be on another thread when from is a
+/// fiber.
+void switchFiber(FiberContext& from, FiberContext& to);
+
+}  // namespace dc
@@ -24,16 +24,65 @@
 
 #pragma once
 
-#include <functional>
+#include <dc/inline_function.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <memory>
 
 namespace dc {
 
+struct JobCounter;
+
+/// Scheduling priority of a job. Workers always run the highest priority job
+/// they can find, except for a small quota of background jobs that keeps the
+/// background lane from starving, see JobSystemConfig::backgroundQuota.
+enum class JobPriority : u8 {
+  High = 0,
+  Normal,
+  Background,
+};
+
+constexpr u32 kJobPriorityCount = 3;
+
+/// Bytes of capture storage in a Job. A closure that does not fit is a compile
+/// error, capture a pointer to the data instead.
+constexpr usize kJobCaptureBytes = 48;
+
 /// A single unit of work to be executed by a worker thread.
+///
+/// Move-only, and the closure is stored inline, so creating and submitting a
+/// job never allocates.
 struct Job {
-  std::function<void()> fn;
+  Job() = default;
+
+  template <typename Fn>
+    requires(!isSame<DecayT<Fn>, Job>)
+  explicit Job(Fn&& function, JobPriority jobPriority = JobPriority::Normal)
+      : fn(static_cast<Fn&&>(function)), priority(jobPriority) {}
+
+  InlineFunction<void(), kJobCaptureBytes> fn;
+
+  /// Batch the job belongs to, if any. Decremented after fn has run.
+  /// Set by the JobSystem, not by the user.
+  std::shared_ptr<JobCounter> counter;
+
+  JobPriority priority = JobPriority::Normal;
+
+  /// Set by the JobSystem for a job that has to finish on the thread it
+  /// started on, see JobSystem::addToWorker(). It does not run on a fiber,
+  /// which could be resumed on another worker.
+  bool pinned = false;
+
+  /// Set by the JobSystem for a job that counts towards its backlog until it
+  /// starts, see BackpressurePolicy.
+  bool admitted = false;
+
+  /// Execute the job, or skip it if its batch was cancelled, and count it as
+  /// done. Defined in job_handle.hpp, where JobCounter is complete.
+  void run();
 
-  /// Execute the job.
-  void run() { fn(); }
+  /// True if the job belongs to a batch that was cancelled.
+  [[nodiscard]] bool isCancelled() const;
 };
 
 }  // namespace dc
@@ -25,7 +25,12 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <dc/assert.hpp>
+#include <dc/job/cancellation_token.hpp>
+#include <dc/job/job.hpp>
+#include <dc/list.hpp>
 #include <dc/macros.hpp>
 #include <dc/traits.hpp>
 #include <dc/types.hpp>
@@ -34,6 +39,12 @@
 
 namespace dc {
 
+class JobSystem;
+
+namespace detail {
+struct JobHandleAwaiter;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // JobCounter
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,39 +55,133 @@ namespace dc {
 /// counter reaches zero the condition variable is notified, unblocking any
 /// thread waiting in JobHandle::await().
 ///
+/// A counter may also have continuations and dependents. When it reaches zero
+/// the thread that brought it there submits the continuations to the
+/// JobSystem and decrements the dependent counters, which may in turn
+/// complete and release their own continuations. This is what JobHandle::then
+/// and whenAll are built on.
+///
+/// Once the cancellation token of the counter is cancelled, jobs of the batch
+/// that have not started skip their function, see Job::run().
+///
 /// Not intended to be used directly — obtain one via JobHandle.
 struct JobCounter {
-  explicit JobCounter(u32 count) : m_count(count) {}
+  /// @param system JobSystem that continuations are submitted to. May be
+  ///               nullptr if the counter never gets continuations.
+  /// @param token  Cancels the jobs of the batch.
+  explicit JobCounter(u32 count, JobSystem* system = nullptr,
+                      CancellationToken token = {}) noexcept
+      : m_count(count),
+        m_system(system),
+        m_token(dc::move(token)),
+        m_done(count == 0) {}
 
   DC_DELETE_COPY(JobCounter);
   DC_DELETE_MOVE(JobCounter);
 
-  /// Called by a worker thread when one job in the batch completes.
-  /// Notifies waiters when the counter reaches zero.
-  void decrement() {
+  /// Make the counter of a batch, that keeps itself alive until the count
+  /// reaches zero. The jobs of the batch then point at it with jobRef(), and
+  /// do not update a shared reference count each. Every job of the batch
+  /// must run, or the counter leaks.
+  [[nodiscard]] static std::shared_ptr<JobCounter> makeBatch(
+      u32 count, JobSystem* system = nullptr, CancellationToken token = {}) {
+    auto counter =
+        std::make_shared<JobCounter>(count, system, dc::move(token));
+    counter->m_batch = true;
+    if (count > 0) counter->m_self = counter;
+    return counter;
+  }
+
+  /// Made by makeBatch(), so the counter outlives the jobs of the batch that
+  /// are not counted down yet.
+  [[nodiscard]] bool isBatch() const { return m_batch; }
+
+  /// Pointer for a job of a batch made by makeBatch(). Owns nothing.
+  [[nodiscard]] std::shared_ptr<JobCounter> jobRef() {
+    return std::shared_ptr<JobCounter>(std::shared_ptr<JobCounter>{}, this);
+  }
+
+  /// Called when count jobs in the batch complete, one by one or together.
+  /// Notifies waiters and releases continuations when the counter reaches
+  /// zero.
+  void decrement(u32 count = 1u) {
     // Release so that job side-effects are visible to the awaiting thread.
-    if (m_count.fetch_sub(1u, std::memory_order_release) == 1u) {
-      std::scoped_lock lock(m_mutex);
-      m_cv.notify_all();
+    if (m_count.fetch_sub(count, std::memory_order_release) == count) {
+      complete();
     }
   }
 
+  /// Add jobs to a batch that is not done yet. The caller must hold one of
+  /// the counts itself, as a running job of the batch does, so that the count
+  /// can not reach zero meanwhile.
+  void increment(u32 count = 1u) {
+    DC_ASSERT(m_count.load(std::memory_order_relaxed) > 0,
+              "Cannot add to a batch that is done");
+    m_count.fetch_add(count, std::memory_order_relaxed);
+  }
+
   /// Block the calling thread until all jobs in the batch have completed.
+  ///
+  /// Waits for complete() rather than for the count, so that once this
+  /// returns no other thread will touch the counter again. This makes it safe
+  /// to destroy a counter right after waiting on it.
   void wait() {
     std::unique_lock lock(m_mutex);
-    // Acquire so we see all job side-effects written before decrement.
-    m_cv.wait(lock,
-              [this] { return m_count.load(std::memory_order_acquire) == 0u; });
+    // complete() issues the acquire fence, so we see all job side-effects.
+    m_cv.wait(lock, [this] { return m_done; });
+  }
+
+  /// Like wait(), but gives up after the timeout.
+  /// @return true if the counter is done.
+  bool waitFor(std::chrono::microseconds timeout) {
+    std::unique_lock lock(m_mutex);
+    return m_cv.wait_for(lock, timeout, [this] { return m_done; });
   }
 
   [[nodiscard]] bool isDone() const {
     return m_count.load(std::memory_order_acquire) == 0u;
   }
 
+  /// Jobs of the batch that have not been counted down yet. Relaxed, so only
+  /// a hint: it may be out of date by the time it returns.
+  [[nodiscard]] u32 remaining() const {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  /// Submit the job once the counter reaches zero, or right away if it
+  /// already has.
+  void addContinuation(Job job);
+
+  /// Decrement the dependent once the counter reaches zero, or right away if
+  /// it already has.
+  void addDependent(std::shared_ptr<JobCounter> dependent);
+
+  [[nodiscard]] JobSystem* system() const { return m_system; }
+
+  [[nodiscard]] const CancellationToken& token() const { return m_token; }
+
+  [[nodiscard]] bool isCancelled() const { return m_token.isCancelled(); }
+
  private:
+  /// Called once, by the thread that brought the count to zero.
+  void complete();
+
   std::atomic<u32> m_count;
+  JobSystem* m_system;
+  CancellationToken m_token;
+  bool m_batch = false;
+
+  /// Guards everything below, and is used with m_cv to wake waiters.
   std::mutex m_mutex;
   std::condition_variable m_cv;
+
+  /// Set by complete(). Continuations added after this run immediately.
+  bool m_done;
+  List<Job> m_continuations;
+  List<std::shared_ptr<JobCounter>> m_dependents;
+
+  /// Set by makeBatch(), released by complete().
+  std::shared_ptr<JobCounter> m_self;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,15 +195,28 @@ struct JobCounter {
 /// is cheap — it copies the shared_ptr). The batch is considered complete when
 /// every job that was part of the batch has called its completion callback.
 ///
+/// Instead of blocking on a batch, follow-up work can be chained onto it with
+/// then(), or onto several batches with whenAll(). The follow-up jobs become
+/// runnable only once their prerequisites are done, and are pushed by the
+/// worker that finishes the last prerequisite, so no thread has to wait in
+/// between stages.
+///
 /// Usage:
 /// @code
 ///   dc::List<dc::Job> jobs;
 ///   // ... fill jobs ...
 ///   dc::JobHandle handle = js.add(jobs);
 ///   handle.await();  // block until all jobs are done
+///
+///   dc::JobHandle a = js.add(stageA);
+///   dc::JobHandle b = js.add(stageB);
+///   dc::whenAll(a, b).then(dc::Job{[] { merge(); }}).await();
 /// @endcode
 class JobHandle {
  public:
+  /// Construct an empty handle. It counts as done and has nothing to await.
+  JobHandle() = default;
+
   /// Construct a handle that wraps an existing counter.
   explicit JobHandle(std::shared_ptr<JobCounter> counter)
       : m_counter(dc::move(counter)) {}
@@ -107,13 +225,81 @@ class JobHandle {
   DC_DEFAULT_MOVE(JobHandle);
 
   /// Block the calling thread until all jobs in the batch have completed.
-  void await() const { m_counter->wait(); }
+  ///
+  /// The calling thread runs other pending jobs while it waits, see
+  /// JobSystem::await(), so awaiting from inside a job neither ties up the
+  /// worker nor deadlocks the pool.
+  void await() const;
 
   /// Returns true if all jobs in the batch have completed.
-  [[nodiscard]] bool isDone() const { return m_counter->isDone(); }
+  [[nodiscard]] bool isDone() const {
+    return !m_counter || m_counter->isDone();
+  }
+
+  /// Returns true if the batch was added with a token that is now cancelled.
+  /// A cancelled batch is done once its running jobs are.
+  [[nodiscard]] bool isCancelled() const {
+    return m_counter && m_counter->isCancelled();
+  }
+
+  /// Run a job once this batch has completed. The continuation shares the
+  /// batch's cancellation token, so cancelling it skips the follow-up stages
+  /// as well.
+  /// Must not be called on an empty handle.
+  /// @return A handle for the continuation.
+  [[nodiscard]] JobHandle then(Job job) const;
+
+  /// Run a batch of jobs once this batch has completed, see then(Job).
+  /// Must not be called on an empty handle.
+  /// @return A handle for the whole continuation batch.
+  [[nodiscard]] JobHandle then(dc::List<Job>& jobs) const;
 
  private:
+  friend JobHandle whenAll(const JobHandle* handles, usize count);
+  friend struct detail::JobHandleAwaiter;
+
   std::shared_ptr<JobCounter> m_counter;
 };
 
+/// Returns a handle that completes once every one of the handles has.
+///
+/// The handles must not all be empty if then() is going to be called on the
+/// result, it needs a JobSystem to submit to.
+/// @param handles Array of count handles. Empty handles count as done.
+[[nodiscard]] JobHandle whenAll(const JobHandle* handles, usize count);
+
+/// Variadic convenience overload of whenAll.
+template <typename... Handles>
+[[nodiscard]] JobHandle whenAll(const JobHandle& first,
+                                const Handles&... rest) {
+  const JobHandle handles[] = {first, rest...};
+  return whenAll(handles, sizeof...(Handles) + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Job
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Jobs running on the calling thread in Job::run(), on a blocking thread,
+/// the owner thread, or a thread that helps while it awaits. A worker thread
+/// holds one for as long as it runs, see JobSystem::workerLoop(). Jobs they
+/// add do not count towards the backlog, see BackpressurePolicy.
+inline thread_local u32 tJobDepth = 0;
+
+}  // namespace detail
+
+inline bool Job::isCancelled() const {
+  return counter && counter->isCancelled();
+}
+
+inline void Job::run() {
+  ++detail::tJobDepth;
+  // A cancelled job still counts as done, or its batch would never be.
+  if (!isCancelled()) fn();
+  if (counter) counter->decrement();
+  --detail::tJobDepth;
+}
+
 }  // namespace dc
@@ -0,0 +1,125 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <dc/job/job.hpp>
+#include <dc/list.hpp>
+#include <dc/macros.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <memory>
+
+namespace dc {
+
+class JobPool;
+
+/// A Job living in a JobPool slot. Work-stealing deques hold pointers to
+/// these so that thieves never copy a Job they may lose the race for.
+struct PooledJob {
+  Job job;
+
+  /// Intrusive free list link. Only valid while the slot is free.
+  PooledJob* next = nullptr;
+
+  /// The pool this slot must be returned to.
+  JobPool* owner = nullptr;
+};
+
+/// Per-worker pool of PooledJob slots.
+///
+/// Only the owning worker thread may acquire() slots. Any thread may release
+/// a slot: the owner pushes it straight onto its private free list, other
+/// threads push it onto a lock-free remote list that the owner reclaims in
+/// one exchange when its private list runs dry.
+///
+/// Slots are allocated in chunks and only freed when the pool is destroyed, so
+/// in the steady state acquiring and releasing never touches the allocator.
+class JobPool {
+ public:
+  static constexpr u32 kChunkSize = 256;
+
+  JobPool() = default;
+
+  DC_DELETE_COPY(JobPool);
+  DC_DELETE_MOVE(JobPool);
+
+  /// Move a job into a free slot. Called only by the owner thread.
+  PooledJob* acquire(Job&& job) {
+    if (!m_free) {
+      m_free = m_remoteFree.exchange(nullptr, std::memory_order_acquire);
+      if (!m_free) grow();
+    }
+
+    PooledJob* slot = m_free;
+    m_free = slot->next;
+    slot->next = nullptr;
+    slot->job = dc::move(job);
+    return slot;
+  }
+
+  /// Return a slot to its owning pool, destroying the job it holds.
+  /// @param slot Slot obtained from acquire() on any pool.
+  /// @param local The calling thread's own pool, or nullptr if the caller
+  ///              does not own one.
+  static void release(PooledJob* slot, JobPool* local) {
+    slot->job = Job{};
+
+    JobPool* owner = slot->owner;
+    if (local && owner == local) {
+      slot->next = owner->m_free;
+      owner->m_free = slot;
+      return;
+    }
+
+    PooledJob* head = owner->m_remoteFree.load(std::memory_order_relaxed);
+    do {
+      slot->next = head;
+    } while (!owner->m_remoteFree.compare_exchange_weak(
+        head, slot, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+ private:
+  void grow() {
+    auto chunk = std::make_unique<PooledJob[]>(kChunkSize);
+    for (u32 i = 0; i < kChunkSize; ++i) {
+      chunk[i].owner = this;
+      chunk[i].next = i + 1 < kChunkSize ? &chunk[i + 1] : nullptr;
+    }
+    m_free = &chunk[0];
+    m_chunks.add(dc::move(chunk));
+  }
+
+  /// Owner-private free list.
+  PooledJob* m_free = nullptr;
+
+  /// Slots released by other threads. Pushed by anyone, taken in bulk by the
+  /// owner, so there is no ABA problem.
+  alignas(64) std::atomic<PooledJob*> m_remoteFree{nullptr};
+
+  List<std::unique_ptr<PooledJob[]>> m_chunks;
+};
+
+}  // namespace dc
@@ -0,0 +1,95 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/job/job.hpp>
+#include <dc/list.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+/// Counters for one worker, see JobSystem::stats(). Counted since the
+/// JobSystem was created.
+struct WorkerStats {
+  /// Jobs run on the worker thread, including the ones it ran while helping
+  /// in JobSystem::await(). In fiber mode every wait that switched a fiber out
+  /// adds one more, for the short job that resumes it.
+  u64 jobsRun = 0;
+
+  /// Jobs taken from the deques of other workers.
+  u64 jobsStolen = 0;
+
+  /// Time spent finding and running jobs. The rest of the worker's life is
+  /// spent idling, see IdlePolicy, or parked.
+  u64 busyNs = 0;
+
+  /// Time spent parked, waiting for a wake-up.
+  u64 parkedNs = 0;
+
+  /// Times the worker was woken up from a park.
+  u64 wakeUps = 0;
+
+  /// Most jobs the worker found waiting in one inbox at once. Close to
+  /// WorkerLane::kRingCapacity means producers are about to spill into the
+  /// injection queue.
+  u32 inboxHighWater = 0;
+};
+
+/// A snapshot of the JobSystem counters. The counters are read one at a time
+/// while the workers keep running, so they are not consistent with each other.
+struct JobSystemStats {
+  /// Indexed by worker.
+  List<WorkerStats> workers;
+
+  /// Jobs that JobSystem::add() found no inbox room for, and pushed onto the
+  /// injection queue instead.
+  u64 overflowPushes = 0;
+
+  /// Jobs added from outside the pool that have not started yet, see
+  /// JobSystem::backlog().
+  u32 backlog = 0;
+
+  /// Jobs run by threads other than the workers, while they await.
+  u64 externalJobsRun = 0;
+
+  /// Jobs run by the blocking pool, see JobSystem::addBlocking(), and the
+  /// threads it has right now.
+  u64 blockingJobsRun = 0;
+  u32 blockingThreads = 0;
+
+  /// Trace events lost because a worker's trace buffer was full.
+  u64 traceEventsDropped = 0;
+};
+
+/// One job run by a worker, recorded in trace mode.
+struct TraceEvent {
+  /// dc::getTimeNs() timestamps.
+  u64 beginNs;
+  u64 endNs;
+  JobPriority priority;
+};
+
+}  // namespace dc
@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <dc/allocator.hpp>
+#include <dc/macros.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+struct Worker;
+
+/// Bump allocator for short-lived allocations, made from a list of chunks.
+///
+/// alloc() moves a cursor forward, free() is a no-op except for the most
+/// recent allocation, and reset() frees everything at once. The chunks are
+/// kept across reset(), so an arena that has warmed up does not touch the
+/// backing allocator again. An allocation larger than a chunk gets a chunk of
+/// its own, which reset() gives back.
+///
+/// Not thread-safe. Each JobSystem worker owns one, see currentWorkerArena().
+class ScratchArena final : public IAllocator {
+ public:
+  static constexpr usize kDefaultChunkBytes = 64 * 1024;
+
+  explicit ScratchArena(usize chunkBytes = kDefaultChunkBytes,
+                        IAllocator& backing = getDefaultAllocator());
+  ~ScratchArena() override;
+
+  DC_DELETE_COPY(ScratchArena);
+  DC_DELETE_MOVE(ScratchArena);
+
+  void* alloc(usize count, usize align = kMinimumAlignment) override;
+
+  /// Grows in place if data is the most recent allocation and still fits.
+  void* realloc(void* data, usize count,
+                usize align = kMinimumAlignment) override;
+
+  /// Gives the memory back if data is the most recent allocation, otherwise
+  /// it stays in use until reset().
+  void free(void* data) override;
+
+  /// Free every allocation at once.
+  void reset();
+
+  /// True if nothing was allocated since the last reset().
+  [[nodiscard]] bool isEmpty() const { return m_used == 0; }
+
+  /// Bytes handed out since the last reset(), alignment padding excluded.
+  [[nodiscard]] usize bytesUsed() const { return m_used; }
+
+  /// Bytes held from the backing allocator, chunk headers included.
+  [[nodiscard]] usize bytesReserved() const { return m_reserved; }
+
+ private:
+  struct Chunk {
+    Chunk* next;
+    usize size;
+  };
+
+  /// Find room for count bytes plus the size header at the given alignment.
+  /// @return The allocation, or nullptr if the current chunk is full.
+  void* bump(usize count, usize align);
+
+  void* allocLarge(usize count, usize align);
+
+  /// True if data, of count bytes, is the allocation just below the cursor.
+  [[nodiscard]] bool isMostRecent(const u8* data, usize count) const;
+
+  static u8* dataOf(Chunk* chunk) {
+    return reinterpret_cast<u8*>(chunk) + sizeof(Chunk);
+  }
+  static const u8* dataOf(const Chunk* chunk) {
+    return reinterpret_cast<const u8*>(chunk) + sizeof(Chunk);
+  }
+
+  /// Each allocation is preceded by its size, for realloc().
+  static usize& sizeOf(void* data) {
+    return *reinterpret_cast<usize*>(static_cast<u8*>(data) - sizeof(usize));
+  }
+
+  IAllocator& m_backing;
+  usize m_chunkBytes;
+
+  /// Chunks of m_chunkBytes, kept across reset(). m_current is the one being
+  /// bumped, the ones after it are free.
+  Chunk* m_first = nullptr;
+  Chunk* m_current = nullptr;
+  u8* m_cursor = nullptr;
+  u8* m_end = nullptr;
+
+  /// Chunks for allocations too large for a regular one.
+  Chunk* m_large = nullptr;
+
+  usize m_used = 0;
+  usize m_reserved = 0;
+};
+
+/// The worker whose scratch arena a running job has allocated from. It keeps
+/// its arena until the job finishes. A job that has allocated is not resumed
+/// on another worker, so there is only ever one.
+struct ScratchHolds {
+  Worker* worker = nullptr;
+};
+
+}  // namespace dc
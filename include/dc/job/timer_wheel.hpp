@@ -0,0 +1,178 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/job/job.hpp>
+#include <dc/list.hpp>
+#include <dc/macros.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+/// Identifies a timer, see JobSystem::addAt() and JobSystem::cancelTimer().
+/// Stays unique after the timer is gone, so cancelling a timer that already
+/// fired is harmless.
+struct TimerId {
+  u64 value = 0;
+
+  /// False for a default constructed id, which names no timer.
+  [[nodiscard]] bool isValid() const { return value != 0; }
+};
+
+/// A periodic timer that came due, see TimerWheel::advance().
+struct DuePeriodicTimer {
+  TimerId id;
+  JobPriority priority;
+};
+
+/// Hierarchical timer wheel of jobs, with O(1) add and cancel.
+///
+/// Design from "Hashed and Hierarchical Timing Wheels" (Varghese, Lauck, SOSP
+/// 1987), laid out like the classic Linux kernel timer wheel. Time is counted
+/// in ticks. Level 0 has one slot per tick for the next 64 ticks, and each
+/// level above has slots 64 times as wide. A timer is linked into the slot
+/// that covers its deadline at the lowest level that reaches that far, and
+/// moves down a level each time the wheel below it wraps around, until it
+/// lands in a level 0 slot and fires. Deadlines further out than the top level
+/// reaches are parked in it and go around again.
+///
+/// Timers live in a pool of nodes linked into the slots by index, so adding
+/// and cancelling only touch a couple of nodes. Timers are never fired early,
+/// but fire late by up to the time between two calls to advance().
+///
+/// Not thread-safe, JobSystem guards it with a mutex.
+class TimerWheel {
+ public:
+  static constexpr u32 kSlotBits = 6;
+  static constexpr u32 kSlotCount = 1u << kSlotBits;
+  static constexpr u32 kLevelCount = 6;
+
+  /// No pending timer, see nextTick().
+  static constexpr u64 kNever = ~u64{0};
+
+  /// @param currentTick The first tick that advance() processes.
+  explicit TimerWheel(u64 currentTick = 0);
+
+  DC_DELETE_COPY(TimerWheel);
+  DC_DELETE_MOVE(TimerWheel);
+
+  /// Add a timer that fires once the wheel reaches the deadline. A deadline
+  /// that already passed fires on the next advance().
+  /// @param periodTicks Fire again every so many ticks, until cancelled. 0
+  ///                    fires once. Periodic jobs stay in the wheel, see
+  ///                    takePeriodic().
+  TimerId add(u64 deadlineTick, Job job, u64 periodTicks = 0);
+
+  /// Remove a timer so that it never fires again. A periodic timer that is
+  /// running finishes its current run.
+  /// @return false if there was no such timer, it already fired or was
+  ///         cancelled.
+  bool cancel(TimerId id);
+
+  /// Process every tick up to and including nowTick. Due one-shot jobs are
+  /// moved into due, due periodic timers are added to duePeriodic.
+  void advance(u64 nowTick, List<Job>& due,
+               List<DuePeriodicTimer>& duePeriodic);
+
+  /// Take the job of a due periodic timer to run it. Put it back with
+  /// rearm() when done.
+  /// @return false if the timer was cancelled since it came due.
+  bool takePeriodic(TimerId id, Job& job);
+
+  /// Return the job taken by takePeriodic() and schedule the next run, one
+  /// period after the last deadline. Runs missed by more than a period are
+  /// skipped rather than made up for.
+  /// @return false if the timer was cancelled while running. The job is
+  ///         dropped then.
+  bool rearm(TimerId id, Job&& job, u64 nowTick);
+
+  /// A tick at or before the earliest pending deadline, or kNever. Exact for
+  /// deadlines within 64 ticks, further out it is where the timer next moves
+  /// down a level.
+  [[nodiscard]] u64 nextTick() const;
+
+  /// The next tick that advance() processes.
+  [[nodiscard]] u64 currentTick() const { return m_currentTick; }
+
+  /// Number of timers, including periodic ones that are running.
+  [[nodiscard]] u32 size() const { return m_size; }
+
+ private:
+  static constexpr u32 kNil = ~u32{0};
+
+  enum class NodeState : u8 {
+    Free,
+    /// Linked into a slot.
+    Pending,
+    /// Periodic, came due and is waiting for takePeriodic().
+    Due,
+    /// Periodic, its job taken by takePeriodic().
+    Running,
+  };
+
+  struct Node {
+    Job job;
+    u64 deadlineTick = 0;
+    u64 periodTicks = 0;
+    /// Slot list while pending, free list while free.
+    u32 prev = kNil;
+    u32 next = kNil;
+    /// Bumped every time the node is freed, so that old ids go stale.
+    u32 generation = 1;
+    u8 level = 0;
+    u8 slot = 0;
+    NodeState state = NodeState::Free;
+  };
+
+  /// The node the id names, or nullptr if the id is stale.
+  Node* find(TimerId id);
+  static TimerId makeId(u32 index, const Node& node);
+
+  u32 allocate();
+  void release(u32 index);
+
+  /// Link the node into the slot for its deadline.
+  void link(u32 index);
+  void unlink(u32 index);
+
+  /// Move the timers of a slot one level down. Returns the slot index.
+  u32 cascade(u32 level);
+
+  List<Node> m_nodes;
+  u32 m_freeHead = kNil;
+  u32 m_size = 0;
+
+  u64 m_currentTick;
+
+  /// Head node of each slot, kNil if empty.
+  u32 m_slots[kLevelCount][kSlotCount];
+
+  /// Bit per slot, set if the slot has timers. Lets advance() skip empty
+  /// stretches and nextTick() find the next timer without walking slots.
+  u64 m_occupied[kLevelCount] = {};
+};
+
+}  // namespace dc
@@ -24,42 +24,177 @@
 
 #pragma once
 
-#include <condition_variable>
+#include <atomic>
+#include <dc/job/fiber.hpp>
 #include <dc/job/job.hpp>
+#include <dc/job/job_pool.hpp>
+#include <dc/job/job_stats.hpp>
+#include <dc/job/scratch_arena.hpp>
+#include <dc/job/timer_wheel.hpp>
+#include <dc/list.hpp>
 #include <dc/macros.hpp>
-#include <dc/spsc_ring.hpp>
+#include <dc/mpmc_ring.hpp>
 #include <dc/types.hpp>
-#include <mutex>
+#include <dc/work_stealing_deque.hpp>
+#include <memory>
 #include <thread>
 
 namespace dc {
 
-/// Per-worker state. Each worker owns a SpscRing of jobs and a thread that
-/// drains it. The JobSystem is the sole producer; the worker thread is the
-/// sole consumer.
-struct Worker {
+/// Queues for one JobPriority.
+///
+/// Jobs submitted from outside the pool arrive in the MpmcRing inbox, which
+/// any number of threads may add to without a lock. The worker moves them into
+/// its work-stealing deque, which is also where jobs submitted from the worker
+/// thread itself go. Idle workers steal from the top of other workers' deques.
+struct WorkerLane {
   static constexpr u32 kRingCapacity = 1024;
+  static constexpr u32 kDequeCapacity = 1024;
+
+  WorkerLane()
+      : ring(std::make_unique<MpmcRing<Job>>(kRingCapacity)),
+        deque(kDequeCapacity) {}
+
+  DC_DELETE_COPY(WorkerLane);
+  DC_DELETE_MOVE(WorkerLane);
+
+  /// The inbox. Written by any submitting thread, drained by the worker
+  /// thread. Lock-free MPMC — no mutex needed for ring access. Released while
+  /// the worker is retired, see ElasticPolicy.
+  std::unique_ptr<MpmcRing<Job>> ring;
 
-  Worker() : ring(kRingCapacity) {}
+  /// Runnable jobs. Pushed and popped by the worker thread, stolen by others.
+  WorkStealingDeque<PooledJob> deque;
+};
+
+/// Per-worker state. One lane per JobPriority, so that a burst of background
+/// jobs never sits in front of a high priority one.
+struct Worker {
+  explicit Worker(usize scratchChunkBytes = ScratchArena::kDefaultChunkBytes)
+      : scratch(scratchChunkBytes) {}
 
   DC_DELETE_COPY(Worker);
   DC_DELETE_MOVE(Worker);
 
-  /// The job queue. Written by the JobSystem (producer), read by the worker
-  /// thread (consumer). Lock-free SPSC — no mutex needed for ring access.
-  SpscRing<Job> ring;
+  /// Indexed by JobPriority.
+  WorkerLane lanes[kJobPriorityCount];
+
+  /// Backing storage for the jobs in the deques. Owned by the worker thread.
+  JobPool pool;
 
   /// The worker thread. Joins on JobSystem destruction.
   std::thread thread;
 
-  /// Guards m_shutdown and is used with cv to signal the worker.
-  std::mutex mutex;
+  /// Futex word the worker parks on. Bumped by whoever wakes the worker, so a
+  /// wake between reading it and parking makes the park return immediately.
+  std::atomic<u32> wakeSignal{0};
+
+  /// True while the worker is (about to be) parked on wakeSignal. Lets
+  /// producers skip the wake entirely when the worker is awake.
+  std::atomic<bool> sleeping{false};
+
+  /// Jobs in the worker's pinned queue, see JobSystem::addToWorker(). Never
+  /// below the real size.
+  std::atomic<u32> pinnedSize{0};
+
+  /// Number of jobs this worker has stolen from other workers.
+  std::atomic<u64> stealCount{0};
+
+  /// Counters for WorkerStats. Only written by the worker thread, atomic so
+  /// that JobSystem::stats() can read them at any time.
+  std::atomic<u64> jobsRun{0};
+  std::atomic<u64> busyNs{0};
+  std::atomic<u64> parkedNs{0};
+  std::atomic<u64> wakeUps{0};
+  std::atomic<u32> inboxHighWater{0};
+
+  /// Trace buffer, only allocated in trace mode. Events below traceCount are
+  /// complete and never written again.
+  std::unique_ptr<TraceEvent[]> traceEvents;
+  u32 traceCapacity = 0;
+  std::atomic<u32> traceCount{0};
+  std::atomic<u64> traceDropped{0};
+
+  /// Index of this worker in the JobSystem.
+  u32 index = 0;
+
+  /// Logical CPUs the worker thread is pinned to. Empty if unpinned.
+  List<u32> cpus;
+
+  /// NUMA node of the CPUs above, 0 if unpinned.
+  u32 node = 0;
+
+  /// Indices of the other workers, in the order to steal from and wake them.
+  /// Workers on the same node come first.
+  List<u32> victims;
+
+  /// Jobs run since the last background job. Owned by the worker thread.
+  u32 sinceBackground = 0;
+
+  /// Looks for a job since the last look in the injection queue. Owned by
+  /// the worker thread.
+  u32 sinceInjected = 0;
+
+  /// The worker thread's own stack, saved while a fiber runs. Fibers switch
+  /// back here when their job finishes or waits.
+  FiberContext schedulerContext;
+
+  /// The fiber running on this worker, nullptr while the worker runs on its
+  /// own stack.
+  Fiber* fiber = nullptr;
+
+  /// Pinned jobs running on this worker right now, see Job::pinned. A job on
+  /// a fiber does not switch the fiber out to wait while this is above 0.
+  u32 pinnedDepth = 0;
+
+  /// Free fibers kept by this worker, so that most jobs get a fiber without
+  /// taking the JobSystem's fiber lock.
+  List<Fiber*> freeFibers;
+
+  /// Timers fired by this worker, reused so that firing does not allocate.
+  List<Job> dueTimers;
+  List<DuePeriodicTimer> duePeriodicTimers;
+
+  /// False while the worker retires or is retired, see ElasticPolicy.
+  /// Submitters skip its inbox then.
+  std::atomic<bool> accepting{true};
+
+  /// Submitters adding to the inbox right now. A retiring worker waits for
+  /// them to leave before it drains the inbox for the last time.
+  std::atomic<u32> pushers{0};
+
+  /// Set as the last thing the worker thread does, once it retired.
+  std::atomic<bool> exited{false};
+
+  /// When the worker last ran a job, and since when more jobs than
+  /// ElasticPolicy::growQueueDepth have been queued behind it, 0 if they are
+  /// not. Owned by the worker thread.
+  u64 idleSinceNs = 0;
+  u64 overloadedSinceNs = 0;
+
+  /// Scratch memory for the jobs this worker runs, see currentWorkerArena().
+  /// Only touched by the worker thread.
+  ScratchArena scratch;
+
+  /// Jobs that allocated from scratch and have not finished yet. Taken by the
+  /// worker thread, released by whichever worker finishes the job. The worker
+  /// resets scratch between jobs once this is 0.
+  std::atomic<u32> scratchHolders{0};
+
+  /// Holds of the job running on this worker, nullptr between jobs.
+  ScratchHolds* scratchHolds = nullptr;
 
-  /// Worker waits on this until work is available or shutdown is requested.
-  std::condition_variable cv;
+  /// Jobs of one batch, made by JobCounter::makeBatch(), that finished on this
+  /// worker in a row, and are not counted down on its counter yet. Counted
+  /// down together once they finish the batch, the worker turns to anything
+  /// else than another job of the batch, or after kDoneChunk jobs. Only
+  /// touched by the worker thread.
+  static constexpr u32 kDoneChunk = 64;
+  JobCounter* doneCounter = nullptr;
+  u32 doneCount = 0;
 
-  /// Set to true by the JobSystem before join. Written under mutex.
-  bool shutdown = false;
+  /// Set to true by the JobSystem before join.
+  std::atomic<bool> shutdown{false};
 };
 
 }  // namespace dc
@@ -24,29 +24,252 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <dc/job/blocking_pool.hpp>
+#include <dc/job/cancellation_token.hpp>
 #include <dc/job/job.hpp>
 #include <dc/job/job_handle.hpp>
+#include <dc/job/job_stats.hpp>
+#include <dc/job/timer_wheel.hpp>
 #include <dc/job/worker.hpp>
 #include <dc/list.hpp>
 #include <dc/macros.hpp>
 #include <dc/ring.hpp>
+#include <dc/string.hpp>
+#include <dc/traits.hpp>
 #include <dc/types.hpp>
+#include <functional>
 #include <memory>
 #include <mutex>
-#include <random>
+#include <thread>
 #include <vector>
 
 namespace dc {
 
+struct JobQueue;
+
+template <typename T>
+class Future;
+
+/// How an idle worker waits for work before it parks.
+///
+/// A worker that runs out of work first polls for more in a tight loop with a
+/// CPU pause hint, then yields its time slice a few times, and only then parks
+/// on a futex. Waking a parked worker costs a syscall on both sides, so for
+/// short fan-out/fan-in cycles spinning a little is far cheaper. Spinning
+/// burns a core however, set both counts to 0 to park right away.
+struct IdlePolicy {
+  /// Polls with a CPU pause in between, before starting to yield.
+  u32 spinCount = 128;
+
+  /// Polls with std::this_thread::yield() in between, before parking.
+  u32 yieldCount = 8;
+};
+
+/// Fiber mode, where jobs run on pooled stacks of their own.
+///
+/// Without fibers a job that awaits a batch keeps its worker, and runs other
+/// jobs on top of its own stack until the batch is done, see
+/// JobSystem::await(). A job picked up that way has to finish before the
+/// waiting job can continue, so deep dependency chains nest deeply and can
+/// wait on each other in the wrong order. With fibers the waiting job is
+/// switched out instead, and resumed on whichever worker is free once its
+/// batch is done, so waits never nest.
+///
+/// Only supported on x86-64 Linux, elsewhere jobs always run on the worker's
+/// stack.
+struct FiberConfig {
+  bool enabled = false;
+
+  /// Usable stack size of each fiber. A guard page below it turns a stack
+  /// overflow into a crash rather than memory corruption.
+  u32 stackSize = 64 * 1024;
+
+  /// Upper bound on the fibers, and so on the memory spent on stacks. Jobs
+  /// that start while every fiber is in use run on the worker's own stack,
+  /// as without fibers.
+  u32 maxFibers = 256;
+};
+
+/// Elastic pool, where the number of running workers follows the load.
+///
+/// The pool starts with minThreads workers and JobSystemConfig::threadCount
+/// is the most it grows to. A worker that has had more than growQueueDepth
+/// jobs queued behind it for growAfter starts another worker, and the last
+/// started worker stops again once it has been idle for shrinkAfter. The
+/// queue has to drop below half of growQueueDepth before the wait to grow
+/// starts over, and a stopped worker releases its thread and inbox.
+struct ElasticPolicy {
+  /// Workers that keep running however idle they are. 0 turns the elastic
+  /// pool off, all workers then run all the time.
+  u32 minThreads = 0;
+
+  /// Jobs queued behind a worker, and in the injection queue, before it
+  /// counts as overloaded.
+  u32 growQueueDepth = 64;
+
+  std::chrono::nanoseconds growAfter = std::chrono::milliseconds(2);
+  std::chrono::nanoseconds shrinkAfter = std::chrono::seconds(1);
+};
+
+/// Threads for blocking jobs, see JobSystem::addBlocking() and BlockingPool.
+/// No thread is started before the first blocking job.
+struct BlockingPolicy {
+  /// Most blocking jobs that run at once. The rest wait in line.
+  u32 maxThreads = 64;
+
+  /// A thread with nothing to do stops after this long.
+  std::chrono::nanoseconds idleTimeout = std::chrono::seconds(5);
+};
+
+/// Admission control for jobs added from outside the pool, see
+/// JobSystem::tryAdd() and JobSystem::addFor().
+///
+/// The backlog is the jobs added by threads other than the workers that have
+/// not started yet, see JobSystem::backlog(). Jobs added by jobs are not
+/// counted and never refused, a job must not wait for room that only it can
+/// make. That holds for jobs on blocking threads and the owner thread too.
+/// Neither are timers, continuations, pinned, owner and blocking jobs.
+///
+/// With neither maxBacklog nor highWater set, the backlog is not counted at
+/// all, and adding a job does not touch a counter shared by every thread.
+struct BackpressurePolicy {
+  /// Most jobs in the backlog. add() waits while it is full, tryAdd() fails.
+  /// A batch larger than this waits for the backlog to empty. 0 leaves the
+  /// backlog unbounded.
+  u32 maxBacklog = 0;
+
+  /// onHighWater is called when the backlog reaches this many jobs, and again
+  /// only after it dropped below half of it in between. 0 turns it off.
+  u32 highWater = 0;
+
+  /// Called with the backlog, on the thread whose add reached highWater.
+  std::function<void(u32 backlog)> onHighWater;
+};
+
+/// Where worker threads may run, see JobSystemConfig::affinity.
+enum class WorkerAffinity : u8 {
+  /// Leave placement to the OS scheduler.
+  Unpinned,
+
+  /// Pin each worker to one logical CPU. Workers fill every physical core
+  /// before doubling up on the SMT siblings of one.
+  LogicalCpu,
+
+  /// Pin each worker to one physical core, free to run on any of its SMT
+  /// siblings. With threadCount 0 there is one worker per physical core.
+  PhysicalCore,
+};
+
+struct JobSystemConfig {
+  /// Number of worker threads. Pass 0 to use
+  /// std::thread::hardware_concurrency(), or the number of physical cores with
+  /// WorkerAffinity::PhysicalCore. The most that run at once in an elastic
+  /// pool.
+  u32 threadCount = 0;
+
+  ElasticPolicy elastic;
+
+  BlockingPolicy blocking;
+
+  BackpressurePolicy backpressure;
+
+  /// Pinned workers are dealt out over the NUMA nodes in turn, and each worker
+  /// steals from workers on its own node before crossing to another one.
+  /// Worth it for memory-bound jobs on multi-socket machines, where a thread
+  /// that migrates to another node pays for remote memory on every access.
+  /// More workers than CPUs wrap around and share.
+  WorkerAffinity affinity = WorkerAffinity::Unpinned;
+
+  FiberConfig fibers;
+
+  /// Resolution of the timers, see JobSystem::addAt(). Timers fire up to a
+  /// tick late, and a worker waiting for the next timer wakes up at most once
+  /// per tick.
+  std::chrono::nanoseconds timerTick = std::chrono::milliseconds(1);
+
+  /// Trace mode. Each worker records the start and end of up to this many
+  /// jobs, for JobSystem::chromeTrace(). Costs two clock reads per job and
+  /// sizeof(TraceEvent) bytes per event up front. 0 turns tracing off.
+  u32 traceCapacity = 0;
+
+  IdlePolicy idle;
+
+  /// A worker looks in the background lane first once it has run this many
+  /// higher priority jobs in a row, so that background jobs keep trickling
+  /// through under sustained load. 0 lets higher lanes starve it.
+  u32 backgroundQuota = 16;
+
+  /// Size of the chunks each worker's scratch arena grows by, see
+  /// currentWorkerArena().
+  usize scratchChunkBytes = ScratchArena::kDefaultChunkBytes;
+};
+
+/// Scratch memory for the job running on the calling thread.
+///
+/// Each worker has a ScratchArena, so temporary Lists and Strings built by a
+/// job cost a pointer bump instead of a trip through the shared heap, with no
+/// contention between workers. What the job allocates stays valid until the
+/// job finishes, also across awaits. The worker resets its arena once every
+/// job that allocated from it has finished.
+///
+/// Only its worker may use an arena. So a job on a fiber that has allocated
+/// from one no longer switches out to wait: it waits and helps on its worker,
+/// like a pinned job, rather than be resumed on another one.
+///
+/// Outside of a job on a worker thread, the default allocator.
+///
+/// Usage:
+/// @code
+///   js.add(dc::Job{[] {
+///     dc::List<Hit> hits(dc::currentWorkerArena());
+///     gatherHits(hits);
+///   }});
+/// @endcode
+[[nodiscard]] IAllocator& currentWorkerArena();
+
 /// Global work/job system.
 ///
 /// Create one instance per application. Thread-safe: jobs may be added
-/// from any thread concurrently.
+/// from any thread concurrently, without taking a lock.
+///
+/// Workers each own a lock-free MpmcRing<Job> inbox and a Chase-Lev
+/// work-stealing deque per JobPriority, and always run the highest priority
+/// job they can find. Jobs added from outside the pool are assigned to a
+/// worker's inbox round-robin, using a cursor private to the submitting
+/// thread. Workers that run out of work spin, yield and finally park, as set
+/// by the IdlePolicy. A producer only issues a wake-up when the worker is
+/// actually parked. Workers move their inbox into their deque, and jobs added
+/// from a worker thread go straight onto that worker's deque. Workers that run
+/// out of work steal from the other workers' deques before going to sleep, so
+/// an uneven batch does not leave cores idle while one worker chews through a
+/// long tail.
+///
+/// Workers may be pinned to CPUs, see WorkerAffinity. They then prefer to
+/// steal from workers on the same NUMA node.
+///
+/// If all worker inboxes are full, jobs go into a shared lock-free injection
+/// queue. Workers look there before stealing in each lane, and every few jobs
+/// regardless, so that jobs there do not wait behind newer ones. That queue is unbounded, a BackpressurePolicy bounds the
+/// jobs added from outside the pool instead.
 ///
-/// Workers each own a lock-free SpscRing<Job>. The JobSystem randomly assigns
-/// incoming jobs to a worker and notifies it via a condition variable. If all
-/// worker rings are full, jobs are placed in an overflow ring (protected by
-/// m_mutex) which is drained on the next add call.
+/// With an ElasticPolicy only some of the workers run. The rest are started
+/// when the running ones fall behind, and stopped again when idle. Workers
+/// run in index order, only the last one started may stop.
+///
+/// Jobs that block go to a pool of threads of their own, which grows past the
+/// number of cores when needed, see addBlocking().
+///
+/// Jobs that must run on one particular thread can be pinned to a worker, or
+/// queued for the owner thread, which runs them when it pumps its queue. See
+/// addToWorker() and addToOwner().
+///
+/// Delayed and periodic jobs wait in a hierarchical TimerWheel. Workers fire
+/// the timers that are due between jobs, and one idle worker parks with a
+/// timeout set to the next deadline instead of indefinitely, so timers need no
+/// thread of their own.
 ///
 /// Lifecycle is RAII: the constructor starts worker threads and the destructor
 /// joins them after signaling shutdown. Jobs already in a worker's ring when
@@ -64,9 +287,11 @@ class JobSystem {
   ///                    std::thread::hardware_concurrency().
   explicit JobSystem(u32 threadCount = 0);
 
+  /// Start the job system.
+  explicit JobSystem(const JobSystemConfig& config);
+
   /// Signal all workers to stop and join their threads.
-  /// Pending jobs in the overflow ring may not be executed.
-  /// Jobs already added to worker rings will be completed.
+  /// Jobs already added will be completed first.
   ~JobSystem();
 
   DC_DELETE_COPY(JobSystem);
@@ -74,47 +299,472 @@ class JobSystem {
 
   /// Add a job to one of the workers. Thread-safe.
   ///
-  /// Selects a worker at random and attempts to add the job to its ring.
-  /// If the chosen worker's ring is full, tries remaining workers in order.
-  /// If all rings are full, the job is queued in the overflow ring and will
-  /// be added on the next call to add().
+  /// The job goes into the lane of its priority, see Job::priority.
+  ///
+  /// When called from a worker thread the job is pushed onto that worker's
+  /// deque, where idle workers can steal it.
+  ///
+  /// Otherwise selects the next worker in this thread's round-robin order and
+  /// attempts to add the job to its ring. If the chosen worker's ring is full,
+  /// tries remaining workers in order. If all rings are full, the job is
+  /// queued in the injection queue, which the workers poll.
+  ///
+  /// From outside the pool, waits for room while the backlog is full, see
+  /// BackpressurePolicy.
   void add(Job job);
 
+  /// Add a job as add() does, unless the backlog is full.
+  /// @return false if it is full. The job is left untouched then.
+  [[nodiscard]] bool tryAdd(Job&& job);
+
+  /// Add a job as add() does, waiting up to timeout for room in the backlog.
+  /// @return false if there was no room in time. The job is left untouched
+  ///         then.
+  [[nodiscard]] bool addFor(Job&& job, std::chrono::nanoseconds timeout);
+
+  /// Jobs added from outside the pool that have not started yet, see
+  /// BackpressurePolicy. Always 0 unless a maxBacklog or highWater is set.
+  [[nodiscard]] u32 backlog() const;
+
   /// Add a batch of jobs and return a JobHandle that can be awaited.
   ///
-  /// Each job in the list is wrapped so that it decrements a shared counter
-  /// when it finishes. When all jobs have completed the counter reaches zero
-  /// and any thread blocked in JobHandle::await() is unblocked.
+  /// Each job in the list is tagged with a shared counter, which is
+  /// decremented as the jobs finish. A worker counts the jobs of one batch
+  /// that it runs in a row down together. When all jobs have completed the
+  /// counter reaches zero and any thread blocked in JobHandle::await() is
+  /// unblocked. The jobs are moved out of the list.
+  ///
+  /// From outside the pool, waits for room for the whole batch while the
+  /// backlog is full, see BackpressurePolicy.
+  ///
+  /// Once the token is cancelled, jobs of the batch that have not started yet
+  /// are skipped, see CancellationToken.
   ///
   /// @param jobs List of jobs to schedule.
+  /// @param token Cancels the batch. Empty by default, the batch then always
+  ///              runs to completion.
   /// @return A JobHandle whose await() blocks until all jobs finish.
-  [[nodiscard]] JobHandle add(dc::List<Job>& jobs);
+  [[nodiscard]] JobHandle add(dc::List<Job>& jobs,
+                              CancellationToken token = {});
+
+  /// Add a job that blocks, such as a dc::File read, an fsync or a sleep.
+  /// Thread-safe.
+  ///
+  /// The job runs on a thread of the blocking pool, see BlockingPolicy, and
+  /// never on a worker, so that compute jobs never queue up behind it. Jobs
+  /// start in the order they were added, the priority is ignored. Once the
+  /// JobSystem is being destroyed, the job runs on the calling thread.
+  void addBlocking(Job job);
+
+  /// Add a batch of blocking jobs, see addBlocking().
+  [[nodiscard]] JobHandle addBlocking(dc::List<Job>& jobs,
+                                      CancellationToken token = {});
+
+  /// Add a job that only the given worker runs. Thread-safe.
+  ///
+  /// For jobs that touch resources owned by one thread, such as a per-thread
+  /// cache or a handle that is not thread-safe. The job goes into a queue of
+  /// the worker's own, which no other worker steals from, and the worker runs
+  /// it before anything from its lanes. It also never runs on a fiber, so it
+  /// finishes on the worker it started on even if it awaits.
+  ///
+  /// In an elastic pool a stopped worker is started, along with the workers
+  /// before it.
+  void addToWorker(u32 workerIndex, Job job);
+
+  /// Add a batch of jobs that only the given worker runs, see addToWorker().
+  [[nodiscard]] JobHandle addToWorker(u32 workerIndex, dc::List<Job>& jobs,
+                                      CancellationToken token = {});
+
+  /// Add a job for the owner thread, which runs it in pumpOwnerQueue().
+  /// Thread-safe. For work that has to happen on the main thread, say.
+  void addToOwner(Job job);
+
+  /// Add a batch of jobs for the owner thread, see addToOwner().
+  [[nodiscard]] JobHandle addToOwner(dc::List<Job>& jobs,
+                                     CancellationToken token = {});
+
+  /// Run the jobs added for the owner thread, on the owner thread. Jobs added
+  /// while it runs wait for the next call, so a job that adds itself again
+  /// runs once per call. Also done by await() on the owner thread.
+  /// @param maxJobs Most jobs to run.
+  /// @return How many jobs ran.
+  u32 pumpOwnerQueue(u32 maxJobs = ~0u);
+
+  /// Make the calling thread the owner thread. The thread that created the
+  /// JobSystem until then.
+  void makeOwnerThread();
+
+  /// True if called on the owner thread, see makeOwnerThread().
+  [[nodiscard]] bool isOwnerThread() const;
+
+  /// Run the function as a job and return a future for its result.
+  /// Thread-safe. Defined in future.hpp, include it to call this.
+  ///
+  /// The function is stored in the Job along with a pointer, so it gets
+  /// kJobCaptureBytes - 8 bytes of captures. A function that can fail returns
+  /// a dc::Result.
+  template <typename Fn>
+  [[nodiscard]] auto submit(Fn&& fn, JobPriority priority = JobPriority::Normal)
+      -> Future<InvokeResultT<DecayT<Fn>&>>;
+
+  /// Add a job once dc::getTimeNs() reaches the deadline. Thread-safe. The job
+  /// fires at most JobSystemConfig::timerTick late, and is then added like
+  /// any other job. A deadline that passed fires right away.
+  ///
+  /// Timers that have not fired when the JobSystem is destroyed are dropped.
+  ///
+  /// @return An id for cancelTimer().
+  TimerId addAt(u64 deadlineNs, Job job);
+
+  /// Add a job once the delay has passed, see addAt().
+  TimerId addAfter(std::chrono::nanoseconds delay, Job job);
 
-  /// Number of worker threads.
+  /// Run a job every period, starting one period from now, until the timer is
+  /// cancelled. Thread-safe. A run starts one period after the previous run
+  /// was due, but never before the previous run has finished. Runs that would
+  /// start late by more than a period are skipped.
+  ///
+  /// @code
+  ///   const dc::TimerId flush = js.addPeriodic(
+  ///       std::chrono::seconds(1), dc::Job{[&cache] { cache.flush(); }});
+  ///   // ...
+  ///   js.cancelTimer(flush);
+  /// @endcode
+  TimerId addPeriodic(std::chrono::nanoseconds period, Job job);
+
+  /// Stop a timer from firing. Thread-safe. A periodic job that is running
+  /// finishes, but does not run again.
+  /// @return false if the timer already fired or was cancelled.
+  bool cancelTimer(TimerId id);
+
+  /// Block until the counter reaches zero, running pending jobs meanwhile.
+  ///
+  /// In a job running on a fiber, see FiberConfig, the fiber is switched out
+  /// until the counter reaches zero and the worker moves on to other jobs.
+  /// The job may then continue on another worker thread.
+  ///
+  /// Otherwise, on a worker of this system it runs jobs from its own deque and
+  /// inbox first, then steals from the other workers. Any other thread steals
+  /// from the workers' deques, and the owner thread runs the jobs queued for
+  /// it first. When there is nothing left to run the rest of the batch is
+  /// running elsewhere; the thread then idles as set by the IdlePolicy, and
+  /// finally sleeps on the counter, waking up now and then to check for new
+  /// jobs to help with.
+  ///
+  /// A helping thread may pick up a job that takes longer than the batch it
+  /// waits for, so await() can return later than the batch completes.
+  void await(JobCounter& counter);
+
+  /// Number of worker threads. In an elastic pool the most that may run at
+  /// once, see activeWorkerCount().
   [[nodiscard]] u32 workerCount() const {
     return static_cast<u32>(m_workers.size());
   }
 
+  /// Number of worker threads running right now. Always workerCount() unless
+  /// the pool is elastic, see ElasticPolicy.
+  [[nodiscard]] u32 activeWorkerCount() const {
+    return m_activeCount.load(std::memory_order_acquire);
+  }
+
+  /// Total number of jobs that workers have stolen from each other.
+  [[nodiscard]] u64 stealCount() const;
+
+  /// Number of jobs the given worker has stolen from other workers.
+  [[nodiscard]] u64 stealCount(u32 workerIndex) const;
+
+  /// Read the per-worker counters. Cheap enough to poll, it takes no locks
+  /// and does not disturb the workers.
+  [[nodiscard]] JobSystemStats stats() const;
+
+  /// The jobs recorded in trace mode as Chrome trace event JSON, one track per
+  /// worker. Load it in chrome://tracing or https://ui.perfetto.dev. May be
+  /// called while jobs are running, it then holds the events so far. Returns
+  /// an empty trace unless JobSystemConfig::traceCapacity is set.
+  ///
+  /// @code
+  ///   dc::File file;
+  ///   if (file.open("jobs.json", dc::File::Mode::kWrite).isOk()) {
+  ///     (void)file.write(js.chromeTrace());
+  ///   }
+  /// @endcode
+  [[nodiscard]] dc::String chromeTrace() const;
+
+  /// NUMA node the given worker is pinned to, as numbered by CpuTopology.
+  /// Always 0 for unpinned workers.
+  [[nodiscard]] u32 workerNode(u32 workerIndex) const;
+
  private:
-  /// Try to drain the overflow ring into worker rings. Must be called with
-  /// m_mutex held.
-  void drainOverflow();
+  friend struct JobCounter;
 
-  /// Pick a random starting worker index. Must be called with m_mutex held.
-  u32 randomWorkerIndex();
+  void workerLoop(Worker& worker);
 
-  std::mutex m_mutex;
+  /// Resume a fiber that is ready, or find a job and run it.
+  /// @return false if there was nothing to do.
+  bool runNext(Worker& worker);
 
-  /// Fallback queue for jobs that could not be assigned to any worker ring.
-  /// Guarded by m_mutex. Grows automatically when needed.
-  dc::Ring<Job> m_overflowRing;
+  /// Run a job that the worker found, on a fiber if there is one to spare.
+  void runJob(Worker& worker, PooledJob* job);
 
-  /// Worker pool. Fixed size after construction. Workers are heap-allocated to
-  /// avoid issues with non-movable mutexes/condition_variables in a vector.
-  std::vector<std::unique_ptr<Worker>> m_workers;
+  /// Count the job, trace it and return its slot to the pool.
+  static void finishJob(Worker& worker, PooledJob* job, u64 beginNs);
+
+  /// Run or resume the fiber until its job finishes or waits.
+  void runFiber(Worker& worker, Fiber* fiber);
+
+  /// Loop that every fiber runs: run the job, switch back, repeat.
+  static void fiberMain(Fiber* fiber);
+
+  /// Take a free fiber, or create one if under FiberConfig::maxFibers.
+  /// Returns nullptr if fibers are off or all in use.
+  Fiber* acquireFiber(Worker& worker);
+  void releaseFiber(Worker& worker, Fiber* fiber);
+
+  /// Queue a fiber whose wait is over, for any worker to resume.
+  void pushReadyFiber(Fiber* fiber);
+  Fiber* popReadyFiber();
+
+  /// Spin, yield and then park, as set by the IdlePolicy, until the worker
+  /// has work or is asked to shut down. The worker that keeps watch over the
+  /// timers parks until the next one is due.
+  /// @return true if the worker may retire, it has been idle for
+  ///         ElasticPolicy::shrinkAfter.
+  bool waitForWork(Worker& worker);
+
+  /// Wake the worker from its park. Cheap to call on an awake worker.
+  static void wake(Worker& worker);
+
+  TimerId addTimer(u64 deadlineNs, Job&& job, u64 periodTicks);
+
+  /// Add the timers that are due to the worker's deque. Cheap when none are.
+  void fireTimers(Worker& worker);
+
+  /// Run a periodic job that came due and schedule its next run.
+  void runPeriodic(TimerId id);
+
+  /// Update m_nextTimerNs from the wheel. Called with m_timerMutex held.
+  /// @return true if the next timer is now earlier than before.
+  bool publishNextTimer();
+
+  /// Make the timer watcher look at the next deadline again, or get a parked
+  /// worker to take up the watch if there is no watcher.
+  void notifyTimerWatcher();
+
+  /// True once the next timer is due.
+  bool timerDue() const;
+
+  /// Convert dc::getTimeNs() to timer wheel ticks and back. Deadlines round
+  /// up, so that no timer fires early.
+  u64 toTick(u64 timeNs) const;
+  u64 toDeadlineTick(u64 timeNs) const;
+  u64 toTimeNs(u64 tick) const;
+
+  /// Find the next job for the worker, highest priority lane first. Returns
+  /// nullptr if there is no work.
+  PooledJob* findJob(Worker& worker);
+
+  /// Find a job in one lane: the worker's own deque first, then its inbox,
+  /// then the injection queue, then the other workers' deques.
+  PooledJob* findJob(Worker& worker, u32 lane);
+
+  /// The last two steps of findJob(worker, lane).
+  PooledJob* takeInjectedOrSteal(Worker& worker, u32 lane);
+
+  /// Move a batch from the injection queue onto the worker's deques and pop
+  /// one job, from the lanes up to maxLane only.
+  PooledJob* takeInjected(Worker& worker, u32 maxLane);
+
+  /// Try to steal a job in the lane from any worker other than the thief,
+  /// in the thief's victim order.
+  PooledJob* steal(Worker& thief, u32 lane);
+
+  /// Try to steal a job from any worker, for a thread that is not a worker.
+  PooledJob* stealExternal();
+
+  /// True if the worker has something in its inbox, or the injection queue or
+  /// any deque has work.
+  bool hasWork(const Worker& worker) const;
+
+  /// Start another worker if the calling one has been overloaded for
+  /// ElasticPolicy::growAfter.
+  void checkLoad(Worker& worker);
+
+  /// Start the next worker of an elastic pool, unless all of them run.
+  /// @return false if the JobSystem is shutting down.
+  bool grow();
+
+  /// Stop the worker, if it is the last one started and the pool is above its
+  /// minimum. Runs what is left in its queues first.
+  /// @return true if the worker thread should exit.
+  bool tryRetire(Worker& worker);
+
+  /// Announce a submitter to the worker's inbox, and leave it again. A
+  /// retiring worker waits until no one is inside.
+  /// @return false if the worker retires, or is retired, and takes no jobs.
+  bool enterInbox(Worker& worker);
+  void leaveInbox(Worker& worker);
+
+  /// Add a job to the inbox of the preferred worker, or the next one with room.
+  /// @return false if every inbox is full. The job is left untouched then.
+  bool pushInbox(u32 preferredIndex, Job&& job);
+
+  /// Add a slice of a batch to the worker's inbox, in bulk. What does not fit
+  /// goes to the other workers, or the injection queue. Does not wake anyone.
+  void pushSlice(Worker& worker, Job* jobs, usize count);
 
-  /// Random number generator for worker selection. Used under m_mutex.
-  std::mt19937 m_rng;
+  /// Add a job to the injection queue and wake a worker to take it.
+  void pushInjected(Job&& job);
+
+  /// Add a job from outside the pool, to a worker's inbox or the injection
+  /// queue.
+  void addExternal(Job&& job);
+
+  /// Add a job that a finished batch released, see JobCounter. Never waits
+  /// for, or counts towards, the backlog.
+  void addReleased(Job job);
+
+  /// True if the jobs that a thread other than the workers adds count towards
+  /// the backlog, that is if the backlog is counted and the thread does not
+  /// add them from inside a job.
+  [[nodiscard]] bool needsAdmission() const;
+
+  /// Count jobs added from outside the pool into the backlog, waiting up to
+  /// timeout for room. std::chrono::nanoseconds::max() waits for good.
+  /// @return false if there was no room in time.
+  bool admit(u32 count, std::chrono::nanoseconds timeout);
+
+  /// Take the backlog count of count jobs, if there is room for them.
+  bool tryReserve(u32 count);
+
+  /// Count an admitted job out of the backlog as it starts.
+  void leaveBacklog();
+
+  /// Wake the worker if it is parked.
+  void notify(Worker& worker);
+
+  /// Returns this thread's submission cursor and advances it by count.
+  static u32 nextSubmitIndex(u32 count);
+
+  /// Add a job to the worker's pinned queue, starting the worker if it is
+  /// stopped. Does not wake it.
+  void pushPinned(Worker& worker, Job&& job);
+
+  /// Take a job from the worker's pinned queue.
+  PooledJob* takePinned(Worker& worker);
+
+  /// Push a job onto the calling worker's own deque.
+  void pushLocal(Worker& worker, Job&& job);
+
+  /// Wake one sleeping worker, if there is one, so that it can steal.
+  void wakeOne(u32 fromIndex);
+
+  /// Returns the worker owned by the calling thread if it belongs to this
+  /// JobSystem, otherwise nullptr.
+  Worker* currentWorker() const;
+
+  /// Shared queue for jobs that found every worker inbox full. Lock-free,
+  /// unbounded and only touched on that slow path.
+  std::unique_ptr<JobQueue> m_injectQueue;
+
+  /// Jobs in m_injectQueue. Counted before they go in and after they come
+  /// out, so never below the real size. Lets idle workers look for injected
+  /// jobs with a single load.
+  std::atomic<u32> m_injectSize{0};
+
+  std::atomic<u64> m_overflowPushes{0};
+
+  /// See backlog(). Goes up when a job is admitted, and down when it starts.
+  std::atomic<u32> m_backlog{0};
+  u32 m_maxBacklog;
+  u32 m_highWater;
+  std::function<void(u32)> m_onHighWater;
+
+  /// False if neither m_maxBacklog nor m_highWater is set.
+  bool m_countBacklog;
+
+  /// Set when the backlog reaches m_highWater, cleared below half of it.
+  std::atomic<bool> m_aboveHighWater{false};
+
+  /// Submitters waiting in admit() for the backlog to have room. Starting
+  /// jobs only notify m_roomCv while this is above 0.
+  std::atomic<u32> m_roomWaiters{0};
+  std::mutex m_roomMutex;
+  std::condition_variable m_roomCv;
+
+  BlockingPool m_blockingPool;
+
+  /// Jobs only the worker of the same index runs, see addToWorker(). Sizes
+  /// are in Worker::pinnedSize.
+  List<std::unique_ptr<JobQueue>> m_pinnedQueues;
+
+  /// Jobs for the owner thread, see addToOwner(). m_ownerSize counts them
+  /// like m_injectSize.
+  std::unique_ptr<JobQueue> m_ownerQueue;
+  std::atomic<u32> m_ownerSize{0};
+  std::atomic<std::thread::id> m_ownerThread;
+
+  std::atomic<u64> m_externalJobsRun{0};
+
+  FiberConfig m_fiberConfig;
+
+  /// Guards the fiber lists below.
+  std::mutex m_fiberMutex;
+
+  /// Every fiber created, for destruction.
+  List<Fiber*> m_fibers;
+
+  /// Free fibers not kept by any worker.
+  List<Fiber*> m_freeFibers;
+
+  /// Fibers whose wait is over, oldest first. Has room for every fiber in
+  /// m_fibers, see acquireFiber().
+  Ring<Fiber*> m_readyFibers;
+
+  /// Mirror of m_readyFibers.size(), so that workers can check it without
+  /// taking the lock.
+  std::atomic<u32> m_readyFiberCount{0};
+
+  /// Fibers created so far, never more than FiberConfig::maxFibers.
+  std::atomic<u32> m_fiberCount{0};
+
+  /// dc::getTimeNs() at construction, trace timestamps and timer ticks count
+  /// from here.
+  u64 m_startNs;
+
+  /// Guards m_timers.
+  std::mutex m_timerMutex;
+  TimerWheel m_timers;
+  u64 m_timerTickNs;
+
+  /// dc::getTimeNs() at or before the next timer, TimerWheel::kNever if there
+  /// is none. Never later than the timer, so a worker that checks it never
+  /// misses one. Written under m_timerMutex.
+  std::atomic<u64> m_nextTimerNs{TimerWheel::kNever};
+
+  /// Index of the worker that parks until the next timer, -1 if none.
+  std::atomic<s32> m_timerWatcher{-1};
+
+  IdlePolicy m_idle;
+  u32 m_backgroundQuota;
+
+  ElasticPolicy m_elastic;
+  u64 m_growAfterNs;
+  u64 m_shrinkAfterNs;
+
+  /// Workers [0, m_activeCount) run. Changed under m_elasticMutex, along with
+  /// starting and stopping the threads.
+  std::atomic<u32> m_activeCount{0};
+  std::mutex m_elasticMutex;
+
+  /// Set by the destructor, under m_elasticMutex. No worker starts or stops
+  /// after.
+  bool m_stopping = false;
+
+  /// Worker pool. Fixed size after construction, an elastic pool starts and
+  /// stops the threads of the workers in it. Workers are heap-allocated
+  /// since they hold non-movable atomics and deques.
+  std::vector<std::unique_ptr<Worker>> m_workers;
 };
 
 }  // namespace dc
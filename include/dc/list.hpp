@@ -104,7 +104,8 @@ class List {
  public:
   /// Construct a new list. Starts off with the internal buffer memory.
   List(IAllocator& allocator = getDefaultAllocator())
-      : List(allocator, m_buffer, m_buffer, N) {}
+      : List(allocator, reinterpret_cast<T*>(m_buffer),
+             reinterpret_cast<T*>(m_buffer), N) {}
 
   /// Construct a new list. Depending on capacity, will either use internal
   /// buffer, or allocate from allocator.
@@ -215,10 +216,13 @@ class List {
   static constexpr u64 kInternalBuffer = N;
 
  private:
+  T* getBuffer() { return reinterpret_cast<T*>(m_buffer); }
+
   detail::BufferAwareAllocator m_allocator;
   T *m_begin = nullptr, *m_end = nullptr;
   u64 m_capacity = 0;
-  T m_buffer[N];
+  /// Raw storage, elements are only alive between m_begin and m_end.
+  alignas(T) u8 m_buffer[N * sizeof(T)];
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -227,23 +231,19 @@ class List {
 
 template <typename T, u64 N>
 List<T, N>::List(u64 capacity, IAllocator& allocator) : m_allocator(allocator) {
-  if (capacity <= N) {
-    m_begin = m_buffer;
-    m_end = m_buffer;
-    m_capacity = N;
-  } else
-    reserve(capacity);
+  m_begin = getBuffer();
+  m_end = getBuffer();
+  m_capacity = N;
+  if (capacity > N) reserve(capacity);
 }
 
 template <typename T, u64 N>
 List<T, N>::List(u64 capacity, const detail::BufferAwareAllocator& allocator)
     : m_allocator(allocator) {
-  if (capacity <= N) {
-    m_begin = m_buffer;
-    m_end = m_buffer;
-    m_capacity = N;
-  } else
-    reserve(capacity);
+  m_begin = getBuffer();
+  m_end = getBuffer();
+  m_capacity = N;
+  if (capacity > N) reserve(capacity);
 }
 
 template <typename T, u64 N>
@@ -253,13 +253,14 @@ List<T, N>::List(List&& other)
     m_begin = other.m_begin;
     m_end = other.m_end;
   } else {
-    m_begin = m_buffer;
-    m_end = m_buffer + other.getSize();
+    m_begin = getBuffer();
+    m_end = getBuffer() + other.getSize();
     if constexpr (isTriviallyRelocatable<T>) {
       memcpy(m_begin, other.m_begin, sizeof(T) * other.getSize());
     } else {
       for (u64 i = 0; i < other.getSize(); ++i) {
         new (m_begin + i) T(dc::move(*(other.m_begin + i)));
+        (other.m_begin + i)->~T();
       }
     }
   }
@@ -284,13 +285,14 @@ List<T, N>& List<T, N>::operator=(List&& other) noexcept {
       m_begin = other.m_begin;
       m_end = other.m_end;
     } else {
-      m_begin = m_buffer;
-      m_end = m_buffer + other.getSize();
+      m_begin = getBuffer();
+      m_end = getBuffer() + other.getSize();
       if constexpr (isTriviallyRelocatable<T>) {
         memcpy(m_begin, other.m_begin, sizeof(T) * other.getSize());
       } else {
         for (u64 i = 0; i < other.getSize(); ++i) {
           new (m_begin + i) T(dc::move(*(other.m_begin + i)));
+          (other.m_begin + i)->~T();
         }
       }
     }
@@ -331,7 +333,7 @@ T& List<T, N>::add() {
   if (getSize() >= m_capacity) reserve(getSize() * 2 + kDefaultExtraBytes);
 
   if (getSize() < m_capacity) {
-    T& elem = new (m_end) T();
+    T& elem = *new (m_end) T();
     m_end += 1;
     return elem;
   } else {
@@ -347,7 +349,7 @@ void List<T, N>::addRange(const T* begin, const T* end) {
     const u64 rangeSize = static_cast<u64>(end - begin);
     resize(oldSize + rangeSize);
     if (oldSize + rangeSize <= m_capacity)  // did resize work?
-      memcpy(m_begin + oldSize, begin, rangeSize);
+      memcpy(m_begin + oldSize, begin, sizeof(T) * rangeSize);
   } else {
     const u64 oldSize = getSize();
     const u64 rangeSize = static_cast<u64>(end - begin);
@@ -373,10 +375,8 @@ void List<T, N>::remove(T* elem) {
       memmove(elem, elem + 1, sizeof(T) * remaining);
     }
   } else {
-    elem->~T();
-    for (; (elem + 1) != m_end; ++elem) {
-      new (elem) T(dc::move(*(elem + 1)));
-    }
+    for (; (elem + 1) != m_end; ++elem) *elem = dc::move(*(elem + 1));
+    (m_end - 1)->~T();
   }
 
   --m_end;
@@ -390,6 +390,7 @@ void List<T, N>::remove(const T& elem) {
 
   for (; (it + 1) != m_end; ++it) *it = dc::move(*(it + 1));
 
+  if constexpr (!isTriviallyRelocatable<T>) (m_end - 1)->~T();
   --m_end;
 }
 
@@ -437,15 +438,15 @@ List<T, N>::List(const List& other)
     : m_allocator(other.m_allocator), m_capacity(other.m_capacity) {
   if (other.m_capacity <= N) {
     // Other uses internal buffer, use our internal buffer too
-    m_begin = m_buffer;
-    m_end = m_buffer;
+    m_begin = getBuffer();
+    m_end = getBuffer();
   } else {
     // Other uses heap, allocate on heap
     m_begin = static_cast<T*>(m_allocator.alloc(sizeof(T) * other.m_capacity));
     if (!m_begin) {
       // Allocation failed, fall back to internal buffer
-      m_begin = m_buffer;
-      m_end = m_buffer;
+      m_begin = getBuffer();
+      m_end = getBuffer();
       m_capacity = N;
       return;
     }
@@ -477,14 +478,14 @@ List<T, N>& List<T, N>::operator=(const List& other) {
     m_capacity = other.m_capacity;
 
     if (other.m_capacity <= N) {
-      m_begin = m_buffer;
-      m_end = m_buffer;
+      m_begin = getBuffer();
+      m_end = getBuffer();
     } else {
       m_begin =
           static_cast<T*>(m_allocator.alloc(sizeof(T) * other.m_capacity));
       if (!m_begin) {
-        m_begin = m_buffer;
-        m_end = m_buffer;
+        m_begin = getBuffer();
+        m_end = getBuffer();
         m_capacity = N;
         return *this;
       }
@@ -535,8 +536,10 @@ void List<T, N>::reserve(u64 capacity) {
       T* newBegin = static_cast<T*>(m_allocator.alloc(sizeof(T) * capacity));
       if (!newBegin) return;  // failed to alloc, noop
 
-      for (T* elem = m_begin; elem != m_end; ++elem)
+      for (T* elem = m_begin; elem != m_end; ++elem) {
         new (newBegin + (elem - m_begin)) T(dc::move(*elem));
+        elem->~T();
+      }
 
       if (hasAllocated) m_allocator.free(m_begin);
 
@@ -0,0 +1,261 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <dc/assert.hpp>
+#include <dc/macros.hpp>
+#include <dc/math.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+/// Multi-producer / multi-consumer lock-free bounded ring buffer.
+///
+/// Design from Dmitry Vyukov's bounded MPMC queue
+/// (https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+/// Every slot carries a sequence number that tells producers and consumers
+/// whose turn it is, so a slot is claimed with a single CAS on the shared
+/// index and then written or read without further synchronization.
+///
+/// Thread safety contract:
+///   - Any number of threads may call add(), remove() and their bulk versions
+///     concurrently.
+///   - size(), isEmpty(), isFull() are approximate when called concurrently.
+///
+/// The capacity must be a power of 2 and is fixed at construction.
+/// add() returns false if the ring is full — it never grows.
+template <typename T>
+class MpmcRing {
+ public:
+  /// Construct with a fixed power-of-2 capacity.
+  /// @param capacity Must be > 0. Will be rounded up to the next power of 2.
+  explicit MpmcRing(u32 capacity) {
+    capacity = roundUpToPowerOf2(capacity);
+    DC_ASSERT(capacity > 0, "MpmcRing capacity must be > 0");
+    m_cells = new Cell[capacity];
+    m_capacity = capacity;
+    for (u32 i = 0; i < capacity; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MpmcRing() { delete[] m_cells; }
+
+  DC_DELETE_COPY(MpmcRing);
+  DC_DELETE_MOVE(MpmcRing);
+
+  /// Add an element. May be called from any thread.
+  /// @return false if the ring is full.
+  bool add(T&& elem) {
+    u32 write = m_write.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &m_cells[mask(write)];
+      const u32 sequence = cell->sequence.load(std::memory_order_acquire);
+      const s32 diff = static_cast<s32>(sequence - write);
+
+      if (diff == 0) {
+        // Slot is free for this lap, try to claim it.
+        if (m_write.compare_exchange_weak(write, write + 1,
+                                          std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        // Another producer claimed it first, catch up.
+        write = m_write.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = dc::move(elem);
+    cell->sequence.store(write + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Add up to count elements, moved out of elems, claiming their slots with
+  /// a single CAS on the shared index. May be called from any thread.
+  ///
+  /// The elements are published together, by one release fence once all of
+  /// them are written. Each slot is still marked on its own after that, so a
+  /// consumer may take the first ones before the last are marked.
+  /// @return Number of elements added, less than count if the ring filled up.
+  ///         Elements that were not added are left untouched.
+  u32 addBulk(T* elems, u32 count) {
+    if (count == 0) return 0;
+
+    u32 write = m_write.load(std::memory_order_relaxed);
+    u32 claimed;
+    while (true) {
+      // Count the free slots in a row from write. Consumers may free slots
+      // out of order, so stop at the first one that is still taken.
+      claimed = 0;
+      s32 diff = 0;
+      while (claimed < count) {
+        const Cell& cell = m_cells[mask(write + claimed)];
+        const u32 sequence = cell.sequence.load(std::memory_order_acquire);
+        diff = static_cast<s32>(sequence - (write + claimed));
+        if (diff != 0) break;
+        ++claimed;
+      }
+
+      if (claimed > 0) {
+        if (m_write.compare_exchange_weak(write, write + claimed,
+                                          std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return 0;  // full
+      } else {
+        write = m_write.load(std::memory_order_relaxed);
+      }
+    }
+
+    for (u32 i = 0; i < claimed; ++i) {
+      m_cells[mask(write + i)].data = dc::move(elems[i]);
+    }
+    // Pairs with the acquire load of a slot's sequence by consumers.
+    std::atomic_thread_fence(std::memory_order_release);
+    for (u32 i = 0; i < claimed; ++i) {
+      m_cells[mask(write + i)].sequence.store(write + i + 1,
+                                              std::memory_order_relaxed);
+    }
+    return claimed;
+  }
+
+  /// Remove the front element. May be called from any thread.
+  /// @param out Receives the element on success.
+  /// @return false if the ring is empty.
+  bool remove(T& out) {
+    u32 read = m_read.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &m_cells[mask(read)];
+      const u32 sequence = cell->sequence.load(std::memory_order_acquire);
+      const s32 diff = static_cast<s32>(sequence - (read + 1));
+
+      if (diff == 0) {
+        // Slot holds an element for this lap, try to claim it.
+        if (m_read.compare_exchange_weak(read, read + 1,
+                                         std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // empty
+      } else {
+        // Another consumer claimed it first, catch up.
+        read = m_read.load(std::memory_order_relaxed);
+      }
+    }
+
+    out = dc::move(cell->data);
+    // Hand the slot back to producers for the next lap.
+    cell->sequence.store(read + m_capacity, std::memory_order_release);
+    return true;
+  }
+
+  /// Remove up to count elements from the front, moving them into out, and
+  /// claim their slots with a single CAS on the shared index. May be called
+  /// from any thread. The slots go back to producers together, like addBulk()
+  /// publishes its elements.
+  /// @return Number of elements removed, 0 if the ring is empty.
+  u32 removeBulk(T* out, u32 count) {
+    if (count == 0) return 0;
+
+    u32 read = m_read.load(std::memory_order_relaxed);
+    u32 claimed;
+    while (true) {
+      // Count the published elements in a row from read. Producers may
+      // publish out of order, so stop at the first one still being written.
+      claimed = 0;
+      s32 diff = 0;
+      while (claimed < count) {
+        const Cell& cell = m_cells[mask(read + claimed)];
+        const u32 sequence = cell.sequence.load(std::memory_order_acquire);
+        diff = static_cast<s32>(sequence - (read + claimed + 1));
+        if (diff != 0) break;
+        ++claimed;
+      }
+
+      if (claimed > 0) {
+        if (m_read.compare_exchange_weak(read, read + claimed,
+                                         std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return 0;  // empty
+      } else {
+        read = m_read.load(std::memory_order_relaxed);
+      }
+    }
+
+    for (u32 i = 0; i < claimed; ++i) {
+      out[i] = dc::move(m_cells[mask(read + i)].data);
+    }
+    // Pairs with the acquire load of a slot's sequence by producers.
+    std::atomic_thread_fence(std::memory_order_release);
+    for (u32 i = 0; i < claimed; ++i) {
+      m_cells[mask(read + i)].sequence.store(read + i + m_capacity,
+                                             std::memory_order_relaxed);
+    }
+    return claimed;
+  }
+
+  /// Number of elements currently in the ring.
+  /// May be called from any thread (approximate when called concurrently).
+  u32 size() const {
+    const u32 write = m_write.load(std::memory_order_acquire);
+    const u32 read = m_read.load(std::memory_order_acquire);
+    const s32 diff = static_cast<s32>(write - read);
+    return diff > 0 ? static_cast<u32>(diff) : 0u;
+  }
+
+  bool isEmpty() const { return size() == 0; }
+
+  bool isFull() const { return size() >= m_capacity; }
+
+  u32 capacity() const { return m_capacity; }
+
+ private:
+  struct Cell {
+    std::atomic<u32> sequence;
+    T data{};
+  };
+
+  u32 mask(u32 index) const { return index & (m_capacity - 1); }
+
+  Cell* m_cells = nullptr;
+  u32 m_capacity = 0;
+
+  // Producers and consumers each hammer their own index. Keep them on
+  // separate cache lines to avoid false sharing.
+  alignas(64) std::atomic<u32> m_write{0};
+  alignas(64) std::atomic<u32> m_read{0};
+};
+
+}  // namespace dc
@@ -0,0 +1,402 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <dc/assert.hpp>
+#include <dc/job/job.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/macros.hpp>
+#include <dc/math.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+/// Data parallel algorithms on top of JobSystem.
+///
+/// The range is cut into chunks of grainSize elements. The calling thread
+/// hands the upper half of the chunks to the JobSystem as a single job, and
+/// keeps halving what is left until one chunk remains, which it runs itself.
+/// Every job does the same with its half, so the work fans out in log2(chunks)
+/// steps and costs one job per chunk rather than one per element. Jobs spawned
+/// from a worker land on its deque, where idle workers steal the largest
+/// halves first.
+///
+/// All functions block until the whole range is processed. The callables are
+/// shared by reference between the worker threads, so they must be safe to
+/// call concurrently. Like JobHandle::await(), the calling thread runs other
+/// jobs while it waits, so the loops may be nested and called from jobs.
+///
+/// A grainSize of 0 picks one that gives every worker a few chunks, which
+/// leaves some slack for stealing to even out uneven chunks. Pass an explicit
+/// grain size when the per-element cost is tiny and the range is small, so
+/// that a chunk is worth more than the cost of scheduling it.
+///
+/// Usage:
+/// @code
+///   dc::parallelFor(js, particles, [](Particle& p) { p.integrate(dt); });
+///   const f32 total = dc::parallelReduce(
+///       js, weights.begin(), weights.end(), 0.0f, std::plus<>{});
+/// @endcode
+
+namespace dc {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Detail
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// How many chunks per worker the default grain size aims for.
+constexpr usize kParallelChunksPerWorker = 4;
+
+[[nodiscard]] inline usize parallelGrainSize(const JobSystem& js, usize count,
+                                             usize grainSize) {
+  if (grainSize > 0) return grainSize;
+  const usize target =
+      dc::max<usize>(js.workerCount(), 1) * kParallelChunksPerWorker;
+  return dc::max<usize>((count + target - 1) / target, 1);
+}
+
+[[nodiscard]] inline usize parallelChunkCount(usize count, usize grain) {
+  return (count + grain - 1) / grain;
+}
+
+/// State of one parallel loop. Lives on the stack of the calling thread, which
+/// does not return before every chunk has decremented the counter.
+template <typename ChunkFn>
+class ParallelLoop {
+ public:
+  ParallelLoop(JobSystem& js, ChunkFn& fn, usize count, usize grain,
+               u32 chunkCount)
+      : m_js(js),
+        m_fn(fn),
+        m_count(count),
+        m_grain(grain),
+        m_counter(chunkCount, &js) {}
+
+  DC_DELETE_COPY(ParallelLoop);
+  DC_DELETE_MOVE(ParallelLoop);
+
+  /// Run the chunks [first, last). Hands the upper half to the JobSystem until
+  /// a single chunk is left, then runs that one on the calling thread.
+  void run(u32 first, u32 last) {
+    while (last - first > 1) {
+      const u32 mid = first + (last - first) / 2;
+      m_js.add(Job{[this, mid, last] { run(mid, last); }});
+      last = mid;
+    }
+
+    const usize lo = static_cast<usize>(first) * m_grain;
+    const usize hi = dc::min(lo + m_grain, m_count);
+    m_fn(static_cast<usize>(first), lo, hi);
+    m_counter.decrement();
+  }
+
+  void wait() { m_js.await(m_counter); }
+
+ private:
+  JobSystem& m_js;
+  ChunkFn& m_fn;
+  usize m_count;
+  usize m_grain;
+  JobCounter m_counter;
+};
+
+/// Call fn(chunkIndex, lo, hi) for every grain sized chunk of [0, count), in
+/// parallel. Blocks until all chunks are done.
+template <typename ChunkFn>
+void forEachChunk(JobSystem& js, usize count, usize grain, ChunkFn&& fn) {
+  const usize chunkCount = parallelChunkCount(count, grain);
+  if (chunkCount == 0) return;
+  if (chunkCount == 1) {
+    fn(usize{0}, usize{0}, count);
+    return;
+  }
+
+  DC_ASSERT(chunkCount <= 0xffffffffu, "Too many chunks, raise the grain size");
+  ParallelLoop<std::remove_reference_t<ChunkFn>> loop(
+      js, fn, count, grain, static_cast<u32>(chunkCount));
+  loop.run(0, static_cast<u32>(chunkCount));
+  loop.wait();
+}
+
+/// A cache line, ParallelPartial is padded to a multiple of it.
+constexpr usize kParallelPartialBytes = 64;
+
+/// Per chunk result, padded so that neighbouring chunks seldom write to the
+/// same cache line. Padded rather than aligned, List does not over-align the
+/// memory it allocates.
+template <typename T>
+struct ParallelPartial {
+  T value;
+  u8 padding[kParallelPartialBytes - sizeof(T) % kParallelPartialBytes];
+};
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelFor
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Call fn(i) for every index in [begin, end).
+template <typename Fn>
+void parallelFor(JobSystem& js, usize begin, usize end, Fn&& fn,
+                 usize grainSize = 0) {
+  if (begin >= end) return;
+  const usize count = end - begin;
+  detail::forEachChunk(js, count,
+                       detail::parallelGrainSize(js, count, grainSize),
+                       [begin, &fn](usize, usize lo, usize hi) {
+                         for (usize i = begin + lo; i < begin + hi; ++i) fn(i);
+                       });
+}
+
+/// Call fn(elem) for every element in [begin, end).
+template <typename T, typename Fn>
+void parallelFor(JobSystem& js, T* begin, T* end, Fn&& fn,
+                 usize grainSize = 0) {
+  const usize count = static_cast<usize>(end - begin);
+  detail::forEachChunk(js, count,
+                       detail::parallelGrainSize(js, count, grainSize),
+                       [begin, &fn](usize, usize lo, usize hi) {
+                         for (usize i = lo; i < hi; ++i) fn(begin[i]);
+                       });
+}
+
+/// Call fn(elem) for every element in the list.
+template <typename T, u64 N, typename Fn>
+void parallelFor(JobSystem& js, List<T, N>& list, Fn&& fn,
+                 usize grainSize = 0) {
+  parallelFor(js, list.begin(), list.end(), fn, grainSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelReduce
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Fold [begin, end) with op, starting from identity.
+///
+/// Each chunk is folded on its own, then the chunk results are folded in order
+/// on the calling thread. op must be associative, but need not be commutative.
+/// The result only depends on the grain size, not on scheduling, so it is
+/// reproducible for floating point too.
+///
+/// @param identity Value such that op(identity, x) == x. Used once per chunk.
+/// @param op Callable as T(T, const T&).
+template <typename T, typename Op>
+[[nodiscard]] T parallelReduce(JobSystem& js, const T* begin, const T* end,
+                               std::type_identity_t<T> identity, Op&& op,
+                               usize grainSize = 0) {
+  const usize count = static_cast<usize>(end - begin);
+  const usize grain = detail::parallelGrainSize(js, count, grainSize);
+
+  const usize chunkCount = detail::parallelChunkCount(count, grain);
+  List<detail::ParallelPartial<T>> partials(chunkCount);
+  for (usize i = 0; i < chunkCount; ++i) {
+    partials.add(detail::ParallelPartial<T>{identity, {}});
+  }
+
+  detail::forEachChunk(
+      js, count, grain,
+      [begin, &partials, &op](usize chunk, usize lo, usize hi) {
+        T& acc = partials[chunk].value;
+        for (usize i = lo; i < hi; ++i) acc = op(dc::move(acc), begin[i]);
+      });
+
+  T result = dc::move(identity);
+  for (detail::ParallelPartial<T>& partial : partials) {
+    result = op(dc::move(result), partial.value);
+  }
+  return result;
+}
+
+/// Fold the list with op, starting from identity.
+template <typename T, u64 N, typename Op>
+[[nodiscard]] T parallelReduce(JobSystem& js, const List<T, N>& list,
+                               std::type_identity_t<T> identity, Op&& op,
+                               usize grainSize = 0) {
+  return parallelReduce(js, static_cast<const T*>(list.begin()),
+                        static_cast<const T*>(list.end()), dc::move(identity),
+                        op, grainSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelTransform
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Write fn(begin[i]) to out[i] for every element in [begin, end).
+/// out must have room for end - begin elements. It may be begin itself.
+template <typename In, typename Out, typename Fn>
+void parallelTransform(JobSystem& js, const In* begin, const In* end, Out* out,
+                       Fn&& fn, usize grainSize = 0) {
+  const usize count = static_cast<usize>(end - begin);
+  detail::forEachChunk(js, count,
+                       detail::parallelGrainSize(js, count, grainSize),
+                       [begin, out, &fn](usize, usize lo, usize hi) {
+                         for (usize i = lo; i < hi; ++i) out[i] = fn(begin[i]);
+                       });
+}
+
+/// Resize out to the size of in, and write fn(in[i]) to out[i].
+template <typename In, u64 N, typename Out, u64 M, typename Fn>
+void parallelTransform(JobSystem& js, const List<In, N>& in, List<Out, M>& out,
+                       Fn&& fn, usize grainSize = 0) {
+  out.resize(in.getSize());
+  parallelTransform(js, static_cast<const In*>(in.begin()),
+                    static_cast<const In*>(in.end()), out.begin(), fn,
+                    grainSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelSort
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Sort [begin, end) with comp. Not stable.
+///
+/// Chunks are sorted in parallel, then merged pairwise in log2(chunks) passes,
+/// each of which merges its pairs in parallel. Uses a scratch buffer of
+/// end - begin elements.
+template <typename T, typename Compare = std::less<>>
+void parallelSort(JobSystem& js, T* begin, T* end, Compare comp = {},
+                  usize grainSize = 0) {
+  const usize count = static_cast<usize>(end - begin);
+  const usize grain = detail::parallelGrainSize(js, count, grainSize);
+  if (detail::parallelChunkCount(count, grain) <= 1) {
+    std::sort(begin, end, comp);
+    return;
+  }
+
+  detail::forEachChunk(js, count, grain,
+                       [begin, &comp](usize, usize lo, usize hi) {
+                         std::sort(begin + lo, begin + hi, comp);
+                       });
+
+  // Ping-pong between the scratch buffer and the input, doubling the length
+  // of the sorted runs every pass.
+  List<T> scratch(count);
+  for (T* it = begin; it != end; ++it) scratch.add(dc::move(*it));
+  T* src = scratch.begin();
+  T* dst = begin;
+  for (usize width = grain; width < count; width *= 2) {
+    detail::forEachChunk(
+        js, count, width * 2,
+        [src, dst, width, &comp](usize, usize lo, usize hi) {
+          const usize mid = dc::min(lo + width, hi);
+          std::merge(std::make_move_iterator(src + lo),
+                     std::make_move_iterator(src + mid),
+                     std::make_move_iterator(src + mid),
+                     std::make_move_iterator(src + hi), dst + lo, comp);
+        });
+    std::swap(src, dst);
+  }
+
+  if (src != begin) {
+    detail::forEachChunk(js, count, grain,
+                         [src, begin](usize, usize lo, usize hi) {
+                           std::move(src + lo, src + hi, begin + lo);
+                         });
+  }
+}
+
+/// Sort the list with comp. Not stable.
+template <typename T, u64 N, typename Compare = std::less<>>
+void parallelSort(JobSystem& js, List<T, N>& list, Compare comp = {},
+                  usize grainSize = 0) {
+  parallelSort(js, list.begin(), list.end(), dc::move(comp), grainSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelScan
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Inclusive prefix scan: out[i] = op(...op(op(identity, begin[0]),
+/// begin[1])..., begin[i]).
+///
+/// Runs in two parallel passes. The first folds every chunk but the last,
+/// the calling thread then scans those totals into per chunk offsets, and the
+/// second pass scans every chunk from its offset. op must be associative.
+///
+/// out must have room for end - begin elements. It may be begin itself.
+/// @param op Callable as T(T, const T&).
+template <typename T, typename Op>
+void parallelScan(JobSystem& js, const T* begin, const T* end, T* out,
+                  std::type_identity_t<T> identity, Op&& op,
+                  usize grainSize = 0) {
+  const usize count = static_cast<usize>(end - begin);
+  const usize grain = detail::parallelGrainSize(js, count, grainSize);
+  const usize chunkCount = detail::parallelChunkCount(count, grain);
+
+  List<detail::ParallelPartial<T>> offsets(chunkCount);
+  for (usize i = 0; i < chunkCount; ++i) {
+    offsets.add(detail::ParallelPartial<T>{identity, {}});
+  }
+
+  if (chunkCount > 1) {
+    // Fold each chunk into the slot of the chunk after it.
+    detail::forEachChunk(
+        js, count, grain,
+        [begin, chunkCount, &offsets, &op](usize chunk, usize lo, usize hi) {
+          if (chunk + 1 == chunkCount) return;
+          T& acc = offsets[chunk + 1].value;
+          for (usize i = lo; i < hi; ++i) acc = op(dc::move(acc), begin[i]);
+        });
+
+    // offsets[chunk] now holds the total of the chunk before it, turn that
+    // into the total of all chunks before it.
+    for (usize chunk = 2; chunk < chunkCount; ++chunk) {
+      offsets[chunk].value =
+          op(T(offsets[chunk - 1].value), offsets[chunk].value);
+    }
+  }
+
+  detail::forEachChunk(
+      js, count, grain,
+      [begin, out, &offsets, &op](usize chunk, usize lo, usize hi) {
+        T acc = offsets[chunk].value;
+        for (usize i = lo; i < hi; ++i) {
+          acc = op(dc::move(acc), begin[i]);
+          out[i] = acc;
+        }
+      });
+}
+
+/// Inclusive prefix scan of in into out. Resizes out to the size of in.
+template <typename T, u64 N, u64 M, typename Op>
+void parallelScan(JobSystem& js, const List<T, N>& in, List<T, M>& out,
+                  std::type_identity_t<T> identity, Op&& op,
+                  usize grainSize = 0) {
+  out.resize(in.getSize());
+  parallelScan(js, static_cast<const T*>(in.begin()),
+               static_cast<const T*>(in.end()), out.begin(),
+               dc::move(identity), op, grainSize);
+}
+
+}  // namespace dc
@@ -0,0 +1,309 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/assert.hpp>
+#include <dc/inline_function.hpp>
+#include <dc/job/job.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/macros.hpp>
+#include <dc/types.hpp>
+#include <mutex>
+
+namespace dc {
+
+/// How a pipeline stage runs the items that reach it.
+enum class StageMode : u8 {
+  /// Any number of items at once.
+  Parallel,
+
+  /// One item at a time, in the order the source produced them.
+  SerialInOrder,
+
+  /// One item at a time, in whatever order they arrive.
+  SerialOutOfOrder,
+};
+
+/// Bytes of capture storage for a pipeline stage or source.
+constexpr usize kPipelineCaptureBytes = 48;
+
+/// A stream of items pushed through a chain of stages on the JobSystem.
+///
+/// The source fills one item at a time, until it returns false. Each item
+/// then goes through the stages in order, each stage running the items as its
+/// StageMode allows. While one item is being written by a serial stage, the
+/// next ones are already being transformed and the source is reading ahead,
+/// so a serial reader and writer are both kept busy.
+///
+/// At most maxTokens items are in flight at once. The items live in that many
+/// slots, which are reused: the source is handed a T that has been through the
+/// pipeline before, and can keep its buffers. Once the slots are all in use
+/// the source stops until the first item comes out at the end.
+///
+/// An item is carried through consecutive stages by the same job for as long
+/// as it can enter them. An item that has to wait for a serial stage is queued
+/// there, and handed to a new job by the item that leaves the stage before it.
+///
+/// Usage:
+/// @code
+///   struct Chunk { dc::List<u8> bytes; dc::List<Record> records; };
+///
+///   dc::Pipeline<Chunk> pipeline(js, 16);
+///   pipeline.source([&file](Chunk& chunk) { return readChunk(file, chunk); })
+///       .stage(dc::StageMode::Parallel,
+///              [](Chunk& chunk) { parseRecords(chunk); })
+///       .stage(dc::StageMode::SerialInOrder,
+///              [&out](Chunk& chunk) { writeRecords(out, chunk); });
+///   pipeline.run();
+/// @endcode
+template <typename T>
+class Pipeline {
+ public:
+  using SourceFn = InlineFunction<bool(T&), kPipelineCaptureBytes>;
+  using StageFn = InlineFunction<void(T&), kPipelineCaptureBytes>;
+
+  /// @param maxTokens Most items in flight at once. A few per worker keeps
+  ///                  parallel stages busy while serial ones catch up.
+  Pipeline(JobSystem& js, u32 maxTokens) : m_js(js), m_tokens(maxTokens) {
+    DC_ASSERT(maxTokens > 0, "A pipeline needs at least one token");
+    // Never resized again, the stages hold on to token pointers.
+    m_tokens.resize(maxTokens);
+  }
+
+  DC_DELETE_COPY(Pipeline);
+  DC_DELETE_MOVE(Pipeline);
+
+  /// Set the source. Called serially, fills in the item and returns true, or
+  /// returns false once there is no more input.
+  template <typename Fn>
+  Pipeline& source(Fn&& fn) {
+    m_source = SourceFn(dc::forward<Fn>(fn));
+    return *this;
+  }
+
+  /// Add a stage after the ones added so far.
+  template <typename Fn>
+  Pipeline& stage(StageMode mode, Fn&& fn) {
+    Stage& added = m_stages.add();
+    added.mode = mode;
+    added.fn = StageFn(dc::forward<Fn>(fn));
+    if (mode == StageMode::SerialInOrder) {
+      added.inOrder.resize(m_tokens.getSize());
+    } else if (mode == StageMode::SerialOutOfOrder) {
+      added.outOfOrder.resize(m_tokens.getSize());
+    }
+    return *this;
+  }
+
+  /// Run until the source returns false and every item it produced went
+  /// through all stages. Like JobHandle::await(), the calling thread runs
+  /// other jobs meanwhile. May be called again to run another stream.
+  void run() {
+    DC_ASSERT(m_source, "Pipeline has no source");
+    m_free.clear();
+    for (Token& token : m_tokens) m_free.add(&token);
+    for (Stage& stage : m_stages) stage.nextSeq = 0;
+    m_nextSeq = 0;
+    m_inFlight = 0;
+    m_exhausted = false;
+    m_sourceBusy = true;
+
+    JobCounter done(1u, &m_js);
+    m_done = &done;
+    m_js.add(Job{[this] { produce(); }});
+    m_js.await(done);
+    m_done = nullptr;
+  }
+
+ private:
+  struct Token {
+    T value{};
+
+    /// Position in the stream, set by the source.
+    u64 seq = 0;
+  };
+
+  struct Stage {
+    StageMode mode = StageMode::Parallel;
+    StageFn fn;
+
+    /// Serial stages only. True while an item runs in the stage.
+    bool busy = false;
+
+    /// SerialInOrder only. The item that may enter next.
+    u64 nextSeq = 0;
+
+    /// SerialInOrder only. Items waiting to enter, at seq % maxTokens. Never
+    /// more than maxTokens apart, so they do not collide.
+    List<Token*> inOrder;
+
+    /// SerialOutOfOrder only. Items waiting to enter, outOfOrderCount of them
+    /// from outOfOrderHead on, wrapping around. Never more than maxTokens.
+    List<Token*> outOfOrder;
+    u64 outOfOrderHead = 0;
+    u64 outOfOrderCount = 0;
+  };
+
+  /// Fill free tokens until there are none left, or no more input. Only one
+  /// produce() runs at a time, see m_sourceBusy.
+  void produce() {
+    while (true) {
+      Token* token = nullptr;
+      {
+        std::scoped_lock lock(m_mutex);
+        if (m_free.isEmpty()) {
+          // finish() starts us again once a token comes back.
+          m_sourceBusy = false;
+          return;
+        }
+        token = m_free.getLast();
+        m_free.removeAt(m_free.getSize() - 1);
+        ++m_inFlight;
+      }
+
+      if (!m_source(token->value)) {
+        bool finished = false;
+        {
+          std::scoped_lock lock(m_mutex);
+          m_free.add(token);
+          --m_inFlight;
+          m_exhausted = true;
+          m_sourceBusy = false;
+          finished = m_inFlight == 0;
+        }
+        if (finished) m_done->decrement();
+        return;
+      }
+
+      token->seq = m_nextSeq++;
+      m_js.add(Job{[this, token] { process(token, 0, false); }});
+    }
+  }
+
+  /// Take the item through the stages from first on, until it has to wait
+  /// for a serial stage or comes out at the end.
+  /// @param entered True if the item already entered stage first.
+  void process(Token* token, usize first, bool entered) {
+    for (usize i = first; i < m_stages.getSize(); ++i) {
+      Stage& stage = m_stages[i];
+      if (stage.mode == StageMode::Parallel) {
+        stage.fn(token->value);
+        continue;
+      }
+
+      if (!(entered && i == first) && !enter(stage, token)) return;
+      stage.fn(token->value);
+      leave(stage, i);
+    }
+    finish(token);
+  }
+
+  /// @return True if the item may run in the serial stage now. Otherwise it
+  /// is queued, and leave() picks it up.
+  bool enter(Stage& stage, Token* token) {
+    std::scoped_lock lock(m_mutex);
+    const bool inOrder = stage.mode == StageMode::SerialInOrder;
+    if (!stage.busy && (!inOrder || token->seq == stage.nextSeq)) {
+      stage.busy = true;
+      return true;
+    }
+
+    if (inOrder) {
+      stage.inOrder[token->seq % m_tokens.getSize()] = token;
+    } else {
+      const u64 tail = stage.outOfOrderHead + stage.outOfOrderCount++;
+      stage.outOfOrder[tail % m_tokens.getSize()] = token;
+    }
+    return false;
+  }
+
+  /// Let the next item into the serial stage, on a job of its own.
+  void leave(Stage& stage, usize index) {
+    Token* next = nullptr;
+    {
+      std::scoped_lock lock(m_mutex);
+      if (stage.mode == StageMode::SerialInOrder) {
+        ++stage.nextSeq;
+        Token*& slot = stage.inOrder[stage.nextSeq % m_tokens.getSize()];
+        if (slot && slot->seq == stage.nextSeq) {
+          next = slot;
+          slot = nullptr;
+        }
+      } else if (stage.outOfOrderCount > 0) {
+        next = stage.outOfOrder[stage.outOfOrderHead];
+        stage.outOfOrderHead = (stage.outOfOrderHead + 1) % m_tokens.getSize();
+        --stage.outOfOrderCount;
+      }
+      stage.busy = next != nullptr;
+    }
+
+    if (next) {
+      m_js.add(Job{[this, next, index] { process(next, index, true); }});
+    }
+  }
+
+  /// Give the token back, restarting the source if it ran out of tokens.
+  void finish(Token* token) {
+    bool restart = false;
+    bool finished = false;
+    {
+      std::scoped_lock lock(m_mutex);
+      m_free.add(token);
+      --m_inFlight;
+      if (!m_sourceBusy && !m_exhausted) {
+        m_sourceBusy = true;
+        restart = true;
+      }
+      finished = m_exhausted && m_inFlight == 0;
+    }
+
+    if (restart) m_js.add(Job{[this] { produce(); }});
+    // Last, run() may return and destroy the pipeline right after.
+    if (finished) m_done->decrement();
+  }
+
+  JobSystem& m_js;
+  SourceFn m_source;
+  List<Stage> m_stages;
+  List<Token> m_tokens;
+
+  /// Guards the stage queues, the free tokens and the source state. Only held
+  /// to hand items over, never while a stage runs.
+  std::mutex m_mutex;
+  List<Token*> m_free;
+  u32 m_inFlight = 0;
+  bool m_exhausted = false;
+  bool m_sourceBusy = false;
+
+  /// Owned by the running produce().
+  u64 m_nextSeq = 0;
+
+  JobCounter* m_done = nullptr;
+};
+
+}  // namespace dc
@@ -624,7 +624,7 @@ class Result {
 
   Result(Err<E>&& err) : m_err(dc::forward<E>(err.value())), m_isOk(false) {}
 
-  Result(Result&& other) : m_isOk(other.m_isOk) {
+  Result(Result&& other) noexcept : m_isOk(other.m_isOk) {
     if (other.isOk())
       new (&m_value) V(dc::move(other.m_value));
     else
@@ -36,8 +36,8 @@ namespace dc {
 /// Single-producer / single-consumer lock-free ring buffer.
 ///
 /// Thread safety contract:
-///   - Only ONE producer thread may call add().
-///   - Only ONE consumer thread may call remove().
+///   - Only ONE producer thread may call add() and addBulk().
+///   - Only ONE consumer thread may call remove() and removeBulk().
 ///   - Both threads may call size(), isEmpty(), isFull() at any time.
 ///
 /// The capacity must be a power of 2 and is fixed at construction.
@@ -72,10 +72,26 @@ class SpscRing {
     return true;
   }
 
+  /// Add up to count elements, moved out of elems, and publish them all with
+  /// a single store. Called only by the producer thread.
+  /// @return Number of elements added, less than count if the ring filled up.
+  ///         Elements that were not added are left untouched.
+  u32 addBulk(T* elems, u32 count) {
+    const u32 write = m_write.load(std::memory_order_relaxed);
+    const u32 read = m_read.load(std::memory_order_acquire);
+
+    const u32 added = dc::min(count, m_capacity - (write - read));
+    for (u32 i = 0; i < added; ++i) {
+      m_data[mask(write + i)] = dc::move(elems[i]);
+    }
+    if (added > 0) m_write.store(write + added, std::memory_order_release);
+    return added;
+  }
+
   /// Remove the front element. Called only by the consumer thread.
   ///
   /// The returned pointer is valid until the *next* call to remove().
-  /// The element is copied into an internal single-slot buffer so that the
+  /// The element is moved into an internal single-slot buffer so that the
   /// ring slot is freed to the producer immediately, yet the caller can safely
   /// read through the returned pointer until the next remove() call.
   ///
@@ -86,17 +102,32 @@ class SpscRing {
 
     if (read == write) return nullptr;  // empty
 
-    // Copy the value out of the shared ring slot into the consumer-private
+    // Move the value out of the shared ring slot into the consumer-private
     // buffer before advancing m_read.  The producer may not touch the slot
-    // until m_read is stored, and we store it only after the copy, so there
+    // until m_read is stored, and we store it only after the move, so there
     // is no race on the read side.  The caller reads from m_lastRemoved (not
     // from the ring slot), so even if the producer immediately refills the
     // slot after our store, the returned pointer remains valid.
-    m_lastRemoved = m_data[mask(read)];
+    m_lastRemoved = dc::move(m_data[mask(read)]);
     m_read.store(read + 1, std::memory_order_release);
     return &m_lastRemoved;
   }
 
+  /// Remove up to count elements from the front, moving them into out, and
+  /// free their slots with a single store. Called only by the consumer thread.
+  /// @return Number of elements removed, 0 if the ring is empty.
+  u32 removeBulk(T* out, u32 count) {
+    const u32 read = m_read.load(std::memory_order_relaxed);
+    const u32 write = m_write.load(std::memory_order_acquire);
+
+    const u32 removed = dc::min(count, write - read);
+    for (u32 i = 0; i < removed; ++i) {
+      out[i] = dc::move(m_data[mask(read + i)]);
+    }
+    if (removed > 0) m_read.store(read + removed, std::memory_order_release);
+    return removed;
+  }
+
   /// Number of elements currently in the ring.
   /// May be called from any thread (approximate when called cross-thread).
   u32 size() const {
@@ -122,8 +153,8 @@ class SpscRing {
   alignas(64) std::atomic<u32> m_write{0};
 
   // Consumer-owned cache line.
-  // m_lastRemoved is a private copy of the most recently removed element.
-  // remove() copies into this buffer before advancing m_read so the returned
+  // m_lastRemoved holds the most recently removed element.
+  // remove() moves into this buffer before advancing m_read so the returned
   // pointer stays valid while the caller inspects it, even after the producer
   // refills the original ring slot.
   alignas(64) std::atomic<u32> m_read{0};
@@ -0,0 +1,307 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <coroutine>
+#include <dc/assert.hpp>
+#include <dc/job/job.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/macros.hpp>
+#include <dc/traits.hpp>
+#include <dc/types.hpp>
+#include <exception>
+#include <memory>
+#include <optional>
+
+// GCC reports -Wzero-as-null-pointer-constant on code it generates itself for
+// every coroutine. Files that define coroutines and enable the warning need
+// the same treatment.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+#endif
+
+namespace dc {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+/// Resumes the awaiting coroutine once the task is done. Symmetric transfer,
+/// so that a long chain of tasks completing one after another does not grow
+/// the stack.
+struct TaskFinalAwaiter {
+  bool await_ready() const noexcept { return false; }
+
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<Promise> handle) const noexcept {
+    std::coroutine_handle<> continuation = handle.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {}
+};
+
+struct TaskPromiseBase {
+  /// Tasks are lazy, they start when first awaited.
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  TaskFinalAwaiter final_suspend() const noexcept { return {}; }
+
+  /// Like a Job, a task must not throw.
+  [[noreturn]] void unhandled_exception() const noexcept { std::terminate(); }
+
+  /// The coroutine awaiting this task.
+  std::coroutine_handle<> continuation;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  Task<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& value) {
+    result.emplace(dc::forward<U>(value));
+  }
+
+  std::optional<T> result;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept {}
+};
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Task
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// A coroutine that runs on the JobSystem.
+///
+/// A task does nothing until it is co_awaited, by another task or through
+/// spawn() / syncAwait(). Inside a task, co_await on a JobHandle, another
+/// Task or scheduleOn() suspends the coroutine instead of blocking the
+/// worker, which goes on to run other jobs. The task is resumed on a worker
+/// once what it waited for is done, so a pool with one worker per core can
+/// keep any number of tasks in flight.
+///
+/// A task can be awaited once. Destroying a task that is not running destroys
+/// its coroutine frame.
+///
+/// Usage:
+/// @code
+///   dc::Task<s32> load(dc::JobSystem& js) {
+///     co_await dc::scheduleOn(js);
+///     dc::JobHandle parse = js.add(parseJobs);
+///     co_await parse;  // frees the worker until the batch is done
+///     co_return merge();
+///   }
+///
+///   s32 result = dc::syncAwait(js, load(js));
+/// @endcode
+template <typename T = void>
+class [[nodiscard]] Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task(Task&& other) noexcept : m_handle(other.m_handle) {
+    other.m_handle = nullptr;
+  }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (m_handle) m_handle.destroy();
+      m_handle = other.m_handle;
+      other.m_handle = nullptr;
+    }
+    return *this;
+  }
+
+  ~Task() {
+    if (m_handle) m_handle.destroy();
+  }
+
+  DC_DELETE_COPY(Task);
+
+  struct Awaiter {
+    bool await_ready() const noexcept { return handle.done(); }
+
+    /// Start the task, it resumes us when it is done.
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> awaiting) const noexcept {
+      handle.promise().continuation = awaiting;
+      return handle;
+    }
+
+    T await_resume() const {
+      if constexpr (!isSame<T, void>) {
+        return dc::move(*handle.promise().result);
+      }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+  };
+
+  Awaiter operator co_await() const noexcept {
+    DC_ASSERT(m_handle, "Cannot await an empty Task");
+    return Awaiter{m_handle};
+  }
+
+ private:
+  friend promise_type;
+
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : m_handle(handle) {}
+
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>{
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Awaitables
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Suspends until the batch is done, then resumes on a worker through a
+/// continuation job.
+struct JobHandleAwaiter {
+  bool await_ready() const noexcept { return handle.isDone(); }
+
+  void await_suspend(std::coroutine_handle<> awaiting) const {
+    // The batch may finish, and another worker resume and destroy the frame
+    // we live in, before addContinuation returns. Keep the counter alive on
+    // the stack, and touch nothing in the frame after the call.
+    const std::shared_ptr<JobCounter> counter = handle.m_counter;
+    counter->addContinuation(Job{[awaiting] { awaiting.resume(); }, priority});
+  }
+
+  void await_resume() const noexcept {}
+
+  JobHandle handle;
+  JobPriority priority;
+};
+
+struct ScheduleOnAwaiter {
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> awaiting) const {
+    system.add(Job{[awaiting] { awaiting.resume(); }, priority});
+  }
+
+  void await_resume() const noexcept {}
+
+  JobSystem& system;
+  JobPriority priority;
+};
+
+}  // namespace detail
+
+/// Suspend the coroutine until every job in the batch has completed. It is
+/// resumed on a worker, with JobPriority::Normal.
+inline detail::JobHandleAwaiter operator co_await(const JobHandle& handle) {
+  return detail::JobHandleAwaiter{handle, JobPriority::Normal};
+}
+
+/// Move the coroutine onto a worker of the JobSystem. Awaiting it from a
+/// worker requeues the coroutine, letting other jobs of higher or equal
+/// priority run first.
+[[nodiscard]] inline detail::ScheduleOnAwaiter scheduleOn(
+    JobSystem& js, JobPriority priority = JobPriority::Normal) {
+  return detail::ScheduleOnAwaiter{js, priority};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Starting tasks
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Coroutine that starts right away and frees its own frame when done.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    [[noreturn]] void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+inline DetachedTask runDetached(JobSystem& js, Task<void> task,
+                                std::shared_ptr<JobCounter> done) {
+  co_await scheduleOn(js);
+  co_await task;
+  done->decrement();
+}
+
+}  // namespace detail
+
+/// Start the task on a worker of the JobSystem.
+/// @return A handle that completes when the task does. It can be awaited,
+///         chained onto with then(), or co_awaited from another task.
+[[nodiscard]] inline JobHandle spawn(JobSystem& js, Task<void> task) {
+  auto done = std::make_shared<JobCounter>(1u, &js);
+  detail::runDetached(js, dc::move(task), done);
+  return JobHandle{dc::move(done)};
+}
+
+/// Run the task on the JobSystem and block until it completes, for getting
+/// from regular code into tasks. The calling thread helps run jobs meanwhile,
+/// see JobHandle::await().
+template <typename T>
+T syncAwait(JobSystem& js, Task<T> task) {
+  if constexpr (isSame<T, void>) {
+    spawn(js, dc::move(task)).await();
+  } else {
+    std::optional<T> result;
+    spawn(js, [](Task<T> inner, std::optional<T>& out) -> Task<void> {
+      out.emplace(co_await inner);
+    }(dc::move(task), result)).await();
+    return dc::move(*result);
+  }
+}
+
+}  // namespace dc
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
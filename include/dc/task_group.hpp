@@ -0,0 +1,115 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <dc/assert.hpp>
+#include <dc/job/cancellation_token.hpp>
+#include <dc/job/job.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/macros.hpp>
+#include <dc/types.hpp>
+#include <memory>
+#include <optional>
+
+namespace dc {
+
+/// Structured fork-join: spawn child jobs, then wait for all of them.
+///
+/// The completion counter lives in the group, on the stack of whoever owns
+/// it, and the children point at it without sharing ownership. Spawning a
+/// child therefore allocates nothing. Its closure is stored inline in the
+/// Job, and the job goes into the worker's pooled storage. That suits
+/// recursive divide and conquer, where the tasks are tiny and countless, and
+/// JobSystem::add(List<Job>&) would cost a shared counter per batch.
+///
+/// Children may spawn more children into the same group. wait() helps run
+/// jobs until every child is done, like JobSystem::await(), and the group can
+/// be used again after. The destructor waits too, so children never outlive
+/// the group, and may capture the parent's locals by reference.
+///
+/// Usage:
+/// @code
+///   u64 fib(dc::JobSystem& js, u32 n) {
+///     if (n < 20) return fibSerial(n);
+///     u64 a = 0;
+///     dc::TaskGroup group(js);
+///     group.run([&] { a = fib(js, n - 1); });
+///     const u64 b = fib(js, n - 2);
+///     group.wait();
+///     return a + b;
+///   }
+/// @endcode
+class TaskGroup {
+ public:
+  /// @param token Once cancelled, children that have not started are
+  ///              skipped, see CancellationToken.
+  explicit TaskGroup(JobSystem& js, CancellationToken token = {})
+      : m_js(js), m_token(dc::move(token)) {}
+
+  ~TaskGroup() { wait(); }
+
+  DC_DELETE_COPY(TaskGroup);
+  DC_DELETE_MOVE(TaskGroup);
+
+  /// Spawn fn as a child job. Thread-safe once the group has a child, so
+  /// children may spawn more children.
+  template <typename Fn>
+  void run(Fn&& fn, JobPriority priority = JobPriority::Normal) {
+    if (!m_counter) {
+      // Held by the group until wait(), so that it can not complete while
+      // children are still being spawned.
+      m_counter.emplace(1u, &m_js, m_token);
+    }
+    m_counter->increment();
+
+    Job job{dc::forward<Fn>(fn), priority};
+    // Aliasing an empty shared_ptr: points at the counter, owns nothing,
+    // allocates nothing, and copies without touching a reference count.
+    job.counter = std::shared_ptr<JobCounter>(std::shared_ptr<JobCounter>{},
+                                              &*m_counter);
+    m_js.add(dc::move(job));
+  }
+
+  /// Wait for every child, running jobs meanwhile. The group is empty after
+  /// and can be used again.
+  void wait() {
+    if (!m_counter) return;
+    m_counter->decrement();
+    m_js.await(*m_counter);
+    m_counter.reset();
+  }
+
+  /// True once the token of the group is cancelled.
+  [[nodiscard]] bool isCancelled() const { return m_token.isCancelled(); }
+
+ private:
+  JobSystem& m_js;
+  CancellationToken m_token;
+  std::optional<JobCounter> m_counter;
+};
+
+}  // namespace dc
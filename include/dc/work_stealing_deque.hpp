@@ -0,0 +1,198 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <dc/assert.hpp>
+#include <dc/macros.hpp>
+#include <dc/math.hpp>
+#include <dc/types.hpp>
+
+namespace dc {
+
+/// Chase-Lev work-stealing deque of pointers.
+///
+/// Design from "Correct and Efficient Work-Stealing for Weak Memory Models"
+/// (Lê, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+///
+/// Thread safety contract:
+///   - Only the OWNER thread may call push() and pop(). They operate on the
+///     bottom end, LIFO, which keeps recently spawned work hot in cache.
+///   - ANY thread may call steal(). It takes from the top end, FIFO, so
+///     thieves pick up the oldest (usually largest) pieces of work.
+///   - Any thread may call size() and isEmpty() (approximate cross-thread).
+///
+/// The deque stores pointers only and never owns the pointees. Storing
+/// pointers is what makes the speculative read in steal() safe: a thief that
+/// loses the race on top simply discards the pointer it read.
+///
+/// The buffer grows when full. Old buffers may still be read by in-flight
+/// thieves, so they are retired rather than freed and released on
+/// destruction.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  /// @param capacity Initial capacity. Will be rounded up to the next power
+  ///                 of 2.
+  explicit WorkStealingDeque(u32 capacity = 256) {
+    capacity = roundUpToPowerOf2(capacity);
+    DC_ASSERT(capacity > 0, "WorkStealingDeque capacity must be > 0");
+    m_buffer.store(new Buffer(capacity, nullptr), std::memory_order_relaxed);
+  }
+
+  ~WorkStealingDeque() {
+    Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+    while (buffer) {
+      Buffer* retired = buffer->retired;
+      delete buffer;
+      buffer = retired;
+    }
+  }
+
+  DC_DELETE_COPY(WorkStealingDeque);
+  DC_DELETE_MOVE(WorkStealingDeque);
+
+  /// Push an element onto the bottom. Called only by the owner thread.
+  /// Grows the buffer if needed, so it never fails.
+  void push(T* elem) {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed);
+    const s64 top = m_top.load(std::memory_order_acquire);
+    Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > static_cast<s64>(buffer->capacity) - 1) {
+      buffer = grow(buffer, bottom, top);
+    }
+
+    buffer->put(bottom, elem);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  /// Pop an element from the bottom. Called only by the owner thread.
+  /// @return The most recently pushed element, or nullptr if empty.
+  T* pop() {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    s64 top = m_top.load(std::memory_order_relaxed);
+
+    T* elem = nullptr;
+    if (top <= bottom) {
+      elem = buffer->get(bottom);
+      if (top == bottom) {
+        // Last element, race against thieves for it.
+        if (!m_top.compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+          elem = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+    } else {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return elem;
+  }
+
+  /// Steal an element from the top. May be called from any thread.
+  /// @return The oldest element, or nullptr if the deque was empty or another
+  ///         thread won the race for the element.
+  T* steal() {
+    s64 top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const s64 bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) return nullptr;
+
+    Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+    T* elem = buffer->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return elem;
+  }
+
+  /// Number of elements in the deque.
+  /// May be called from any thread (approximate when called cross-thread).
+  u32 size() const {
+    const s64 bottom = m_bottom.load(std::memory_order_acquire);
+    const s64 top = m_top.load(std::memory_order_acquire);
+    return bottom > top ? static_cast<u32>(bottom - top) : 0u;
+  }
+
+  bool isEmpty() const { return size() == 0; }
+
+  /// Current buffer capacity. Only meaningful from the owner thread.
+  u32 capacity() const {
+    return m_buffer.load(std::memory_order_relaxed)->capacity;
+  }
+
+ private:
+  struct Buffer {
+    Buffer(u32 cap, Buffer* prev)
+        : data(new std::atomic<T*>[cap]), capacity(cap), retired(prev) {}
+
+    ~Buffer() { delete[] data; }
+
+    DC_DELETE_COPY(Buffer);
+    DC_DELETE_MOVE(Buffer);
+
+    T* get(s64 index) const {
+      return data[static_cast<u64>(index) & (capacity - 1)].load(
+          std::memory_order_relaxed);
+    }
+
+    void put(s64 index, T* elem) {
+      data[static_cast<u64>(index) & (capacity - 1)].store(
+          elem, std::memory_order_relaxed);
+    }
+
+    std::atomic<T*>* data;
+    u32 capacity;
+
+    /// The buffer this one replaced. Kept alive for in-flight thieves.
+    Buffer* retired;
+  };
+
+  Buffer* grow(Buffer* old, s64 bottom, s64 top) {
+    DC_ASSERT(old->capacity < 0x80000000u, "Must be less than 31 bits");
+    Buffer* grown = new Buffer(old->capacity * 2, old);
+    for (s64 i = top; i < bottom; ++i) {
+      grown->put(i, old->get(i));
+    }
+    m_buffer.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+  // Top is written by thieves, bottom only by the owner. Keep them on separate
+  // cache lines to avoid false sharing.
+  alignas(64) std::atomic<s64> m_top{0};
+  alignas(64) std::atomic<s64> m_bottom{0};
+  std::atomic<Buffer*> m_buffer{nullptr};
+};
+
+}  // namespace dc
@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dc/job/blocking_pool.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/traits.hpp>
+#include <system_error>
+
+namespace dc {
+
+BlockingPool::BlockingPool(u32 maxThreads, u64 idleTimeoutNs)
+    : m_maxThreads(maxThreads > 0 ? maxThreads : 1),
+      m_idleTimeout(static_cast<s64>(idleTimeoutNs)) {}
+
+BlockingPool::~BlockingPool() { stop(); }
+
+void BlockingPool::add(Job&& job) {
+  {
+    std::unique_lock lock(m_mutex);
+    if (!m_stopping) {
+      // Move the queue to the front rather than grow the list, once that
+      // frees at least half of it.
+      if (m_nextJob > 0 && m_nextJob >= m_jobs.getSize() / 2 &&
+          m_jobs.getSize() == m_jobs.getCapacity()) {
+        const u64 queued = queuedCount();
+        for (u64 i = 0; i < queued; ++i) {
+          m_jobs[i] = dc::move(m_jobs[m_nextJob + i]);
+        }
+        while (m_jobs.getSize() > queued) {
+          m_jobs.removeAt(m_jobs.getSize() - 1);
+        }
+        m_nextJob = 0;
+      }
+      m_jobs.add(dc::move(job));
+
+      // An idle thread may already have been told about an earlier job, so
+      // compare against the whole queue.
+      if (queuedCount() <= m_idle || m_running >= m_maxThreads) {
+        m_ready.notify_one();
+        return;
+      }
+
+      joinExited();
+      try {
+        m_threads.add(std::thread(&BlockingPool::threadLoop, this));
+        ++m_running;
+        return;
+      } catch (const std::system_error&) {
+        // Out of threads. The ones we have get to it, if there are any.
+        if (m_running > 0) return;
+      }
+
+      job = dc::move(m_jobs.getLast());
+      m_jobs.removeAt(m_jobs.getSize() - 1);
+    }
+  }
+
+  job.run();
+}
+
+void BlockingPool::stop() {
+  List<std::thread> threads;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_stopping = true;
+    threads = dc::move(m_threads);
+    m_exited.clear();
+  }
+
+  // The threads run what is queued before they see m_stopping.
+  m_ready.notify_all();
+  for (std::thread& thread : threads) thread.join();
+}
+
+u32 BlockingPool::threadCount() const {
+  std::scoped_lock lock(m_mutex);
+  return m_running;
+}
+
+void BlockingPool::threadLoop() {
+  std::unique_lock lock(m_mutex);
+  while (true) {
+    if (queuedCount() > 0) {
+      Job job = takeJob();
+      lock.unlock();
+
+      job.run();
+      m_jobsRun.fetch_add(1, std::memory_order_relaxed);
+
+      lock.lock();
+      continue;
+    }
+    if (m_stopping) break;
+
+    ++m_idle;
+    const bool woken = m_ready.wait_for(lock, m_idleTimeout, [this] {
+      return queuedCount() > 0 || m_stopping;
+    });
+    --m_idle;
+    if (!woken) break;
+  }
+
+  --m_running;
+  // stop() joins us itself, and has taken the thread handles.
+  if (!m_stopping) m_exited.add(std::this_thread::get_id());
+}
+
+void BlockingPool::joinExited() {
+  for (const std::thread::id id : m_exited) {
+    std::thread* thread = m_threads.begin();
+    while (thread->get_id() != id) ++thread;
+    // It is on its way out and needs no lock, joining it here is quick.
+    thread->join();
+    m_threads.remove(thread);
+  }
+  m_exited.clear();
+}
+
+Job BlockingPool::takeJob() {
+  Job job = dc::move(m_jobs[m_nextJob++]);
+  if (m_nextJob == m_jobs.getSize()) {
+    // Queue is empty, start over at the front.
+    m_jobs.clear();
+    m_nextJob = 0;
+  }
+  return job;
+}
+
+}  // namespace dc
@@ -0,0 +1,251 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <dc/cpu_topology.hpp>
+#include <dc/platform.hpp>
+#include <dc/traits.hpp>
+#include <thread>
+
+#if defined(DC_PLATFORM_WINDOWS)
+#if !defined(VC_EXTRALEAN)
+#define VC_EXTRALEAN
+#endif
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(DC_PLATFORM_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dc {
+
+u32 CpuTopology::logicalCpuCount() const {
+  u32 count = 0;
+  for (const CpuCore& core : cores) {
+    count += static_cast<u32>(core.cpus.getSize());
+  }
+  return count;
+}
+
+bool parseCpuList(const char* text, List<u32>& out) {
+  const char* at = text;
+  while (*at != '\0' && *at != '\n') {
+    char* end = nullptr;
+    const unsigned long first = std::strtoul(at, &end, 10);
+    if (end == at) return false;
+    at = end;
+
+    unsigned long last = first;
+    if (*at == '-') {
+      ++at;
+      last = std::strtoul(at, &end, 10);
+      if (end == at || last < first) return false;
+      at = end;
+    }
+
+    for (unsigned long cpu = first; cpu <= last; ++cpu) {
+      out.add(static_cast<u32>(cpu));
+    }
+
+    if (*at == ',') {
+      ++at;
+    } else if (*at != '\0' && *at != '\n') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Used when the real topology is unknown: every logical CPU is a core of its
+/// own, on one node.
+static CpuTopology flatTopology() {
+  const u32 hwThreads = std::thread::hardware_concurrency();
+  const u32 count = hwThreads > 0 ? hwThreads : 1;
+
+  CpuTopology topology;
+  topology.cores.resize(count);
+  for (u32 i = 0; i < count; ++i) topology.cores[i].cpus.add(i);
+  return topology;
+}
+
+#if defined(DC_PLATFORM_LINUX)
+
+/// Read a small sysfs file into buffer, null terminated.
+static bool readSysfs(const char* path, char* buffer, usize size) {
+  std::FILE* file = std::fopen(path, "r");
+  if (!file) return false;
+  const usize read = std::fread(buffer, 1, size - 1, file);
+  std::fclose(file);
+  buffer[read] = '\0';
+  return read > 0;
+}
+
+static bool readSysfsU32(const char* path, u32& out) {
+  char buffer[32];
+  if (!readSysfs(path, buffer, sizeof(buffer))) return false;
+  char* end = nullptr;
+  const long value = std::strtol(buffer, &end, 10);
+  // Some platforms report -1 for ids they do not know.
+  if (end == buffer || value < 0) return false;
+  out = static_cast<u32>(value);
+  return true;
+}
+
+static bool readSysfsList(const char* path, List<u32>& out) {
+  // Lists are short ranges, but a fragmented one on a big machine can still
+  // run long.
+  char buffer[4096];
+  return readSysfs(path, buffer, sizeof(buffer)) && parseCpuList(buffer, out);
+}
+
+static bool queryLinuxTopology(CpuTopology& topology) {
+  List<u32> online;
+  if (!readSysfsList("/sys/devices/system/cpu/online", online) ||
+      online.isEmpty()) {
+    return false;
+  }
+
+  // Leave out CPUs that a cpuset or taskset keeps us off, pinning a worker to
+  // them would fail.
+  List<u32> cpus;
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const bool hasMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+  for (const u32 cpu : online) {
+    if (!hasMask || cpu >= CPU_SETSIZE || CPU_ISSET(cpu, &allowed)) {
+      cpus.add(cpu);
+    }
+  }
+  if (cpus.isEmpty()) return false;
+
+  // Map each CPU to a dense node number. Machines without NUMA support have
+  // no node directory, everything is then on node 0.
+  u32 maxCpu = 0;
+  for (const u32 cpu : cpus) maxCpu = cpu > maxCpu ? cpu : maxCpu;
+  List<s64> cpuNode;
+  cpuNode.resize(maxCpu + 1);
+  for (s64& node : cpuNode) node = -1;
+
+  List<u32> nodes;
+  readSysfsList("/sys/devices/system/node/online", nodes);
+  u32 nodeCount = 0;
+  for (const u32 node : nodes) {
+    char path[96];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+                  node);
+    List<u32> nodeCpus;
+    if (!readSysfsList(path, nodeCpus)) continue;
+
+    bool used = false;
+    for (const u32 cpu : nodeCpus) {
+      if (cpu <= maxCpu) {
+        cpuNode[cpu] = nodeCount;
+        used = true;
+      }
+    }
+    // Memory-only nodes and nodes whose CPUs we may not use do not count.
+    if (used) ++nodeCount;
+  }
+
+  // Group SMT siblings. core_id is only unique within a package.
+  struct CoreKey {
+    u32 package;
+    u32 coreId;
+  };
+  List<CoreKey> keys;
+
+  for (const u32 cpu : cpus) {
+    char path[96];
+    CoreKey key{0, cpu};
+    std::snprintf(path, sizeof(path),
+                  "/sys/devices/system/cpu/cpu%u/topology/physical_package_id",
+                  cpu);
+    readSysfsU32(path, key.package);
+    std::snprintf(path, sizeof(path),
+                  "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+    readSysfsU32(path, key.coreId);
+
+    usize index = 0;
+    while (index < keys.getSize() && (keys[index].package != key.package ||
+                                      keys[index].coreId != key.coreId)) {
+      ++index;
+    }
+
+    if (index == keys.getSize()) {
+      keys.add(key);
+      CpuCore core;
+      core.package = key.package;
+      core.node = cpuNode[cpu] >= 0 ? static_cast<u32>(cpuNode[cpu]) : 0;
+      topology.cores.add(dc::move(core));
+    }
+    topology.cores[index].cpus.add(cpu);
+  }
+
+  topology.nodeCount = nodeCount > 0 ? nodeCount : 1;
+  return true;
+}
+
+#endif  // DC_PLATFORM_LINUX
+
+CpuTopology queryCpuTopology() {
+#if defined(DC_PLATFORM_LINUX)
+  CpuTopology topology;
+  if (queryLinuxTopology(topology)) return topology;
+#endif
+  return flatTopology();
+}
+
+bool setCurrentThreadAffinity(const u32* cpus, usize count) {
+  if (count == 0) return false;
+
+#if defined(DC_PLATFORM_LINUX)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (usize i = 0; i < count; ++i) {
+    if (cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(DC_PLATFORM_WINDOWS)
+  // Only the first processor group, which is all of them below 64 CPUs.
+  DWORD_PTR mask = 0;
+  for (usize i = 0; i < count; ++i) {
+    if (cpus[i] < 64) mask |= DWORD_PTR{1} << cpus[i];
+  }
+  return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+  // macOS has no way to pin a thread to a CPU.
+  (void)cpus;
+  return false;
+#endif
+}
+
+}  // namespace dc
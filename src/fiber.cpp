@@ -0,0 +1,218 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstdlib>
+#include <dc/assert.hpp>
+#include <dc/job/fiber.hpp>
+
+#if DC_JOB_FIBERS
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define DC_FIBER_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define DC_FIBER_ASAN 1
+#endif
+#endif
+#if !defined(DC_FIBER_ASAN)
+#define DC_FIBER_ASAN 0
+#endif
+
+#if DC_FIBER_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#if DC_JOB_FIBERS
+
+// System V x86-64 context switch. Pushes the callee-saved registers and the
+// SSE and x87 control words onto the current stack, stores the stack pointer
+// in *from, then loads `to` and pops the same from there. Everything else is
+// caller-saved, so the compiler already spilled it around the call.
+//
+// A new fiber starts in dc_fiber_trampoline, which calls r14(r12, r13), see
+// Fiber::create. The undefined return address ends backtraces there.
+asm(R"(
+.text
+.globl dc_fiber_switch
+.hidden dc_fiber_switch
+.type dc_fiber_switch,@function
+.p2align 4
+dc_fiber_switch:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $8, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $8, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+.size dc_fiber_switch,.-dc_fiber_switch
+
+.globl dc_fiber_trampoline
+.hidden dc_fiber_trampoline
+.type dc_fiber_trampoline,@function
+.p2align 4
+dc_fiber_trampoline:
+  .cfi_startproc
+  .cfi_undefined rip
+  movq %r12, %rdi
+  movq %r13, %rsi
+  call *%r14
+  ud2
+  .cfi_endproc
+.size dc_fiber_trampoline,.-dc_fiber_trampoline
+)");
+
+extern "C" void dc_fiber_switch(void** from, void* to);
+extern "C" void dc_fiber_trampoline();
+
+#endif  // DC_JOB_FIBERS
+
+namespace dc {
+
+#if DC_FIBER_ASAN
+
+/// The context the calling thread last switched away from. The context that
+/// resumes records that context's stack bounds, which only ASan can tell.
+///
+/// Not inlined, a fiber may resume on another thread and the compiler must
+/// not reuse the address of the previous thread's variable.
+[[gnu::noinline]] static FiberContext*& switchedFrom() {
+  static thread_local FiberContext* tSwitchedFrom = nullptr;
+  return tSwitchedFrom;
+}
+
+static void finishSwitch(void* fakeStack) {
+  FiberContext* from = switchedFrom();
+  __sanitizer_finish_switch_fiber(fakeStack, &from->stackBottom,
+                                  &from->stackSize);
+}
+
+#endif
+
+#if DC_JOB_FIBERS
+
+/// First function to run on a new fiber.
+static void startFiber(Fiber* fiber, void (*entry)(Fiber*)) {
+#if DC_FIBER_ASAN
+  finishSwitch(nullptr);
+#endif
+  entry(fiber);
+
+  // Entry functions loop forever, there is nothing to return to.
+  DC_ASSERT(false, "Fiber entry function returned");
+  std::abort();
+}
+
+Fiber* Fiber::create(usize stackSize, void (*entry)(Fiber*)) {
+  const usize pageSize = static_cast<usize>(sysconf(_SC_PAGESIZE));
+  const usize usableSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+  const usize mappingSize = usableSize + pageSize;
+
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED) return nullptr;
+
+  // Stacks grow down, so the guard page goes at the low end. Running off the
+  // stack then faults instead of corrupting whatever is mapped below.
+  if (mprotect(mapping, pageSize, PROT_NONE) != 0) {
+    munmap(mapping, mappingSize);
+    return nullptr;
+  }
+
+  Fiber* fiber = new Fiber();
+  fiber->m_mapping = mapping;
+  fiber->m_mappingSize = mappingSize;
+
+  u8* stackTop = static_cast<u8*>(mapping) + mappingSize;
+  fiber->context.stackBottom = stackTop - usableSize;
+  fiber->context.stackSize = usableSize;
+
+  // What dc_fiber_switch pops. Returning "to" the trampoline leaves the stack
+  // pointer 16 byte aligned, as the ABI wants it at a call.
+  constexpr u32 kDefaultMxcsr = 0x1F80;
+  constexpr u16 kDefaultFpuControl = 0x037F;
+  u64* frame = reinterpret_cast<u64*>(stackTop - 80);
+  frame[0] = kDefaultMxcsr | (u64{kDefaultFpuControl} << 32);
+  frame[1] = 0;                                            // r15
+  frame[2] = reinterpret_cast<u64>(&startFiber);           // r14
+  frame[3] = reinterpret_cast<u64>(entry);                 // r13
+  frame[4] = reinterpret_cast<u64>(fiber);                 // r12
+  frame[5] = 0;                                            // rbx
+  frame[6] = 0;                                            // rbp
+  frame[7] = reinterpret_cast<u64>(&dc_fiber_trampoline);  // return address
+  fiber->context.stackPointer = frame;
+
+  return fiber;
+}
+
+void Fiber::destroy(Fiber* fiber) {
+  munmap(fiber->m_mapping, fiber->m_mappingSize);
+  delete fiber;
+}
+
+void switchFiber(FiberContext& from, FiberContext& to) {
+#if DC_FIBER_ASAN
+  void* fakeStack = nullptr;
+  switchedFrom() = &from;
+  __sanitizer_start_switch_fiber(&fakeStack, to.stackBottom, to.stackSize);
+#endif
+
+  dc_fiber_switch(&from.stackPointer, to.stackPointer);
+
+#if DC_FIBER_ASAN
+  finishSwitch(fakeStack);
+#endif
+}
+
+#else
+
+Fiber* Fiber::create(usize, void (*)(Fiber*)) { return nullptr; }
+
+void Fiber::destroy(Fiber* fiber) { delete fiber; }
+
+void switchFiber(FiberContext&, FiberContext&) {
+  DC_ASSERT(false, "Fibers are not supported on this platform");
+}
+
+#endif  // DC_JOB_FIBERS
+
+}  // namespace dc
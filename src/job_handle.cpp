@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <dc/assert.hpp>
+#include <dc/job/job_handle.hpp>
+#include <dc/job_system.hpp>
+#include <dc/traits.hpp>
+
+namespace dc {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// JobCounter
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void JobCounter::addContinuation(Job job) {
+  {
+    std::scoped_lock lock(m_mutex);
+    if (!m_done) {
+      m_continuations.add(dc::move(job));
+      return;
+    }
+  }
+
+  DC_ASSERT(m_system, "JobCounter has no JobSystem to submit continuations to");
+  m_system->addReleased(dc::move(job));
+}
+
+void JobCounter::addDependent(std::shared_ptr<JobCounter> dependent) {
+  {
+    std::scoped_lock lock(m_mutex);
+    if (!m_done) {
+      m_dependents.add(dc::move(dependent));
+      return;
+    }
+  }
+
+  dependent->decrement();
+}
+
+void JobCounter::complete() {
+  // Pairs with the release in decrement(), so that continuations see the side
+  // effects of every job in the batch, not just the last one.
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // Once m_done is set a waiter may return and destroy the counter, so take
+  // everything needed out of it first. The last reference may be our own,
+  // then the counter is destroyed on return.
+  JobSystem* system = m_system;
+  std::shared_ptr<JobCounter> self = dc::move(m_self);
+  List<Job> continuations;
+  List<std::shared_ptr<JobCounter>> dependents;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_done = true;
+    continuations = dc::move(m_continuations);
+    dependents = dc::move(m_dependents);
+    m_cv.notify_all();
+  }
+
+  // Called from a worker this pushes onto its own deque, where the other
+  // workers can steal from.
+  for (Job& job : continuations) {
+    DC_ASSERT(system, "JobCounter has no JobSystem to submit continuations to");
+    system->addReleased(dc::move(job));
+  }
+
+  for (std::shared_ptr<JobCounter>& dependent : dependents) {
+    dependent->decrement();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// JobHandle
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void JobHandle::await() const {
+  if (!m_counter) return;
+
+  if (JobSystem* system = m_counter->system()) {
+    system->await(*m_counter);
+  } else {
+    m_counter->wait();
+  }
+}
+
+JobHandle JobHandle::then(Job job) const {
+  DC_ASSERT(m_counter, "Cannot chain onto an empty JobHandle");
+  DC_ASSERT(!job.counter, "Job already belongs to a batch");
+
+  auto next = std::make_shared<JobCounter>(1u, m_counter->system(),
+                                           m_counter->token());
+  job.counter = next;
+  m_counter->addContinuation(dc::move(job));
+
+  return JobHandle{dc::move(next)};
+}
+
+JobHandle JobHandle::then(dc::List<Job>& jobs) const {
+  DC_ASSERT(m_counter, "Cannot chain onto an empty JobHandle");
+
+  const usize count = jobs.getSize();
+  auto next = std::make_shared<JobCounter>(
+      static_cast<u32>(count), m_counter->system(), m_counter->token());
+
+  for (usize i = 0; i < count; ++i) {
+    DC_ASSERT(!jobs[i].counter, "Job already belongs to a batch");
+    jobs[i].counter = next;
+    m_counter->addContinuation(dc::move(jobs[i]));
+  }
+
+  return JobHandle{dc::move(next)};
+}
+
+JobHandle whenAll(const JobHandle* handles, usize count) {
+  // Borrow the JobSystem from the first real handle, so that then() works on
+  // the result.
+  JobSystem* system = nullptr;
+  u32 pending = 0;
+  for (usize i = 0; i < count; ++i) {
+    if (!handles[i].m_counter) continue;
+    if (!system) system = handles[i].m_counter->system();
+    ++pending;
+  }
+
+  auto joined = std::make_shared<JobCounter>(pending, system);
+  for (usize i = 0; i < count; ++i) {
+    if (handles[i].m_counter) handles[i].m_counter->addDependent(joined);
+  }
+
+  return JobHandle{dc::move(joined)};
+}
+
+}  // namespace dc
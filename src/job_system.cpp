@@ -22,71 +22,1121 @@
  * SOFTWARE.
  */
 
+#include <chrono>
+#include <cstdio>
 #include <dc/assert.hpp>
+#include <dc/cpu_topology.hpp>
 #include <dc/job_system.hpp>
 #include <dc/list.hpp>
+#include <dc/math.hpp>
+#include <dc/platform.hpp>
+#include <dc/time.hpp>
 #include <dc/traits.hpp>
+#include <moodycamel/concurrentqueue.h>
+#include <system_error>
 #include <thread>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+#if defined(DC_PLATFORM_WINDOWS)
+#if !defined(VC_EXTRALEAN)
+#define VC_EXTRALEAN
+#endif
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(DC_PLATFORM_LINUX)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace dc {
 
+/// Unbounded lock-free queue of jobs, for the injection, pinned and owner
+/// queues. Wrapped so that users of the header do not need moodycamel.
+struct JobQueue {
+  moodycamel::ConcurrentQueue<Job> jobs;
+};
+
+/// The worker owned by the calling thread, and the JobSystem it belongs to.
+/// Both are nullptr on threads that are not JobSystem workers.
+static thread_local Worker* tWorker = nullptr;
+static thread_local const JobSystem* tSystem = nullptr;
+
+/// Tell the CPU that we are in a spin-wait loop. Saves power and frees up
+/// resources for the other hyper-thread on the core.
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#elif defined(_M_ARM64)
+  __yield();
+#endif
+}
+
+/// Timeout for parkOn() that never expires.
+static constexpr u64 kNoTimeout = ~u64{0};
+
+/// Sleep until the word no longer holds expected, unpark() is called on it or
+/// the timeout passes. May also return for no reason.
+///
+/// Like std::atomic::wait(), which has no timeout. The two can not be mixed,
+/// the standard library may skip the wake-up for waiters it does not know of.
+static void parkOn(std::atomic<u32>& word, u32 expected, u64 timeoutNs) {
+#if defined(DC_PLATFORM_LINUX)
+  static_assert(sizeof(std::atomic<u32>) == sizeof(u32));
+  timespec timeout{};
+  timeout.tv_sec = static_cast<time_t>(timeoutNs / 1'000'000'000);
+  timeout.tv_nsec = static_cast<long>(timeoutNs % 1'000'000'000);
+  syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAIT_PRIVATE,
+          expected, timeoutNs == kNoTimeout ? nullptr : &timeout, nullptr, 0);
+#elif defined(DC_PLATFORM_WINDOWS)
+  const DWORD timeoutMs =
+      timeoutNs == kNoTimeout
+          ? INFINITE
+          : static_cast<DWORD>(dc::min<u64>((timeoutNs + 999'999) / 1'000'000,
+                                            INFINITE - 1));
+  WaitOnAddress(&word, &expected, sizeof(expected), timeoutMs);
+#else
+  if (timeoutNs == kNoTimeout) {
+    word.wait(expected, std::memory_order_acquire);
+    return;
+  }
+
+  // No timed wait to build on. Only the worker that waits for the next timer
+  // gets here, so poll.
+  const u64 endNs = getTimeNs() + timeoutNs;
+  while (word.load(std::memory_order_acquire) == expected &&
+         getTimeNs() < endNs) {
+    sleepMs(1);
+  }
+#endif
+}
+
+/// Wake a thread sleeping in parkOn() on the word.
+static void unpark(std::atomic<u32>& word) {
+#if defined(DC_PLATFORM_LINUX)
+  syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAKE_PRIVATE, 1,
+          nullptr, nullptr, 0);
+#elif defined(DC_PLATFORM_WINDOWS)
+  WakeByAddressSingle(&word);
+#else
+  word.notify_one();
+#endif
+}
+
+/// Add to a counter that only the calling thread writes. Cheaper than
+/// fetch_add, which would be a locked instruction for nothing.
+template <typename T>
+static inline void bump(std::atomic<T>& counter, T amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+/// Give back the scratch arena a finished job allocated from.
+static void releaseScratch(ScratchHolds& holds) {
+  if (!holds.worker) return;
+  holds.worker->scratchHolders.fetch_sub(1, std::memory_order_release);
+  holds.worker = nullptr;
+}
+
+/// True if a job on the worker's fiber has allocated from the worker's
+/// scratch arena. Only the worker may use its arena, so the fiber must not be
+/// resumed on another one.
+static bool fiberHoldsScratch(const Worker& worker) {
+  return worker.fiber->scratchHolds.worker || worker.scratchHolds->worker;
+}
+
+/// Count the jobs the worker finished, and has not counted yet, down on their
+/// batch, see Worker::doneCounter.
+static void flushDone(Worker& worker) {
+  if (!worker.doneCounter) return;
+  // The counter may be gone once it reaches zero.
+  JobCounter* counter = std::exchange(worker.doneCounter, nullptr);
+  counter->decrement(std::exchange(worker.doneCount, 0u));
+}
+
+/// Job::run() on a worker, that counts the job down on its batch along with
+/// the next ones of the same batch, see Worker::doneCounter.
+/// @param worker Where the worker the job finishes on is found. A job on a
+///               fiber may finish on another worker than it started on.
+static void runCounted(Job& job, Worker* const& worker) {
+  JobCounter* counter = job.counter.get();
+  // The batch of the finished jobs must not wait for this one.
+  if (worker->doneCounter != counter) flushDone(*worker);
+
+  if (!job.isCancelled()) job.fn();
+  if (!counter) return;
+
+  // Any other counter may go with the job that owns it, count it down now.
+  if (!counter->isBatch()) {
+    counter->decrement();
+    return;
+  }
+
+  // fn may have run other jobs meanwhile.
+  if (worker->doneCounter != counter) {
+    flushDone(*worker);
+    worker->doneCounter = counter;
+  }
+  // Finishing the batch is never put off, its continuations may be next. A
+  // stale remaining() only flushes sooner or later, the count stays right.
+  if (++worker->doneCount == Worker::kDoneChunk ||
+      worker->doneCount == counter->remaining()) {
+    flushDone(*worker);
+  }
+}
+
+IAllocator& currentWorkerArena() {
+  Worker* worker = tWorker;
+  if (!worker || !worker->scratchHolds) return getDefaultAllocator();
+
+  // Only this thread adds holds on its arena, and only it resets the arena.
+  ScratchHolds& holds = *worker->scratchHolds;
+  if (!holds.worker) {
+    holds.worker = worker;
+    worker->scratchHolders.fetch_add(1, std::memory_order_relaxed);
+  }
+  return worker->scratch;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Worker thread loop
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void workerLoop(Worker& worker) {
+void JobSystem::workerLoop(Worker& worker) {
+  tWorker = &worker;
+  tSystem = this;
+  // Everything a worker runs is a job, whatever JobSystem it adds jobs to.
+  // Held for the whole loop rather than per job, a job on a fiber may finish
+  // on another thread than it started on.
+  ++detail::tJobDepth;
+
+  if (!worker.cpus.isEmpty()) {
+    // Best effort, an unpinned worker still works.
+    setCurrentThreadAffinity(worker.cpus.begin(), worker.cpus.getSize());
+  }
+
+  const bool elastic = m_elastic.minThreads > 0;
   while (true) {
-    // Wait until there is work or a shutdown signal. The predicate is
-    // evaluated while holding worker.mutex, which is the same mutex the
-    // producer holds when it calls notify_one(). This eliminates the
-    // lost-wakeup race: a notify cannot be missed between the predicate
-    // check and the actual sleep.
-    {
-      std::unique_lock lock(worker.mutex);
-      worker.cv.wait(lock, [&worker] {
-        return !worker.ring.isEmpty() || worker.shutdown;
-      });
+    // Run everything we can find, own work first, then stolen work.
+    const u64 busyStartNs = getTimeNs();
+    bool ran = false;
+    while (runNext(worker)) {
+      ran = true;
+      if (elastic) checkLoad(worker);
+    }
+    const u64 busyEndNs = getTimeNs();
+    bump(worker.busyNs, busyEndNs - busyStartNs);
+    if (ran) worker.idleSinceNs = busyEndNs;
+
+    // If shutdown was requested and there is nothing left to run anywhere,
+    // exit now. Otherwise keep helping until the queues are empty.
+    if (worker.shutdown.load(std::memory_order_acquire) && !hasWork(worker)) {
+      break;
+    }
+
+    if (waitForWork(worker) && tryRetire(worker)) break;
+  }
+  flushDone(worker);
+
+  --detail::tJobDepth;
+  tWorker = nullptr;
+  tSystem = nullptr;
+  worker.exited.store(true, std::memory_order_release);
+}
+
+bool JobSystem::runNext(Worker& worker) {
+  fireTimers(worker);
+
+  // Acquire, the job that released the last hold is done with the memory.
+  if (!worker.scratch.isEmpty() &&
+      worker.scratchHolders.load(std::memory_order_acquire) == 0) {
+    worker.scratch.reset();
+  }
+
+  // A resumed fiber is in the middle of a job, finish those first.
+  if (Fiber* fiber = popReadyFiber()) {
+    flushDone(worker);
+    runFiber(worker, fiber);
+    return true;
+  }
+
+  if (PooledJob* job = findJob(worker)) {
+    runJob(worker, job);
+    return true;
+  }
+
+  // Nothing else to do, the finished jobs are due.
+  flushDone(worker);
+  return false;
+}
+
+void JobSystem::runJob(Worker& worker, PooledJob* job) {
+  const u64 beginNs = worker.traceCapacity > 0 ? getTimeNs() : 0;
+  if (job->job.admitted) leaveBacklog();
+
+  // A job that runs inline on a fiber has nowhere to switch back to. It
+  // shares the fiber, and waits the old way. A cancelled job only counts
+  // itself as done, it needs no fiber for that. A pinned job must not move to
+  // another worker, which a fiber may do.
+  if (!worker.fiber && !job->job.pinned && !job->job.isCancelled()) {
+    if (Fiber* fiber = acquireFiber(worker)) {
+      fiber->job = job;
+      fiber->beginNs = beginNs;
+      runFiber(worker, fiber);
+      return;
+    }
+  }
+
+  ScratchHolds holds;
+  ScratchHolds* outer = std::exchange(worker.scratchHolds, &holds);
+  const bool pinned = job->job.pinned;
+  if (pinned) ++worker.pinnedDepth;
+  Worker* const self = &worker;
+  runCounted(job->job, self);
+  if (pinned) --worker.pinnedDepth;
+  worker.scratchHolds = outer;
+  releaseScratch(holds);
+
+  finishJob(worker, job, beginNs);
+}
+
+void JobSystem::finishJob(Worker& worker, PooledJob* job, u64 beginNs) {
+  if (worker.traceCapacity > 0) {
+    TraceEvent event;
+    event.priority = job->job.priority;
+    event.beginNs = beginNs;
+    event.endNs = getTimeNs();
+
+    const u32 index = worker.traceCount.load(std::memory_order_relaxed);
+    if (index < worker.traceCapacity) {
+      worker.traceEvents[index] = event;
+      // Publishes the event to chromeTrace().
+      worker.traceCount.store(index + 1, std::memory_order_release);
+    } else {
+      bump<u64>(worker.traceDropped, 1);
+    }
+  }
+
+  JobPool::release(job, &worker.pool);
+  bump<u64>(worker.jobsRun, 1);
+}
+
+bool JobSystem::waitForWork(Worker& worker) {
+  auto shouldWake = [this, &worker] {
+    return hasWork(worker) || timerDue() ||
+           worker.shutdown.load(std::memory_order_acquire);
+  };
+
+  for (u32 i = 0; i < m_idle.spinCount; ++i) {
+    if (shouldWake()) return false;
+    cpuRelax();
+  }
+
+  for (u32 i = 0; i < m_idle.yieldCount; ++i) {
+    if (shouldWake()) return false;
+    std::this_thread::yield();
+  }
+
+  // Read the wake signal before announcing that we park. Any wake from here
+  // on bumps it, so the park below returns straight away instead of missing
+  // it. Acquire keeps the store to sleeping from moving above the read.
+  const u32 signal = worker.wakeSignal.load(std::memory_order_acquire);
+
+  // Announce that we are about to park before re-checking for work.
+  // Producers push first and check `sleeping` after, with a fence on both
+  // sides, so at least one of us sees the other.
+  worker.sleeping.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // One parked worker keeps watch over the timers, and parks only until the
+  // next one is due. The rest park until woken. Whoever adds an earlier timer
+  // stores it first and looks for the watcher after, with a fence on both
+  // sides, so either it wakes us or we see the new deadline.
+  bool watching = false;
+  u64 timeoutNs = kNoTimeout;
+  if (m_nextTimerNs.load(std::memory_order_relaxed) != TimerWheel::kNever) {
+    s32 noWatcher = -1;
+    watching = m_timerWatcher.compare_exchange_strong(
+        noWatcher, static_cast<s32>(worker.index), std::memory_order_relaxed);
+  }
+  if (watching) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const u64 nextNs = m_nextTimerNs.load(std::memory_order_relaxed);
+    const u64 nowNs = getTimeNs();
+    if (nextNs != TimerWheel::kNever) {
+      timeoutNs = nextNs > nowNs ? nextNs - nowNs : 0;
+    }
+  }
+
+  // The last worker started in an elastic pool parks no longer than it may
+  // stay idle, and then retires.
+  const u32 active = m_activeCount.load(std::memory_order_relaxed);
+  const bool mayRetire = m_elastic.minThreads > 0 &&
+                         worker.index + 1 == active &&
+                         active > m_elastic.minThreads;
+  u64 retireAtNs = 0;
+  if (mayRetire) {
+    retireAtNs = worker.idleSinceNs + m_shrinkAfterNs;
+    const u64 nowNs = getTimeNs();
+    timeoutNs = dc::min(timeoutNs, retireAtNs > nowNs ? retireAtNs - nowNs : 0);
+  }
+
+  if (timeoutNs > 0 && !shouldWake()) {
+    const u64 parkStartNs = getTimeNs();
+    parkOn(worker.wakeSignal, signal, timeoutNs);
+    bump(worker.parkedNs, getTimeNs() - parkStartNs);
+    bump<u64>(worker.wakeUps, 1);
+  }
+
+  worker.sleeping.store(false, std::memory_order_relaxed);
+
+  if (watching) {
+    // Off to fire the timers or run jobs. Hand the watch over to a parked
+    // worker, we might be busy when the next timer is due.
+    m_timerWatcher.store(-1, std::memory_order_relaxed);
+    if (m_nextTimerNs.load(std::memory_order_relaxed) != TimerWheel::kNever) {
+      wakeOne(worker.index);
+    }
+  }
+
+  return mayRetire && getTimeNs() >= retireAtNs && !shouldWake();
+}
+
+void JobSystem::wake(Worker& worker) {
+  worker.wakeSignal.fetch_add(1, std::memory_order_release);
+  unpark(worker.wakeSignal);
+}
+
+PooledJob* JobSystem::findJob(Worker& worker) {
+  constexpr u32 kBackground = static_cast<u32>(JobPriority::Background);
+
+  // No one else may run our pinned jobs, while the rest can be stolen.
+  if (PooledJob* job = takePinned(worker)) return job;
+
+  // Every so often look in the injection queue first, so that jobs that
+  // spilled there do not wait behind a steady stream of newer ones.
+  constexpr u32 kInjectedQuota = 32;
+  if (++worker.sinceInjected >= kInjectedQuota) {
+    worker.sinceInjected = 0;
+    if (PooledJob* job = takeInjected(worker, kJobPriorityCount - 1)) {
+      return job;
+    }
+  }
+
+  // Every so often look in the background lane first, so that a steady
+  // stream of higher priority work can not starve it completely.
+  if (m_backgroundQuota > 0 && worker.sinceBackground >= m_backgroundQuota) {
+    worker.sinceBackground = 0;
+    if (PooledJob* job = findJob(worker, kBackground)) return job;
+  }
+
+  for (u32 lane = 0; lane < kJobPriorityCount; ++lane) {
+    if (PooledJob* job = findJob(worker, lane)) {
+      worker.sinceBackground =
+          lane == kBackground ? 0 : worker.sinceBackground + 1;
+      return job;
+    }
+  }
+
+  return nullptr;
+}
+
+PooledJob* JobSystem::findJob(Worker& worker, u32 lane) {
+  WorkerLane& own = worker.lanes[lane];
+  if (PooledJob* job = own.deque.pop()) return job;
+
+  // Keep the oldest inbox job for ourselves and move the rest onto the deque,
+  // where they become visible to thieves. Taking ours before publishing the
+  // rest means thieves can never leave us empty handed.
+  if (!own.ring->isEmpty()) {
+    // Drained in bulk, one CAS on the inbox per batch rather than per job.
+    constexpr u32 kDrainBatch = 32;
+    Job inboxJobs[kDrainBatch];
+    u32 removed = own.ring->removeBulk(inboxJobs, kDrainBatch);
+    if (removed == 0) return takeInjectedOrSteal(worker, lane);
+
+    PooledJob* first = worker.pool.acquire(dc::move(inboxJobs[0]));
+    u32 found = removed;
+    u32 next = 1;
+    // No more than the inbox holds. Producers may refill it as fast as we
+    // drain it, and we have first to run.
+    const u32 limit = own.ring->capacity();
+    while (true) {
+      for (u32 i = next; i < removed; ++i) {
+        own.deque.push(worker.pool.acquire(dc::move(inboxJobs[i])));
+      }
+      next = 0;
+      if (found >= limit) break;
+      removed = own.ring->removeBulk(inboxJobs,
+                                     dc::min(kDrainBatch, limit - found));
+      if (removed == 0) break;
+      found += removed;
+    }
+
+    if (found > worker.inboxHighWater.load(std::memory_order_relaxed)) {
+      worker.inboxHighWater.store(found, std::memory_order_relaxed);
+    }
 
-      // Check exit condition while still holding the mutex and before
-      // releasing it to drain. If shutdown was requested and the ring is
-      // already empty, exit now.
-      if (worker.shutdown && worker.ring.isEmpty()) break;
+    // More than we can start right now, get a sleeping worker to help.
+    if (found > 1) wakeOne(worker.index);
+    return first;
+  }
+
+  return takeInjectedOrSteal(worker, lane);
+}
+
+PooledJob* JobSystem::takeInjectedOrSteal(Worker& worker, u32 lane) {
+  // Jobs that spilled over an inbox come before the other workers' jobs of
+  // the same lane, they have waited longer.
+  if (PooledJob* job = takeInjected(worker, lane)) return job;
+  return steal(worker, lane);
+}
+
+PooledJob* JobSystem::takeInjected(Worker& worker, u32 maxLane) {
+  if (m_injectSize.load(std::memory_order_relaxed) == 0) return nullptr;
+
+  // Every inbox was full at some point. Take a batch onto our deques, where
+  // the others can steal from it, and leave the rest to the other workers
+  // polling the queue.
+  constexpr usize kTakeBatch = 64;
+  Job jobs[kTakeBatch];
+  const usize taken = m_injectQueue->jobs.try_dequeue_bulk(jobs, kTakeBatch);
+  if (taken == 0) return nullptr;
+  m_injectSize.fetch_sub(static_cast<u32>(taken), std::memory_order_relaxed);
+
+  for (usize i = 0; i < taken; ++i) {
+    WorkerLane& lane = worker.lanes[static_cast<u32>(jobs[i].priority)];
+    lane.deque.push(worker.pool.acquire(dc::move(jobs[i])));
+  }
+
+  if (taken > 1) wakeOne(worker.index);
+  for (u32 lane = 0; lane <= maxLane; ++lane) {
+    if (PooledJob* job = worker.lanes[lane].deque.pop()) return job;
+  }
+  return nullptr;
+}
+
+PooledJob* JobSystem::takePinned(Worker& worker) {
+  if (worker.pinnedSize.load(std::memory_order_relaxed) == 0) return nullptr;
+
+  Job job;
+  if (!m_pinnedQueues[worker.index]->jobs.try_dequeue(job)) return nullptr;
+  worker.pinnedSize.fetch_sub(1, std::memory_order_relaxed);
+  return worker.pool.acquire(dc::move(job));
+}
+
+PooledJob* JobSystem::steal(Worker& thief, u32 lane) {
+  for (const u32 victimIndex : thief.victims) {
+    Worker& victim = *m_workers[victimIndex];
+    WorkStealingDeque<PooledJob>& deque = victim.lanes[lane].deque;
+
+    if (PooledJob* job = deque.steal()) {
+      thief.stealCount.fetch_add(1, std::memory_order_relaxed);
+
+      // There is more where that came from. Wake another worker so that a
+      // long tail on one worker fans out over all of them.
+      if (!deque.isEmpty()) wakeOne(thief.index);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+PooledJob* JobSystem::stealExternal() {
+  for (u32 lane = 0; lane < kJobPriorityCount; ++lane) {
+    for (const auto& worker : m_workers) {
+      if (PooledJob* job = worker->lanes[lane].deque.steal()) return job;
     }
+  }
+  return nullptr;
+}
 
-    // Drain all available jobs. We do NOT hold the mutex during job
-    // execution — the ring is SPSC so no lock is needed for ring access.
-    while (Job* job = worker.ring.remove()) {
-      job->run();
+bool JobSystem::hasWork(const Worker& worker) const {
+  for (const WorkerLane& lane : worker.lanes) {
+    if (!lane.ring->isEmpty()) return true;
+  }
+  if (worker.pinnedSize.load(std::memory_order_relaxed) > 0) return true;
+  if (m_injectSize.load(std::memory_order_relaxed) > 0) return true;
+  if (m_readyFiberCount.load(std::memory_order_relaxed) > 0) return true;
+
+  for (const auto& other : m_workers) {
+    for (const WorkerLane& lane : other->lanes) {
+      if (!lane.deque.isEmpty()) return true;
     }
   }
+  return false;
+}
+
+void JobSystem::pushLocal(Worker& worker, Job&& job) {
+  WorkerLane& lane = worker.lanes[static_cast<u32>(job.priority)];
+  lane.deque.push(worker.pool.acquire(dc::move(job)));
+  wakeOne(worker.index);
+}
+
+void JobSystem::wakeOne(u32 fromIndex) {
+  // Pairs with the fence in waitForWork, see the comment there.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // Prefer a worker on the same node, it is the one that will steal the job.
+  Worker& from = *m_workers[fromIndex];
+  for (const u32 index : from.victims) {
+    Worker& other = *m_workers[index];
+
+    if (other.sleeping.load(std::memory_order_relaxed)) {
+      wake(other);
+      return;
+    }
+  }
+
+  if (from.sleeping.load(std::memory_order_relaxed)) wake(from);
+}
+
+Worker* JobSystem::currentWorker() const {
+  return tSystem == this ? tWorker : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Elastic pool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void JobSystem::checkLoad(Worker& worker) {
+  if (m_activeCount.load(std::memory_order_relaxed) >= workerCount()) return;
+
+  u32 queued = m_injectSize.load(std::memory_order_relaxed);
+  for (const WorkerLane& lane : worker.lanes) {
+    queued += lane.deque.size() + lane.ring->size();
+  }
+
+  if (queued < m_elastic.growQueueDepth) {
+    // Between half and full depth the overload has to last, below it is
+    // over. Keeps a queue hovering around the depth from growing the pool.
+    if (queued < m_elastic.growQueueDepth / 2) worker.overloadedSinceNs = 0;
+    return;
+  }
+
+  const u64 nowNs = getTimeNs();
+  if (worker.overloadedSinceNs == 0) worker.overloadedSinceNs = nowNs;
+  if (nowNs - worker.overloadedSinceNs >= m_growAfterNs) {
+    worker.overloadedSinceNs = 0;
+    grow();
+  }
+}
+
+bool JobSystem::grow() {
+  std::scoped_lock lock(m_elasticMutex);
+  if (m_stopping) return false;
+
+  const u32 active = m_activeCount.load(std::memory_order_relaxed);
+  if (active >= workerCount()) return true;
+
+  Worker& worker = *m_workers[active];
+  if (worker.thread.joinable()) {
+    // Still on its way out from the last time it retired. Try again on the
+    // next overload.
+    if (!worker.exited.load(std::memory_order_acquire)) return true;
+    worker.thread.join();
+  }
+
+  for (WorkerLane& lane : worker.lanes) {
+    lane.ring = std::make_unique<MpmcRing<Job>>(WorkerLane::kRingCapacity);
+  }
+  worker.exited.store(false, std::memory_order_relaxed);
+  worker.idleSinceNs = getTimeNs();
+  worker.overloadedSinceNs = 0;
+  worker.sinceBackground = 0;
+  worker.sinceInjected = 0;
+
+  try {
+    worker.thread = std::thread(&JobSystem::workerLoop, this, std::ref(worker));
+  } catch (const std::system_error&) {
+    // Out of threads. Carry on with the ones we have.
+    for (WorkerLane& lane : worker.lanes) lane.ring.reset();
+    return true;
+  }
+
+  // Pairs with the load in enterInbox(). The rings are in place before any
+  // submitter gets to them.
+  worker.accepting.store(true, std::memory_order_seq_cst);
+  m_activeCount.store(active + 1, std::memory_order_release);
+
+  // The new worker is the last one now, and may retire once idle. If it
+  // parked before it saw the count, it did so with no timeout.
+  notify(worker);
+  return true;
+}
+
+bool JobSystem::tryRetire(Worker& worker) {
+  {
+    std::scoped_lock lock(m_elasticMutex);
+    const u32 active = m_activeCount.load(std::memory_order_relaxed);
+    if (m_stopping || worker.index + 1 != active ||
+        active <= m_elastic.minThreads) {
+      return false;
+    }
+
+    // Close the inbox, then wait out the submitters that got in before. Each
+    // adds a job or a run of them and leaves, without blocking.
+    m_activeCount.store(active - 1, std::memory_order_release);
+    worker.accepting.store(false, std::memory_order_seq_cst);
+    while (worker.pushers.load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // No one else adds to our queues now. Run what made it in.
+  auto hasOwnWork = [&worker] {
+    for (const WorkerLane& lane : worker.lanes) {
+      if (!lane.ring->isEmpty() || !lane.deque.isEmpty()) return true;
+    }
+    return worker.pinnedSize.load(std::memory_order_acquire) > 0;
+  };
+  while (hasOwnWork()) runNext(worker);
+
+  for (WorkerLane& lane : worker.lanes) lane.ring.reset();
+
+  // Hand our spare fibers to the workers that keep running.
+  if (!worker.freeFibers.isEmpty()) {
+    std::scoped_lock lock(m_fiberMutex);
+    m_freeFibers.addRange(worker.freeFibers.begin(), worker.freeFibers.end());
+    worker.freeFibers.clear();
+  }
+
+  // The worker before us is the last one now. It parks with no timeout while
+  // it is not, so wake it to start the wait to retire in turn.
+  if (worker.index > m_elastic.minThreads) {
+    notify(*m_workers[worker.index - 1]);
+  }
+  return true;
+}
+
+bool JobSystem::enterInbox(Worker& worker) {
+  if (m_elastic.minThreads == 0) return true;
+
+  // Pairs with tryRetire(). Either the worker sees us and waits until we
+  // leave, or we see that it closed the inbox.
+  worker.pushers.fetch_add(1, std::memory_order_seq_cst);
+  if (worker.accepting.load(std::memory_order_seq_cst)) return true;
+
+  worker.pushers.fetch_sub(1, std::memory_order_relaxed);
+  return false;
+}
+
+void JobSystem::leaveInbox(Worker& worker) {
+  if (m_elastic.minThreads == 0) return;
+  worker.pushers.fetch_sub(1, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fibers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void JobSystem::runFiber(Worker& worker, Fiber* fiber) {
+  fiber->worker = &worker;
+  worker.fiber = fiber;
+  ScratchHolds* outer =
+      std::exchange(worker.scratchHolds, &fiber->scratchHolds);
+  switchFiber(worker.schedulerContext, fiber->context);
+  worker.scratchHolds = outer;
+  worker.fiber = nullptr;
+
+  if (JobCounter* counter = fiber->waitingOn) {
+    // Now that we are off its stack the fiber may be resumed, by anyone. If
+    // the counter is already done this queues it right away.
+    fiber->waitingOn = nullptr;
+    counter->addContinuation(Job{[this, fiber] { pushReadyFiber(fiber); },
+                                 JobPriority::High});
+    return;
+  }
+
+  // The fiber may have started on another worker. The job is ours to finish
+  // all the same.
+  releaseScratch(fiber->scratchHolds);
+  finishJob(worker, fiber->job, fiber->beginNs);
+  fiber->job = nullptr;
+  releaseFiber(worker, fiber);
+}
+
+void JobSystem::fiberMain(Fiber* fiber) {
+  while (true) {
+    runCounted(fiber->job->job, fiber->worker);
+    // Back to whichever worker runs us now, it finishes the job. We continue
+    // from here with the next job once it hands us one.
+    switchFiber(fiber->context, fiber->worker->schedulerContext);
+  }
+}
+
+Fiber* JobSystem::acquireFiber(Worker& worker) {
+  if (!m_fiberConfig.enabled) return nullptr;
+
+  if (!worker.freeFibers.isEmpty()) {
+    Fiber* fiber = worker.freeFibers.getLast();
+    worker.freeFibers.removeAt(worker.freeFibers.getSize() - 1);
+    return fiber;
+  }
+
+  {
+    std::scoped_lock lock(m_fiberMutex);
+    if (!m_freeFibers.isEmpty()) {
+      Fiber* fiber = m_freeFibers.getLast();
+      m_freeFibers.removeAt(m_freeFibers.getSize() - 1);
+      return fiber;
+    }
+  }
+
+  if (m_fiberCount.fetch_add(1, std::memory_order_relaxed) >=
+      m_fiberConfig.maxFibers) {
+    m_fiberCount.fetch_sub(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Fiber* fiber = Fiber::create(m_fiberConfig.stackSize, &JobSystem::fiberMain);
+  if (!fiber) {
+    // Out of memory or mappings. Carry on without.
+    m_fiberCount.fetch_sub(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  std::scoped_lock lock(m_fiberMutex);
+  // Make room for every fiber to be ready at once, so that pushReadyFiber()
+  // never allocates.
+  if (!m_readyFibers.reserve(static_cast<u32>(m_fibers.getSize()) + 1)) {
+    Fiber::destroy(fiber);
+    m_fiberCount.fetch_sub(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  m_fibers.add(fiber);
+  return fiber;
+}
+
+void JobSystem::releaseFiber(Worker& worker, Fiber* fiber) {
+  // Enough to cover a few waiting jobs without going to the shared list,
+  // while leaving the rest to the other workers.
+  constexpr usize kMaxLocalFibers = 8;
+
+  worker.freeFibers.add(fiber);
+  if (worker.freeFibers.getSize() <= kMaxLocalFibers) return;
+
+  std::scoped_lock lock(m_fiberMutex);
+  while (worker.freeFibers.getSize() > kMaxLocalFibers / 2) {
+    m_freeFibers.add(worker.freeFibers.getLast());
+    worker.freeFibers.removeAt(worker.freeFibers.getSize() - 1);
+  }
+}
+
+void JobSystem::pushReadyFiber(Fiber* fiber) {
+  {
+    std::scoped_lock lock(m_fiberMutex);
+    [[maybe_unused]] const bool added = m_readyFibers.add(dc::move(fiber));
+    DC_ASSERT(added, "acquireFiber() reserves room for every fiber.");
+    m_readyFiberCount.store(m_readyFibers.size(), std::memory_order_relaxed);
+  }
+
+  Worker* worker = currentWorker();
+  wakeOne(worker ? worker->index : 0);
+}
+
+Fiber* JobSystem::popReadyFiber() {
+  if (m_readyFiberCount.load(std::memory_order_relaxed) == 0) return nullptr;
+
+  std::scoped_lock lock(m_fiberMutex);
+  Fiber** fiber = m_readyFibers.remove();
+  if (!fiber) return nullptr;
+  m_readyFiberCount.store(m_readyFibers.size(), std::memory_order_relaxed);
+  return *fiber;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TimerId JobSystem::addTimer(u64 deadlineNs, Job&& job, u64 periodTicks) {
+  DC_ASSERT(!job.counter, "Job already belongs to a batch");
+
+  TimerId id;
+  bool earlier = false;
+  {
+    std::scoped_lock lock(m_timerMutex);
+    id = m_timers.add(toDeadlineTick(deadlineNs), dc::move(job), periodTicks);
+    earlier = publishNextTimer();
+  }
+
+  if (earlier) notifyTimerWatcher();
+  return id;
+}
+
+void JobSystem::fireTimers(Worker& worker) {
+  if (!timerDue()) return;
+
+  {
+    // Whoever holds the lock is firing the timers already, or adding one. In
+    // the latter case we get them on the next round.
+    std::unique_lock lock(m_timerMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    m_timers.advance(toTick(getTimeNs()), worker.dueTimers,
+                     worker.duePeriodicTimers);
+    publishNextTimer();
+  }
+
+  // Onto our deque, where the other workers can steal them.
+  for (Job& job : worker.dueTimers) pushLocal(worker, dc::move(job));
+  for (const DuePeriodicTimer& due : worker.duePeriodicTimers) {
+    pushLocal(worker,
+              Job{[this, id = due.id] { runPeriodic(id); }, due.priority});
+  }
+  worker.dueTimers.clear();
+  worker.duePeriodicTimers.clear();
+}
+
+void JobSystem::runPeriodic(TimerId id) {
+  Job job;
+  {
+    std::scoped_lock lock(m_timerMutex);
+    if (!m_timers.takePeriodic(id, job)) return;
+  }
+
+  // Run without the lock, the job may add or cancel timers itself.
+  job.fn();
+
+  bool earlier = false;
+  {
+    std::scoped_lock lock(m_timerMutex);
+    m_timers.rearm(id, dc::move(job), toTick(getTimeNs()));
+    earlier = publishNextTimer();
+  }
+
+  if (earlier) notifyTimerWatcher();
+}
+
+bool JobSystem::publishNextTimer() {
+  const u64 tick = m_timers.nextTick();
+  const u64 nextNs = tick == TimerWheel::kNever ? tick : toTimeNs(tick);
+  return nextNs < m_nextTimerNs.exchange(nextNs, std::memory_order_relaxed);
+}
+
+void JobSystem::notifyTimerWatcher() {
+  // Pairs with the fence in waitForWork, see the comment there.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const s32 watcher = m_timerWatcher.load(std::memory_order_relaxed);
+  if (watcher >= 0) {
+    wake(*m_workers[static_cast<u32>(watcher)]);
+    return;
+  }
+
+  // Nobody is watching. Either every worker is busy, and they fire timers
+  // between jobs, or one of them parked before there was anything to watch.
+  for (auto& worker : m_workers) {
+    if (worker->sleeping.load(std::memory_order_relaxed)) {
+      wake(*worker);
+      return;
+    }
+  }
+}
+
+bool JobSystem::timerDue() const {
+  const u64 nextNs = m_nextTimerNs.load(std::memory_order_relaxed);
+  return nextNs != TimerWheel::kNever && getTimeNs() >= nextNs;
+}
+
+u64 JobSystem::toTick(u64 timeNs) const {
+  return timeNs > m_startNs ? (timeNs - m_startNs) / m_timerTickNs : 0;
+}
+
+u64 JobSystem::toDeadlineTick(u64 timeNs) const {
+  return timeNs > m_startNs
+             ? (timeNs - m_startNs + m_timerTickNs - 1) / m_timerTickNs
+             : 0;
+}
+
+u64 JobSystem::toTimeNs(u64 tick) const {
+  return m_startNs + tick * m_timerTickNs;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // JobSystem
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-JobSystem::JobSystem(u32 threadCount) : m_rng(std::random_device{}()) {
+static JobSystemConfig configWithThreadCount(u32 threadCount) {
+  JobSystemConfig config;
+  config.threadCount = threadCount;
+  return config;
+}
+
+/// CPUs a pinned worker may run on.
+struct WorkerSlot {
+  List<u32> cpus;
+  u32 node = 0;
+};
+
+/// The places to pin workers to, in the order to fill them.
+static List<WorkerSlot> workerSlots(const CpuTopology& topology,
+                                    WorkerAffinity affinity) {
+  // Deal the cores out one node at a time, so that a pool smaller than the
+  // machine still gets the memory bandwidth of every node.
+  List<List<const CpuCore*>> nodeCores;
+  nodeCores.resize(topology.nodeCount);
+  for (const CpuCore& core : topology.cores) {
+    nodeCores[core.node].add(&core);
+  }
+
+  List<const CpuCore*> cores;
+  for (u64 rank = 0; cores.getSize() < topology.cores.getSize(); ++rank) {
+    for (const List<const CpuCore*>& onNode : nodeCores) {
+      if (rank < onNode.getSize()) cores.add(onNode[rank]);
+    }
+  }
+
+  List<WorkerSlot> slots;
+  if (affinity == WorkerAffinity::PhysicalCore) {
+    for (const CpuCore* core : cores) {
+      slots.add(WorkerSlot{core->cpus, core->node});
+    }
+    return slots;
+  }
+
+  // SMT siblings share execution units and caches, so hand out the first
+  // hardware thread of every core before the second thread of any.
+  const u32 cpuCount = topology.logicalCpuCount();
+  for (u64 thread = 0; slots.getSize() < cpuCount; ++thread) {
+    for (const CpuCore* core : cores) {
+      if (thread < core->cpus.getSize()) {
+        WorkerSlot& slot = slots.add();
+        slot.cpus.add(core->cpus[thread]);
+        slot.node = core->node;
+      }
+    }
+  }
+  return slots;
+}
+
+JobSystem::JobSystem(u32 threadCount)
+    : JobSystem(configWithThreadCount(threadCount)) {}
+
+JobSystem::JobSystem(const JobSystemConfig& config)
+    : m_injectQueue(std::make_unique<JobQueue>()),
+      m_maxBacklog(config.backpressure.maxBacklog),
+      m_highWater(config.backpressure.highWater),
+      m_onHighWater(config.backpressure.onHighWater),
+      m_countBacklog(m_maxBacklog > 0 || m_highWater > 0),
+      m_blockingPool(config.blocking.maxThreads,
+                     static_cast<u64>(dc::max<s64>(
+                         config.blocking.idleTimeout.count(), 0))),
+      m_ownerQueue(std::make_unique<JobQueue>()),
+      m_ownerThread(std::this_thread::get_id()),
+      m_fiberConfig(config.fibers),
+      m_startNs(getTimeNs()),
+      m_timerTickNs(dc::max<u64>(
+          static_cast<u64>(config.timerTick.count()), 1)),
+      m_idle(config.idle),
+      m_backgroundQuota(config.backgroundQuota),
+      m_elastic(config.elastic),
+      m_growAfterNs(static_cast<u64>(
+          dc::max<s64>(config.elastic.growAfter.count(), 0))),
+      m_shrinkAfterNs(static_cast<u64>(
+          dc::max<s64>(config.elastic.shrinkAfter.count(), 0))) {
+  u32 threadCount = config.threadCount;
+
+  if (!DC_JOB_FIBERS) m_fiberConfig.enabled = false;
+
+  List<WorkerSlot> slots;
+  if (config.affinity != WorkerAffinity::Unpinned) {
+    slots = workerSlots(queryCpuTopology(), config.affinity);
+    if (threadCount == 0) threadCount = static_cast<u32>(slots.getSize());
+  }
+
   if (threadCount == 0) {
     const u32 hwThreads = static_cast<u32>(std::thread::hardware_concurrency());
     threadCount = hwThreads > 0 ? hwThreads : 1;
   }
 
+  // A minimum of all workers is a fixed pool.
+  if (m_elastic.minThreads >= threadCount) m_elastic.minThreads = 0;
+  const u32 startCount =
+      m_elastic.minThreads > 0 ? m_elastic.minThreads : threadCount;
+
+  // Create every worker before starting any thread, workers look at each
+  // other's deques when stealing.
   m_workers.reserve(threadCount);
+  m_pinnedQueues.reserve(threadCount);
   for (u32 i = 0; i < threadCount; ++i) {
-    auto worker = std::make_unique<Worker>();
-    worker->thread = std::thread(workerLoop, std::ref(*worker));
+    m_pinnedQueues.add(std::make_unique<JobQueue>());
+    auto worker = std::make_unique<Worker>(config.scratchChunkBytes);
+    worker->index = i;
+    if (!slots.isEmpty()) {
+      const WorkerSlot& slot = slots[i % slots.getSize()];
+      worker->cpus = slot.cpus;
+      worker->node = slot.node;
+    }
+    if (config.traceCapacity > 0) {
+      worker->traceEvents =
+          std::make_unique<TraceEvent[]>(config.traceCapacity);
+      worker->traceCapacity = config.traceCapacity;
+    }
+    worker->idleSinceNs = m_startNs;
+    if (i >= startCount) {
+      // Not started yet, grow() sets it up.
+      worker->accepting.store(false, std::memory_order_relaxed);
+      for (WorkerLane& lane : worker->lanes) lane.ring.reset();
+    }
     m_workers.push_back(dc::move(worker));
   }
+
+  // Steal from workers on our own node first, their jobs likely touch memory
+  // that is local to us too. Each worker starts right after itself so that
+  // thieves spread over the victims.
+  for (auto& worker : m_workers) {
+    worker->victims.reserve(threadCount - 1);
+    for (const bool sameNode : {true, false}) {
+      for (u32 i = 1; i < threadCount; ++i) {
+        const u32 index = (worker->index + i) % threadCount;
+        if ((m_workers[index]->node == worker->node) == sameNode) {
+          worker->victims.add(index);
+        }
+      }
+    }
+  }
+
+  m_activeCount.store(startCount, std::memory_order_relaxed);
+  for (u32 i = 0; i < startCount; ++i) {
+    m_workers[i]->thread =
+        std::thread(&JobSystem::workerLoop, this, std::ref(*m_workers[i]));
+  }
 }
 
 JobSystem::~JobSystem() {
+  // Blocking jobs may still add jobs for the workers, let them finish first.
+  // A blocking job added from here on runs on the thread that adds it.
+  m_blockingPool.stop();
+
+  {
+    // No worker starts or retires from here on.
+    std::scoped_lock lock(m_elasticMutex);
+    m_stopping = true;
+  }
+
   // Signal all workers to shut down.
   for (auto& worker : m_workers) {
-    {
-      std::scoped_lock lock(worker->mutex);
-      worker->shutdown = true;
-    }
-    worker->cv.notify_one();
+    // Stored before the wake signal is bumped, so that a worker that reads
+    // the new signal also sees the flag.
+    worker->shutdown.store(true, std::memory_order_release);
+    wake(*worker);
   }
 
   // Join all worker threads.
@@ -95,147 +1145,546 @@ JobSystem::~JobSystem() {
       worker->thread.join();
     }
   }
+
+  // Every job is done, so every fiber is idle. A fiber that still waits is
+  // waiting for something that never completes.
+  for (Fiber* fiber : m_fibers) Fiber::destroy(fiber);
+}
+
+void JobSystem::await(JobCounter& counter) {
+  // How long to sleep on the counter before looking for jobs to help with
+  // again. Only reached once the idle policy is exhausted.
+  constexpr std::chrono::microseconds kHelpPollInterval{200};
+
+  Worker* worker = currentWorker();
+
+  // The counter may be waiting for jobs this worker finished.
+  if (worker) flushDone(*worker);
+
+  // On a fiber, switch out and let the worker get on with other jobs. The
+  // continuation that resumes us needs a JobSystem to run on. A pinned job
+  // inside the fiber's job, or one holding scratch memory, must not be
+  // resumed elsewhere, and waits below.
+  if (worker && worker->fiber && worker->pinnedDepth == 0 &&
+      !fiberHoldsScratch(*worker) && counter.system()) {
+    if (!counter.isDone()) {
+      Fiber* fiber = worker->fiber;
+      fiber->waitingOn = &counter;
+      switchFiber(fiber->context, worker->schedulerContext);
+      // We may be on another worker now, worker is stale.
+    }
+    counter.wait();
+    return;
+  }
+
+  u32 idleRounds = 0;
+  while (!counter.isDone()) {
+    if (worker) {
+      if (runNext(*worker)) {
+        if (worker->doneCounter == &counter) flushDone(*worker);
+        idleRounds = 0;
+        continue;
+      }
+    } else if (isOwnerThread() && pumpOwnerQueue(1) > 0) {
+      // Only we can run those, the batch may be waiting for one.
+      idleRounds = 0;
+      continue;
+    } else if (PooledJob* job = stealExternal()) {
+      if (job->job.admitted) leaveBacklog();
+      job->job.run();
+      JobPool::release(job, nullptr);
+      m_externalJobsRun.fetch_add(1, std::memory_order_relaxed);
+      idleRounds = 0;
+      continue;
+    }
+
+    if (idleRounds < m_idle.spinCount) {
+      cpuRelax();
+    } else if (idleRounds < m_idle.spinCount + m_idle.yieldCount) {
+      std::this_thread::yield();
+    } else {
+      counter.waitFor(kHelpPollInterval);
+    }
+    ++idleRounds;
+  }
+
+  // The count is zero, but the thread that brought it there may still be
+  // inside complete(). Wait for it to finish, the caller may destroy the
+  // counter as soon as we return.
+  counter.wait();
+}
+
+u64 JobSystem::stealCount() const {
+  u64 total = 0;
+  for (const auto& worker : m_workers) {
+    total += worker->stealCount.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+u64 JobSystem::stealCount(u32 workerIndex) const {
+  DC_ASSERT(workerIndex < workerCount(), "Worker index out of range");
+  return m_workers[workerIndex]->stealCount.load(std::memory_order_relaxed);
+}
+
+JobSystemStats JobSystem::stats() const {
+  JobSystemStats stats;
+  stats.workers.reserve(m_workers.size());
+  for (const auto& worker : m_workers) {
+    WorkerStats& out = stats.workers.add();
+    out.jobsRun = worker->jobsRun.load(std::memory_order_relaxed);
+    out.jobsStolen = worker->stealCount.load(std::memory_order_relaxed);
+    out.busyNs = worker->busyNs.load(std::memory_order_relaxed);
+    out.parkedNs = worker->parkedNs.load(std::memory_order_relaxed);
+    out.wakeUps = worker->wakeUps.load(std::memory_order_relaxed);
+    out.inboxHighWater = worker->inboxHighWater.load(std::memory_order_relaxed);
+    stats.traceEventsDropped +=
+        worker->traceDropped.load(std::memory_order_relaxed);
+  }
+  stats.overflowPushes = m_overflowPushes.load(std::memory_order_relaxed);
+  stats.backlog = backlog();
+  stats.externalJobsRun = m_externalJobsRun.load(std::memory_order_relaxed);
+  stats.blockingJobsRun = m_blockingPool.jobsRun();
+  stats.blockingThreads = m_blockingPool.threadCount();
+  return stats;
+}
+
+dc::String JobSystem::chromeTrace() const {
+  static constexpr const char* kPriorityNames[kJobPriorityCount] = {
+      "high", "normal", "background"};
+
+  // Timestamps are in microseconds, relative to when the JobSystem started.
+  auto toUs = [this](u64 ns) {
+    return static_cast<f64>(ns - m_startNs) / 1000.0;
+  };
+
+  dc::String json;
+  json += "{\"traceEvents\":[";
+
+  char line[192];
+  bool first = true;
+  for (const auto& worker : m_workers) {
+    // Name the track, otherwise it only shows the thread id.
+    std::snprintf(line, sizeof(line),
+                  "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                  "\"tid\":%u,\"args\":{\"name\":\"worker %u\"}}",
+                  first ? "" : ",", worker->index, worker->index);
+    json += line;
+    first = false;
+
+    const u32 count = worker->traceCount.load(std::memory_order_acquire);
+    for (u32 i = 0; i < count; ++i) {
+      const TraceEvent& event = worker->traceEvents[i];
+      std::snprintf(line, sizeof(line),
+                    ",{\"name\":\"job\",\"cat\":\"%s\",\"ph\":\"X\","
+                    "\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    kPriorityNames[static_cast<u32>(event.priority)],
+                    worker->index, toUs(event.beginNs),
+                    static_cast<f64>(event.endNs - event.beginNs) / 1000.0);
+      json += line;
+    }
+  }
+
+  json += "]}";
+  return json;
+}
+
+TimerId JobSystem::addAt(u64 deadlineNs, Job job) {
+  return addTimer(deadlineNs, dc::move(job), 0);
+}
+
+TimerId JobSystem::addAfter(std::chrono::nanoseconds delay, Job job) {
+  const u64 delayNs = static_cast<u64>(dc::max<s64>(delay.count(), 0));
+  return addTimer(getTimeNs() + delayNs, dc::move(job), 0);
+}
+
+TimerId JobSystem::addPeriodic(std::chrono::nanoseconds period, Job job) {
+  DC_ASSERT(period.count() > 0, "Timer period must be positive");
+
+  const u64 periodNs = static_cast<u64>(period.count());
+  const u64 periodTicks =
+      dc::max<u64>((periodNs + m_timerTickNs - 1) / m_timerTickNs, 1);
+  return addTimer(getTimeNs() + periodNs, dc::move(job), periodTicks);
+}
+
+bool JobSystem::cancelTimer(TimerId id) {
+  std::scoped_lock lock(m_timerMutex);
+  const bool cancelled = m_timers.cancel(id);
+  publishNextTimer();
+  return cancelled;
+}
+
+u32 JobSystem::workerNode(u32 workerIndex) const {
+  DC_ASSERT(workerIndex < workerCount(), "Worker index out of range");
+  return m_workers[workerIndex]->node;
 }
 
 void JobSystem::add(Job job) {
-  std::scoped_lock lock(m_mutex);
+  if (Worker* worker = currentWorker()) {
+    pushLocal(*worker, dc::move(job));
+    return;
+  }
 
-  // First, try to drain any previously overflowed jobs.
-  drainOverflow();
+  if (needsAdmission()) {
+    [[maybe_unused]] const bool admitted =
+        admit(1, std::chrono::nanoseconds::max());
+    job.admitted = true;
+  }
+  addExternal(dc::move(job));
+}
 
-  // Try to assign the new job to a worker, starting from a random index.
-  const u32 workerCount = static_cast<u32>(m_workers.size());
-  const u32 startIndex = randomWorkerIndex();
+bool JobSystem::tryAdd(Job&& job) {
+  return addFor(dc::move(job), std::chrono::nanoseconds::zero());
+}
 
-  for (u32 i = 0; i < workerCount; ++i) {
-    const u32 index = (startIndex + i) % workerCount;
-    Worker& worker = *m_workers[index];
+bool JobSystem::addFor(Job&& job, std::chrono::nanoseconds timeout) {
+  if (Worker* worker = currentWorker()) {
+    pushLocal(*worker, dc::move(job));
+    return true;
+  }
 
-    if (worker.ring.add(dc::move(job))) {
-      // Notify while holding the worker's mutex to prevent a lost-wakeup.
-      // Without this, the worker could: check the predicate (empty=true),
-      // release its mutex to sleep, and miss a notify that fired in between.
-      // Holding worker.mutex here ensures the notify arrives either while
-      // the worker is already in cv.wait(), or before it re-evaluates the
-      // predicate — both are safe.
-      std::scoped_lock workerLock(worker.mutex);
-      worker.cv.notify_one();
-      return;
+  if (needsAdmission()) {
+    if (!admit(1, timeout)) return false;
+    job.admitted = true;
+  }
+  addExternal(dc::move(job));
+  return true;
+}
+
+u32 JobSystem::backlog() const {
+  return m_backlog.load(std::memory_order_relaxed);
+}
+
+void JobSystem::addExternal(Job&& job) {
+  const u32 preferredIndex = nextSubmitIndex(1) % activeWorkerCount();
+  if (pushInbox(preferredIndex, dc::move(job))) return;
+
+  // All worker rings are full — push to the injection queue.
+  pushInjected(dc::move(job));
+}
+
+void JobSystem::addReleased(Job job) {
+  if (Worker* worker = currentWorker()) {
+    pushLocal(*worker, dc::move(job));
+    return;
+  }
+  addExternal(dc::move(job));
+}
+
+bool JobSystem::needsAdmission() const {
+  return m_countBacklog && detail::tJobDepth == 0;
+}
+
+bool JobSystem::admit(u32 count, std::chrono::nanoseconds timeout) {
+  if (!tryReserve(count)) {
+    if (timeout <= std::chrono::nanoseconds::zero()) return false;
+
+    // Announced before looking at the backlog again, and leaveBacklog() looks
+    // at the waiters after lowering it. Either it sees us and notifies under
+    // the lock, or we see the room it made.
+    m_roomWaiters.fetch_add(1);
+    std::unique_lock lock(m_roomMutex);
+    bool reserved = true;
+    auto hasRoom = [this, count] { return tryReserve(count); };
+    if (timeout == std::chrono::nanoseconds::max()) {
+      m_roomCv.wait(lock, hasRoom);
+    } else {
+      reserved = m_roomCv.wait_for(lock, timeout, hasRoom);
     }
+    lock.unlock();
+    m_roomWaiters.fetch_sub(1, std::memory_order_relaxed);
+    if (!reserved) return false;
   }
 
-  // All worker rings are full — push to the overflow ring.
-  if (m_overflowRing.isFull() || m_overflowRing.data == nullptr) {
-    const u32 newCapacity =
-        m_overflowRing.capacity == 0 ? 64u : m_overflowRing.capacity * 2;
-    [[maybe_unused]] const bool ok = m_overflowRing.reserve(newCapacity);
-    DC_ASSERT(ok, "Failed to grow overflow ring");
+  if (m_highWater > 0 && !m_aboveHighWater.load(std::memory_order_relaxed)) {
+    const u32 backlog = m_backlog.load(std::memory_order_relaxed);
+    if (backlog >= m_highWater &&
+        !m_aboveHighWater.exchange(true, std::memory_order_relaxed) &&
+        m_onHighWater) {
+      m_onHighWater(backlog);
+    }
+  }
+  return true;
+}
+
+bool JobSystem::tryReserve(u32 count) {
+  // Only counted for the high water mark, no one waits for room.
+  if (m_maxBacklog == 0) {
+    m_backlog.fetch_add(count, std::memory_order_relaxed);
+    return true;
   }
 
-  [[maybe_unused]] const bool added = m_overflowRing.add(dc::move(job));
-  DC_ASSERT(added, "Failed to add job to overflow ring after growing");
+  // A batch larger than the whole backlog waits for it to empty. Sequentially
+  // consistent for the handshake with leaveBacklog(), see admit().
+  const u32 limit = m_maxBacklog > count ? m_maxBacklog - count : 0;
+  u32 backlog = m_backlog.load();
+  while (backlog <= limit) {
+    if (m_backlog.compare_exchange_weak(backlog, backlog + count)) return true;
+  }
+  return false;
 }
 
-JobHandle JobSystem::add(dc::List<Job>& jobs) {
+void JobSystem::leaveBacklog() {
+  // Without a limit no one waits in admit(), so there is no one to wake.
+  const u32 backlog =
+      m_maxBacklog == 0 ? m_backlog.fetch_sub(1, std::memory_order_relaxed) - 1
+                        : m_backlog.fetch_sub(1) - 1;
+
+  if (m_highWater > 0 && backlog < m_highWater / 2 &&
+      m_aboveHighWater.load(std::memory_order_relaxed)) {
+    m_aboveHighWater.store(false, std::memory_order_relaxed);
+  }
+
+  if (m_maxBacklog > 0 && m_roomWaiters.load() > 0) {
+    std::lock_guard lock(m_roomMutex);
+    m_roomCv.notify_all();
+  }
+}
+
+JobHandle JobSystem::add(dc::List<Job>& jobs, CancellationToken token) {
   const usize count = jobs.getSize();
-  auto counter = std::make_shared<JobCounter>(static_cast<u32>(count));
+  // Every job of the batch runs, so the jobs need not own the counter.
+  auto counter =
+      JobCounter::makeBatch(static_cast<u32>(count), this, dc::move(token));
+  const std::shared_ptr<JobCounter> jobRef = counter->jobRef();
 
-  std::scoped_lock lock(m_mutex);
+  if (Worker* worker = currentWorker()) {
+    // Nested batch from inside a job. Keep it local, the other workers will
+    // steal what they need.
+    for (usize i = 0; i < count; ++i) {
+      jobs[i].counter = jobRef;
+      WorkerLane& lane = worker->lanes[static_cast<u32>(jobs[i].priority)];
+      lane.deque.push(worker->pool.acquire(dc::move(jobs[i])));
+    }
+    if (count > 0) wakeOne(worker->index);
+    return JobHandle{dc::move(counter)};
+  }
 
-  // First, try to drain any previously overflowed jobs.
-  drainOverflow();
+  if (count == 0) return JobHandle{dc::move(counter)};
+  const bool admitted = needsAdmission();
+  if (admitted) {
+    [[maybe_unused]] const bool reserved =
+        admit(static_cast<u32>(count), std::chrono::nanoseconds::max());
+  }
 
-  const u32 workerCount = static_cast<u32>(m_workers.size());
+  for (usize i = 0; i < count; ++i) {
+    // Job::run() decrements the counter once the job is done.
+    jobs[i].counter = jobRef;
+    jobs[i].admitted = admitted;
+  }
 
-  // Distribute jobs across workers in contiguous chunks so that each worker
-  // receives roughly (count / workerCount) jobs rather than all ending up on
-  // a single worker through the per-job random walk.
+  // Give each worker one contiguous slice of the batch, so that the slice goes
+  // into its inbox with a single bulk add and the worker gets at most one
+  // wake-up. The first count % workerCount workers get one job more.
   //
-  // Start at a random worker so that repeated small batches don't always
-  // favour worker 0.
-  const u32 startWorker = randomWorkerIndex();
+  // Continue from this thread's cursor so that repeated small batches don't
+  // always favour worker 0.
+  const u32 workerCount = activeWorkerCount();
+  const u32 startWorker = nextSubmitIndex(static_cast<u32>(count));
+  const usize perWorker = count / workerCount;
+  const usize extra = count % workerCount;
+  const u32 receivers =
+      static_cast<u32>(dc::min<usize>(count, workerCount));
 
-  for (usize i = 0; i < count; ++i) {
-    // Wrap the job with the counter decrement before dispatching.
-    Job wrapped{[fn = dc::move(jobs[i].fn), counter] {
-      fn();
-      counter->decrement();
-    }};
-
-    // Round-robin: assign job i to worker ((startWorker + i) % workerCount).
-    const u32 preferredIndex =
-        static_cast<u32>((startWorker + static_cast<u32>(i)) % workerCount);
-
-    // Try the preferred worker first, then walk forward if its ring is full.
-    bool dispatched = false;
-    for (u32 attempt = 0; attempt < workerCount; ++attempt) {
-      const u32 index = (preferredIndex + attempt) % workerCount;
-      Worker& worker = *m_workers[index];
-
-      if (worker.ring.add(dc::move(wrapped))) {
-        std::scoped_lock workerLock(worker.mutex);
-        worker.cv.notify_one();
-        dispatched = true;
-        break;
-      }
+  Job* slice = jobs.begin();
+  for (u32 k = 0; k < receivers; ++k) {
+    const u32 index = (startWorker + k) % workerCount;
+    const usize sliceSize = perWorker + (k < extra ? 1 : 0);
+    pushSlice(*m_workers[index], slice, sliceSize);
+    slice += sliceSize;
+  }
+
+  // Pairs with the fence in waitForWork, see notify().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (u32 k = 0; k < receivers; ++k) {
+    Worker& worker = *m_workers[(startWorker + k) % workerCount];
+    if (worker.sleeping.load(std::memory_order_relaxed)) wake(worker);
+  }
+
+  return JobHandle{dc::move(counter)};
+}
+
+void JobSystem::pushSlice(Worker& worker, Job* jobs, usize count) {
+  const bool open = enterInbox(worker);
+
+  usize begin = 0;
+  while (begin < count) {
+    // Runs of jobs with the same priority go into one lane together.
+    const JobPriority priority = jobs[begin].priority;
+    usize end = begin + 1;
+    while (end < count && jobs[end].priority == priority) ++end;
+
+    usize added = 0;
+    if (open) {
+      MpmcRing<Job>& ring = *worker.lanes[static_cast<u32>(priority)].ring;
+      added = ring.addBulk(jobs + begin, static_cast<u32>(end - begin));
     }
 
-    if (!dispatched) {
-      // All worker rings are full — push to the overflow ring.
-      if (m_overflowRing.isFull() || m_overflowRing.data == nullptr) {
-        const u32 newCapacity =
-            m_overflowRing.capacity == 0 ? 64u : m_overflowRing.capacity * 2;
-        [[maybe_unused]] const bool ok = m_overflowRing.reserve(newCapacity);
-        DC_ASSERT(ok, "Failed to grow overflow ring");
+    // The inbox filled up, or the worker retired. Spread the rest over the
+    // other workers, one by one, this is the slow path anyway.
+    for (usize i = begin + added; i < end; ++i) {
+      if (!pushInbox(worker.index + 1, dc::move(jobs[i]))) {
+        pushInjected(dc::move(jobs[i]));
       }
-      [[maybe_unused]] const bool added = m_overflowRing.add(dc::move(wrapped));
-      DC_ASSERT(added, "Failed to add job to overflow ring after growing");
     }
+    begin = end;
+  }
+
+  if (open) leaveInbox(worker);
+}
+
+bool JobSystem::pushInbox(u32 preferredIndex, Job&& job) {
+  // Try the preferred worker first, then walk forward if its ring is full.
+  // MpmcRing::add leaves the job untouched when it fails.
+  const u32 workerCount = activeWorkerCount();
+  for (u32 attempt = 0; attempt < workerCount; ++attempt) {
+    const u32 index = (preferredIndex + attempt) % workerCount;
+    Worker& worker = *m_workers[index];
+    if (!enterInbox(worker)) continue;
+
+    WorkerLane& lane = worker.lanes[static_cast<u32>(job.priority)];
+    const bool added = lane.ring->add(dc::move(job));
+    leaveInbox(worker);
+
+    if (added) {
+      notify(worker);
+      return true;
+    }
+  }
+  return false;
+}
+
+void JobSystem::pushInjected(Job&& job) {
+  // Counted first, see m_injectSize. A worker may then find the count ahead
+  // of the queue for a moment, and simply looks again.
+  m_injectSize.fetch_add(1, std::memory_order_relaxed);
+  [[maybe_unused]] const bool added =
+      m_injectQueue->jobs.enqueue(dc::move(job));
+  DC_ASSERT(added, "Failed to add job to the injection queue");
+  m_overflowPushes.fetch_add(1, std::memory_order_relaxed);
+
+  // The workers may have drained every ring and gone to sleep since we found
+  // them full.
+  wakeOne(0);
+}
+
+void JobSystem::addBlocking(Job job) { m_blockingPool.add(dc::move(job)); }
+
+JobHandle JobSystem::addBlocking(dc::List<Job>& jobs, CancellationToken token) {
+  auto counter = std::make_shared<JobCounter>(
+      static_cast<u32>(jobs.getSize()), this, dc::move(token));
+  for (Job& job : jobs) {
+    job.counter = counter;
+    m_blockingPool.add(dc::move(job));
   }
+  return JobHandle{dc::move(counter)};
+}
+
+void JobSystem::addToWorker(u32 workerIndex, Job job) {
+  DC_ASSERT(workerIndex < workerCount(), "Worker index out of range");
+  Worker& worker = *m_workers[workerIndex];
+  pushPinned(worker, dc::move(job));
+  notify(worker);
+}
+
+JobHandle JobSystem::addToWorker(u32 workerIndex, dc::List<Job>& jobs,
+                                 CancellationToken token) {
+  DC_ASSERT(workerIndex < workerCount(), "Worker index out of range");
+  const usize count = jobs.getSize();
+  auto counter = std::make_shared<JobCounter>(static_cast<u32>(count), this,
+                                              dc::move(token));
 
+  Worker& worker = *m_workers[workerIndex];
+  for (Job& job : jobs) {
+    job.counter = counter;
+    pushPinned(worker, dc::move(job));
+  }
+  if (count > 0) notify(worker);
   return JobHandle{dc::move(counter)};
 }
 
-void JobSystem::drainOverflow() {
-  // m_mutex must be held by the caller.
-  while (!m_overflowRing.isEmpty()) {
-    const u32 workerCount = static_cast<u32>(m_workers.size());
-    const u32 startIndex = randomWorkerIndex();
-    bool dispatched = false;
+void JobSystem::pushPinned(Worker& worker, Job&& job) {
+  job.pinned = true;
 
-    for (u32 i = 0; i < workerCount; ++i) {
-      const u32 index = (startIndex + i) % workerCount;
-      Worker& worker = *m_workers[index];
+  // A stopped worker has to be running before it can take jobs, and so do
+  // the ones before it.
+  while (!enterInbox(worker)) {
+    [[maybe_unused]] const bool growing = grow();
+    DC_ASSERT(growing, "Cannot start a worker while the JobSystem stops");
+    std::this_thread::yield();
+  }
 
-      Job* overflowJob = m_overflowRing.remove();
-      if (!overflowJob) break;
+  // Counted first, like m_injectSize.
+  worker.pinnedSize.fetch_add(1, std::memory_order_relaxed);
+  [[maybe_unused]] const bool added =
+      m_pinnedQueues[worker.index]->jobs.enqueue(dc::move(job));
+  DC_ASSERT(added, "Failed to add job to the pinned queue");
+  leaveInbox(worker);
+}
 
-      if (worker.ring.add(dc::move(*overflowJob))) {
-        {
-          std::scoped_lock workerLock(worker.mutex);
-          worker.cv.notify_one();
-        }
-        dispatched = true;
-        break;
-      } else {
-        // Worker ring full — put the job back. Since we just removed it, the
-        // overflow ring has space for it.
-        [[maybe_unused]] const bool readded =
-            m_overflowRing.add(dc::move(*overflowJob));
-        DC_ASSERT(readded, "Failed to re-add job to overflow ring");
-        break;
-      }
-    }
+void JobSystem::addToOwner(Job job) {
+  m_ownerSize.fetch_add(1, std::memory_order_relaxed);
+  [[maybe_unused]] const bool added =
+      m_ownerQueue->jobs.enqueue(dc::move(job));
+  DC_ASSERT(added, "Failed to add job to the owner queue");
+}
 
-    if (!dispatched) break;
+JobHandle JobSystem::addToOwner(dc::List<Job>& jobs, CancellationToken token) {
+  auto counter = std::make_shared<JobCounter>(
+      static_cast<u32>(jobs.getSize()), this, dc::move(token));
+  for (Job& job : jobs) {
+    job.counter = counter;
+    addToOwner(dc::move(job));
   }
+  return JobHandle{dc::move(counter)};
+}
+
+u32 JobSystem::pumpOwnerQueue(u32 maxJobs) {
+  DC_ASSERT(isOwnerThread(), "Only the owner thread may pump its queue");
+
+  // What is queued now, not what the jobs add while we run them.
+  const u32 count =
+      dc::min(m_ownerSize.load(std::memory_order_relaxed), maxJobs);
+  u32 ran = 0;
+  while (ran < count) {
+    Job job;
+    if (!m_ownerQueue->jobs.try_dequeue(job)) break;
+    m_ownerSize.fetch_sub(1, std::memory_order_relaxed);
+    job.run();
+    ++ran;
+  }
+  return ran;
+}
+
+void JobSystem::makeOwnerThread() {
+  m_ownerThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
 }
 
-u32 JobSystem::randomWorkerIndex() {
-  // m_mutex must be held by the caller.
-  std::uniform_int_distribution<u32> dist(
-      0u, static_cast<u32>(m_workers.size()) - 1u);
-  return dist(m_rng);
+bool JobSystem::isOwnerThread() const {
+  return m_ownerThread.load(std::memory_order_relaxed) ==
+         std::this_thread::get_id();
+}
+
+void JobSystem::notify(Worker& worker) {
+  // Pairs with the fence in waitForWork, see the comment there. Only a worker
+  // that is (about to be) parked needs the wake, an awake one will find the
+  // job before it parks.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (worker.sleeping.load(std::memory_order_relaxed)) wake(worker);
+}
+
+u32 JobSystem::nextSubmitIndex(u32 count) {
+  // Each submitting thread keeps its own round-robin cursor, so producers
+  // never contend on shared state to pick a worker. Threads start at
+  // different offsets so that concurrent producers spread out.
+  static std::atomic<u32> sNextProducer{0};
+  static thread_local u32 tCursor =
+      sNextProducer.fetch_add(1, std::memory_order_relaxed);
+
+  const u32 index = tCursor;
+  tCursor += count;
+  return index;
 }
 
 }  // namespace dc
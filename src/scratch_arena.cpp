@@ -0,0 +1,167 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <dc/assert.hpp>
+#include <dc/job/scratch_arena.hpp>
+#include <dc/math.hpp>
+
+namespace dc {
+
+static uintptr alignUp(uintptr value, usize align) {
+  return (value + align - 1) & ~(align - 1);
+}
+
+ScratchArena::ScratchArena(usize chunkBytes, IAllocator& backing)
+    : m_backing(backing), m_chunkBytes(chunkBytes) {
+  DC_ASSERT(chunkBytes > sizeof(Chunk), "Scratch chunks are too small");
+}
+
+ScratchArena::~ScratchArena() {
+  reset();
+  while (m_first) {
+    Chunk* next = m_first->next;
+    m_backing.free(m_first);
+    m_first = next;
+  }
+}
+
+void* ScratchArena::alloc(usize count, usize align) {
+  DC_ASSERT((align & (align - 1)) == 0, "Alignment must be a power of two");
+  align = dc::max(align, kMinimumAlignment);
+
+  if (void* data = bump(count, align)) return data;
+
+  // Worst case room needed in a fresh chunk, past its header.
+  const usize needed = count + sizeof(usize) + align;
+  if (needed > m_chunkBytes - sizeof(Chunk)) return allocLarge(count, align);
+
+  // Move on to the next chunk, which is free if we have one from before.
+  Chunk* next = m_current ? m_current->next : m_first;
+  if (!next) {
+    next = static_cast<Chunk*>(m_backing.alloc(m_chunkBytes, alignof(Chunk)));
+    if (!next) return nullptr;
+    next->next = nullptr;
+    next->size = m_chunkBytes;
+    m_reserved += m_chunkBytes;
+    if (m_current) {
+      m_current->next = next;
+    } else {
+      m_first = next;
+    }
+  }
+
+  m_current = next;
+  m_cursor = dataOf(next);
+  m_end = reinterpret_cast<u8*>(next) + next->size;
+  return bump(count, align);
+}
+
+void* ScratchArena::realloc(void* data, usize count, usize align) {
+  if (!data) return alloc(count, align);
+
+  const usize oldCount = sizeOf(data);
+  u8* bytes = static_cast<u8*>(data);
+  const bool aligned =
+      (reinterpret_cast<uintptr>(data) & (dc::max(align, kMinimumAlignment) -
+                                          1)) == 0;
+  if (aligned && isMostRecent(bytes, oldCount) && bytes + count <= m_end) {
+    m_cursor = bytes + count;
+    m_used = m_used - oldCount + count;
+    sizeOf(data) = count;
+    return data;
+  }
+
+  void* moved = alloc(count, align);
+  if (!moved) return nullptr;
+  std::memcpy(moved, data, dc::min(oldCount, count));
+  return moved;
+}
+
+void ScratchArena::free(void* data) {
+  if (!data) return;
+
+  // Only the most recent allocation can go back. Its size header is the
+  // lowest byte we know to be ours, alignment padding before it is lost.
+  u8* bytes = static_cast<u8*>(data);
+  const usize count = sizeOf(data);
+  if (isMostRecent(bytes, count)) {
+    m_cursor = bytes - sizeof(usize);
+    m_used -= count;
+  }
+}
+
+void ScratchArena::reset() {
+  while (m_large) {
+    Chunk* next = m_large->next;
+    m_reserved -= m_large->size;
+    m_backing.free(m_large);
+    m_large = next;
+  }
+
+  m_current = m_first;
+  m_cursor = m_first ? dataOf(m_first) : nullptr;
+  m_end = m_first ? reinterpret_cast<u8*>(m_first) + m_first->size : nullptr;
+  m_used = 0;
+}
+
+void* ScratchArena::bump(usize count, usize align) {
+  if (!m_cursor) return nullptr;
+
+  const uintptr data =
+      alignUp(reinterpret_cast<uintptr>(m_cursor) + sizeof(usize), align);
+  if (data + count > reinterpret_cast<uintptr>(m_end)) return nullptr;
+
+  m_cursor = reinterpret_cast<u8*>(data + count);
+  m_used += count;
+  void* result = reinterpret_cast<void*>(data);
+  sizeOf(result) = count;
+  return result;
+}
+
+bool ScratchArena::isMostRecent(const u8* data, usize count) const {
+  // A large allocation may happen to end where the cursor is, but it is never
+  // inside the current chunk.
+  return m_current && data + count == m_cursor && data > dataOf(m_current);
+}
+
+void* ScratchArena::allocLarge(usize count, usize align) {
+  const usize size = sizeof(Chunk) + sizeof(usize) + align + count;
+  auto* chunk = static_cast<Chunk*>(m_backing.alloc(size, alignof(Chunk)));
+  if (!chunk) return nullptr;
+  chunk->next = m_large;
+  chunk->size = size;
+  m_large = chunk;
+  m_reserved += size;
+
+  const uintptr data =
+      alignUp(reinterpret_cast<uintptr>(dataOf(chunk)) + sizeof(usize), align);
+  m_used += count;
+  void* result = reinterpret_cast<void*>(data);
+  sizeOf(result) = count;
+  return result;
+}
+
+}  // namespace dc
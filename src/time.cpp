@@ -59,11 +59,15 @@ namespace dc {
     freq.QuadPart = 1;
   }
 
-  timeNs = static_cast<u64>(time.QuadPart * 1'000'000 / freq.QuadPart);
+  // Whole seconds and the rest apart, the product would overflow.
+  const u64 ticks = static_cast<u64>(time.QuadPart);
+  const u64 ticksPerS = static_cast<u64>(freq.QuadPart);
+  timeNs = ticks / ticksPerS * 1'000'000'000 +
+           ticks % ticksPerS * 1'000'000'000 / ticksPerS;
 #elif defined(DC_PLATFORM_LINUX)
   timespec time;
   if (clock_gettime(CLOCK_MONOTONIC_RAW, &time) == 0)
-    timeNs = static_cast<u64>(time.tv_sec * 1'000'000 + time.tv_nsec);
+    timeNs = static_cast<u64>(time.tv_sec * 1'000'000'000 + time.tv_nsec);
   else
     timeNs = 0;
 #else
@@ -87,14 +91,18 @@ namespace dc {
   }
   std::atomic_signal_fence(std::memory_order_seq_cst);
 
-  timeNs = static_cast<u64>(time.QuadPart * 1'000'000 / freq.QuadPart);
+  // Whole seconds and the rest apart, the product would overflow.
+  const u64 ticks = static_cast<u64>(time.QuadPart);
+  const u64 ticksPerS = static_cast<u64>(freq.QuadPart);
+  timeNs = ticks / ticksPerS * 1'000'000'000 +
+           ticks % ticksPerS * 1'000'000'000 / ticksPerS;
 #elif defined(DC_PLATFORM_LINUX)
   timespec time;
   std::atomic_signal_fence(std::memory_order_seq_cst);
   const auto res = clock_gettime(CLOCK_MONOTONIC_RAW, &time);
   std::atomic_signal_fence(std::memory_order_seq_cst);
   if (res == 0)
-    timeNs = static_cast<u64>(time.tv_sec * 1'000'000 + time.tv_nsec);
+    timeNs = static_cast<u64>(time.tv_sec * 1'000'000'000 + time.tv_nsec);
   else
     timeNs = 0;
 #else
@@ -0,0 +1,265 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <bit>
+#include <dc/assert.hpp>
+#include <dc/job/timer_wheel.hpp>
+#include <dc/math.hpp>
+#include <dc/traits.hpp>
+
+namespace dc {
+
+static constexpr u64 kSlotMask = TimerWheel::kSlotCount - 1;
+
+/// Ticks covered by the whole wheel. Deadlines further out go around the top
+/// level more than once.
+static constexpr u64 kWheelSpan = u64{1}
+                                  << (TimerWheel::kSlotBits *
+                                      TimerWheel::kLevelCount);
+
+TimerWheel::TimerWheel(u64 currentTick) : m_currentTick(currentTick) {
+  for (auto& level : m_slots) {
+    for (u32& head : level) head = kNil;
+  }
+}
+
+TimerId TimerWheel::add(u64 deadlineTick, Job job, u64 periodTicks) {
+  const u32 index = allocate();
+  Node& node = m_nodes[index];
+  node.job = dc::move(job);
+  node.deadlineTick = deadlineTick;
+  node.periodTicks = periodTicks;
+  node.state = NodeState::Pending;
+  link(index);
+  return makeId(index, node);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+  Node* node = find(id);
+  if (!node) return false;
+
+  const u32 index = static_cast<u32>(node - m_nodes.begin());
+  if (node->state == NodeState::Pending) unlink(index);
+  release(index);
+  return true;
+}
+
+void TimerWheel::advance(u64 nowTick, List<Job>& due,
+                         List<DuePeriodicTimer>& duePeriodic) {
+  while (m_currentTick <= nowTick) {
+    const u32 slot = static_cast<u32>(m_currentTick & kSlotMask);
+
+    // Level 0 wrapped around, bring the next stretch down from above. Each
+    // level only cascades when the one below it wrapped too.
+    if (slot == 0) {
+      for (u32 level = 1; level < kLevelCount && cascade(level) == 0; ++level) {
+      }
+    }
+
+    u32 index = m_slots[0][slot];
+    m_slots[0][slot] = kNil;
+    m_occupied[0] &= ~(u64{1} << slot);
+
+    while (index != kNil) {
+      Node& node = m_nodes[index];
+      const u32 next = node.next;
+      if (node.periodTicks == 0) {
+        due.add(dc::move(node.job));
+        release(index);
+      } else {
+        node.state = NodeState::Due;
+        node.prev = kNil;
+        node.next = kNil;
+        duePeriodic.add(
+            DuePeriodicTimer{makeId(index, node), node.job.priority});
+      }
+      index = next;
+    }
+
+    // Skip straight to the next tick that fires or cascades a timer, the
+    // ones in between have nothing to do.
+    ++m_currentTick;
+    m_currentTick =
+        dc::min(dc::max(nextTick(), m_currentTick), nowTick + 1);
+  }
+}
+
+bool TimerWheel::takePeriodic(TimerId id, Job& job) {
+  Node* node = find(id);
+  if (!node || node->state != NodeState::Due) return false;
+
+  job = dc::move(node->job);
+  node->state = NodeState::Running;
+  return true;
+}
+
+bool TimerWheel::rearm(TimerId id, Job&& job, u64 nowTick) {
+  Node* node = find(id);
+  if (!node) return false;
+  DC_ASSERT(node->state == NodeState::Running,
+            "Periodic timer was not taken with takePeriodic()");
+
+  // Stay on the original grid of deadlines, so that the period does not
+  // drift by however late each run was.
+  const u64 period = node->periodTicks;
+  u64 deadline = node->deadlineTick + period;
+  if (deadline <= nowTick) {
+    deadline += (nowTick - deadline) / period * period + period;
+  }
+
+  node->job = dc::move(job);
+  node->deadlineTick = deadline;
+  node->state = NodeState::Pending;
+  link(static_cast<u32>(node - m_nodes.begin()));
+  return true;
+}
+
+u64 TimerWheel::nextTick() const {
+  u64 next = kNever;
+
+  // Level 0 has a slot per tick, the first timer found is the earliest.
+  if (m_occupied[0] != 0) {
+    const u32 slot = static_cast<u32>(m_currentTick & kSlotMask);
+    const u64 rotated = std::rotr(m_occupied[0], static_cast<s32>(slot));
+    next = m_currentTick + static_cast<u64>(std::countr_zero(rotated));
+  }
+
+  // Above that, the earliest a slot can fire is when it cascades down. That
+  // is the current tick for the current slot, if the level below wraps around
+  // there, otherwise the slot is a whole turn away.
+  for (u32 level = 1; level < kLevelCount; ++level) {
+    if (m_occupied[level] == 0) continue;
+
+    const u32 shift = kSlotBits * level;
+    const u64 turn = m_currentTick >> shift;
+    const u64 first = (m_currentTick & ((u64{1} << shift) - 1)) == 0 ? 0 : 1;
+    const u32 slot = static_cast<u32>((turn + first) & kSlotMask);
+    const u64 distance = static_cast<u64>(std::countr_zero(
+        std::rotr(m_occupied[level], static_cast<s32>(slot))));
+    next = dc::min(next, (turn + first + distance) << shift);
+  }
+
+  return next;
+}
+
+TimerWheel::Node* TimerWheel::find(TimerId id) {
+  const u64 index = (id.value & 0xffffffff) - 1;
+  if (!id.isValid() || index >= m_nodes.getSize()) return nullptr;
+
+  Node& node = m_nodes[index];
+  if (node.state == NodeState::Free ||
+      node.generation != static_cast<u32>(id.value >> 32)) {
+    return nullptr;
+  }
+  return &node;
+}
+
+TimerId TimerWheel::makeId(u32 index, const Node& node) {
+  // Index + 1, so that no valid id is 0.
+  return TimerId{(u64{node.generation} << 32) | (u64{index} + 1)};
+}
+
+u32 TimerWheel::allocate() {
+  ++m_size;
+  if (m_freeHead != kNil) {
+    const u32 index = m_freeHead;
+    m_freeHead = m_nodes[index].next;
+    return index;
+  }
+
+  m_nodes.add();
+  return static_cast<u32>(m_nodes.getSize() - 1);
+}
+
+void TimerWheel::release(u32 index) {
+  Node& node = m_nodes[index];
+  node.job = Job{};
+  node.state = NodeState::Free;
+  ++node.generation;
+  node.prev = kNil;
+  node.next = m_freeHead;
+  m_freeHead = index;
+  --m_size;
+}
+
+void TimerWheel::link(u32 index) {
+  Node& node = m_nodes[index];
+
+  // A deadline that passed goes in the slot processed next.
+  const u64 deadline = dc::max(node.deadlineTick, m_currentTick);
+  const u64 delta = deadline - m_currentTick;
+
+  u32 level = 0;
+  while (level + 1 < kLevelCount &&
+         delta >= u64{1} << (kSlotBits * (level + 1))) {
+    ++level;
+  }
+
+  // Too far out for the wheel. Park it in the last slot of the top level,
+  // it is linked again from there once that slot comes around.
+  const u64 slotTick = delta < kWheelSpan ? deadline
+                                           : m_currentTick + kWheelSpan - 1;
+  const u32 slot =
+      static_cast<u32>((slotTick >> (kSlotBits * level)) & kSlotMask);
+
+  node.level = static_cast<u8>(level);
+  node.slot = static_cast<u8>(slot);
+  node.prev = kNil;
+  node.next = m_slots[level][slot];
+  if (node.next != kNil) m_nodes[node.next].prev = index;
+  m_slots[level][slot] = index;
+  m_occupied[level] |= u64{1} << slot;
+}
+
+void TimerWheel::unlink(u32 index) {
+  Node& node = m_nodes[index];
+  if (node.prev != kNil) {
+    m_nodes[node.prev].next = node.next;
+  } else {
+    m_slots[node.level][node.slot] = node.next;
+    if (node.next == kNil) m_occupied[node.level] &= ~(u64{1} << node.slot);
+  }
+  if (node.next != kNil) m_nodes[node.next].prev = node.prev;
+}
+
+u32 TimerWheel::cascade(u32 level) {
+  const u32 slot = static_cast<u32>(
+      (m_currentTick >> (kSlotBits * level)) & kSlotMask);
+
+  u32 index = m_slots[level][slot];
+  m_slots[level][slot] = kNil;
+  m_occupied[level] &= ~(u64{1} << slot);
+
+  // Every timer here is due within this slot's span, which the levels below
+  // now cover.
+  while (index != kNil) {
+    const u32 next = m_nodes[index].next;
+    link(index);
+    index = next;
+  }
+  return slot;
+}
+
+}  // namespace dc
@@ -0,0 +1,103 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dc/cpu_topology.hpp>
+#include <dc/dtest.hpp>
+#include <dc/platform.hpp>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parseCpuList
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(cpuListSingle) {
+  dc::List<u32> cpus;
+  ASSERT_TRUE(dc::parseCpuList("0\n", cpus));
+  ASSERT_EQ(cpus.getSize(), 1u);
+  ASSERT_EQ(cpus[0], 0u);
+}
+
+DTEST(cpuListRangesAndSingles) {
+  dc::List<u32> cpus;
+  ASSERT_TRUE(dc::parseCpuList("0-2,8,10-11", cpus));
+  const u32 expected[] = {0, 1, 2, 8, 10, 11};
+  ASSERT_EQ(cpus.getSize(), 6u);
+  for (u64 i = 0; i < cpus.getSize(); ++i) ASSERT_EQ(cpus[i], expected[i]);
+}
+
+DTEST(cpuListEmpty) {
+  // An empty list is valid, e.g. the cpulist of a memory-only node.
+  dc::List<u32> cpus;
+  ASSERT_TRUE(dc::parseCpuList("\n", cpus));
+  ASSERT_TRUE(cpus.isEmpty());
+}
+
+DTEST(cpuListMalformed) {
+  dc::List<u32> cpus;
+  ASSERT_FALSE(dc::parseCpuList("a", cpus));
+  ASSERT_FALSE(dc::parseCpuList("3-1", cpus));
+  ASSERT_FALSE(dc::parseCpuList("1-", cpus));
+  ASSERT_FALSE(dc::parseCpuList("1;2", cpus));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// queryCpuTopology
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(cpuTopologyIsConsistent) {
+  const dc::CpuTopology topology = dc::queryCpuTopology();
+  ASSERT_TRUE(topology.coreCount() > 0);
+  ASSERT_TRUE(topology.nodeCount > 0);
+  ASSERT_TRUE(topology.logicalCpuCount() >= topology.coreCount());
+
+  // Every logical CPU belongs to exactly one core.
+  dc::List<u32> seen;
+  for (const dc::CpuCore& core : topology.cores) {
+    ASSERT_FALSE(core.cpus.isEmpty());
+    ASSERT_TRUE(core.node < topology.nodeCount);
+    for (const u32 cpu : core.cpus) {
+      ASSERT_TRUE(seen.find(cpu) == seen.end());
+      seen.add(cpu);
+    }
+  }
+  ASSERT_EQ(static_cast<u32>(seen.getSize()), topology.logicalCpuCount());
+}
+
+DTEST(cpuTopologyPinCurrentThread) {
+  const dc::CpuTopology topology = dc::queryCpuTopology();
+  const dc::List<u32>& cpus = topology.cores[0].cpus;
+
+#if defined(DC_PLATFORM_LINUX) || defined(DC_PLATFORM_WINDOWS)
+  // Pin a scratch thread rather than the test runner.
+  bool pinned = false;
+  std::thread thread([&] {
+    pinned = dc::setCurrentThreadAffinity(cpus.begin(), cpus.getSize());
+  });
+  thread.join();
+  ASSERT_TRUE(pinned);
+#endif
+
+  ASSERT_FALSE(dc::setCurrentThreadAffinity(cpus.begin(), 0));
+}
@@ -0,0 +1,198 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/future.hpp>
+#include <dc/job_system.hpp>
+#include <dc/result.hpp>
+#include <dc/string.hpp>
+#include <dc/task.hpp>
+#include <dc/time.hpp>
+#include <memory>
+#include <vector>
+
+// See dc/task.hpp.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// submit / get
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(futureGetReturnsValue) {
+  dc::JobSystem js(2);
+  dc::Future<s32> future = js.submit([] { return 42; });
+  ASSERT_TRUE(future.isValid());
+  ASSERT_EQ(future.get(), 42);
+  ASSERT_FALSE(future.isValid());
+}
+
+DTEST(futureDefaultIsEmpty) {
+  const dc::Future<s32> future;
+  ASSERT_FALSE(future.isValid());
+}
+
+DTEST(futureVoid) {
+  dc::JobSystem js(2);
+  std::atomic<bool> ran{false};
+  dc::Future<void> future = js.submit([&ran] { ran.store(true); });
+  future.get();
+  ASSERT_TRUE(ran.load());
+}
+
+DTEST(futureMoveOnlyValue) {
+  dc::JobSystem js(2);
+  dc::Future<std::unique_ptr<s32>> future =
+      js.submit([] { return std::make_unique<s32>(7); });
+  std::unique_ptr<s32> value = future.get();
+  ASSERT_NE(value.get(), nullptr);
+  ASSERT_EQ(*value, 7);
+}
+
+DTEST(futureHoldsResult) {
+  dc::JobSystem js(2);
+  dc::Future<dc::Result<s32, dc::String>> ok =
+      js.submit([]() -> dc::Result<s32, dc::String> { return dc::Ok(5); });
+  dc::Future<dc::Result<s32, dc::String>> err =
+      js.submit([]() -> dc::Result<s32, dc::String> {
+        return dc::Err(dc::String("no such file"));
+      });
+
+  dc::Result<s32, dc::String> okResult = ok.get();
+  ASSERT_TRUE(okResult.isOk());
+  ASSERT_EQ(okResult.value(), 5);
+
+  dc::Result<s32, dc::String> errResult = err.get();
+  ASSERT_TRUE(errResult.isErr());
+  ASSERT_EQ(errResult.errValue().toView(), "no such file");
+}
+
+DTEST(futureTryGetDoesNotBlock) {
+  dc::JobSystem js(1);
+  std::atomic<bool> release{false};
+  dc::Future<s32> future = js.submit([&release] {
+    while (!release.load()) dc::sleepMs(1);
+    return 3;
+  });
+
+  ASSERT_TRUE(future.tryGet().isNone());
+  ASSERT_TRUE(future.isValid());
+
+  release.store(true);
+  future.await();
+  ASSERT_TRUE(future.isReady());
+  dc::Option<s32> value = future.tryGet();
+  ASSERT_TRUE(value.isSome());
+  ASSERT_EQ(value.value(), 3);
+  ASSERT_FALSE(future.isValid());
+}
+
+DTEST(futureGetFromManyThreads) {
+  // Futures submitted and waited on from outside the pool, many at a time.
+  dc::JobSystem js(4);
+  std::vector<dc::Future<s32>> futures;
+  for (s32 i = 0; i < 1000; ++i) {
+    futures.push_back(js.submit([i] { return i * 2; }));
+  }
+  for (s32 i = 0; i < 1000; ++i) {
+    ASSERT_EQ(futures[static_cast<usize>(i)].get(), i * 2);
+  }
+}
+
+DTEST(futureSubmitFromJob) {
+  dc::JobSystem js(2);
+  dc::Future<s32> outer = js.submit([&js] {
+    dc::Future<s32> inner = js.submit([] { return 20; });
+    return inner.get() + 1;
+  });
+  ASSERT_EQ(outer.get(), 21);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Continuations
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(futureThenChainsValues) {
+  dc::JobSystem js(2);
+  dc::Future<s32> future = js.submit([] { return 10; });
+  dc::Future<dc::String> text =
+      future.then([](s32 v) { return v * 3; }).then([](s32 v) {
+        return v == 30 ? dc::String("thirty") : dc::String("wrong");
+      });
+  ASSERT_FALSE(future.isValid());
+  ASSERT_EQ(text.get().toView(), "thirty");
+}
+
+DTEST(futureThenOnReadyFutureRuns) {
+  dc::JobSystem js(2);
+  dc::Future<s32> future = js.submit([] { return 1; });
+  future.await();
+  ASSERT_EQ(future.then([](s32 v) { return v + 1; }).get(), 2);
+}
+
+DTEST(futureThenFromVoid) {
+  dc::JobSystem js(2);
+  std::atomic<s32> order{0};
+  dc::Future<s32> future =
+      js.submit([&order] { order.store(1); }).then([&order] {
+        return order.load() + 1;
+      });
+  ASSERT_EQ(future.get(), 2);
+}
+
+DTEST(futureThenMapsResult) {
+  dc::JobSystem js(2);
+  dc::Future<dc::Result<s32, s32>> parsed =
+      js.submit([]() -> dc::Result<s32, s32> { return dc::Err(-1); });
+  dc::Future<s32> value = parsed.then([](dc::Result<s32, s32> result) {
+    return dc::move(result).unwrapOr(0);
+  });
+  ASSERT_EQ(value.get(), 0);
+}
+
+DTEST(futureHandleJoinsWhenAll) {
+  dc::JobSystem js(4);
+  dc::Future<s32> a = js.submit([] { return 1; });
+  dc::Future<s32> b = js.submit([] { return 2; });
+
+  dc::whenAll(a.handle(), b.handle()).await();
+  ASSERT_TRUE(a.isReady());
+  ASSERT_TRUE(b.isReady());
+  ASSERT_EQ(a.get() + b.get(), 3);
+}
+
+DTEST(futureAwaitedInTask) {
+  dc::JobSystem js(2);
+  dc::Future<s32> future = js.submit([] { return 8; });
+
+  const s32 value = dc::syncAwait(
+      js, [](dc::Future<s32>& f) -> dc::Task<s32> {
+        co_await f.handle();
+        co_return f.get();
+      }(future));
+  ASSERT_EQ(value, 8);
+}
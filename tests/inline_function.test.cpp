@@ -0,0 +1,163 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dc/dtest.hpp>
+#include <dc/inline_function.hpp>
+#include <dc/traits.hpp>
+#include <memory>
+
+namespace {
+
+/// Counts live instances, to check that captures are destroyed exactly once.
+struct InstanceCounter {
+  explicit InstanceCounter(s32* counter) : live(counter) { ++*live; }
+  InstanceCounter(InstanceCounter&& other) noexcept : live(other.live) {
+    ++*live;
+  }
+  InstanceCounter(const InstanceCounter&) = delete;
+  InstanceCounter& operator=(const InstanceCounter&) = delete;
+  InstanceCounter& operator=(InstanceCounter&&) = delete;
+  ~InstanceCounter() { --*live; }
+
+  s32* live;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / call
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(inlineFunctionDefaultIsEmpty) {
+  dc::InlineFunction<void()> fn;
+  ASSERT_TRUE(fn.isEmpty());
+  ASSERT_FALSE(static_cast<bool>(fn));
+}
+
+DTEST(inlineFunctionCallsLambda) {
+  s32 calls = 0;
+  dc::InlineFunction<void()> fn = [&calls] { ++calls; };
+  ASSERT_FALSE(fn.isEmpty());
+
+  fn();
+  fn();
+  ASSERT_EQ(calls, 2);
+}
+
+DTEST(inlineFunctionArgumentsAndReturnValue) {
+  dc::InlineFunction<s32(s32, s32), 16> add = [bias = 100](s32 a, s32 b) {
+    return a + b + bias;
+  };
+  ASSERT_EQ(add(1, 2), 103);
+}
+
+DTEST(inlineFunctionFunctionPointer) {
+  struct Local {
+    static s32 twice(s32 x) { return x * 2; }
+  };
+  dc::InlineFunction<s32(s32), 8> fn = &Local::twice;
+  ASSERT_EQ(fn(21), 42);
+}
+
+DTEST(inlineFunctionMoveOnlyCapture) {
+  auto value = std::make_unique<s32>(7);
+  dc::InlineFunction<s32()> fn = [value = dc::move(value)] { return *value; };
+  ASSERT_EQ(fn(), 7);
+}
+
+DTEST(inlineFunctionMutableState) {
+  dc::InlineFunction<s32()> counter = [n = 0]() mutable { return ++n; };
+  ASSERT_EQ(counter(), 1);
+  ASSERT_EQ(counter(), 2);
+  ASSERT_EQ(counter(), 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Move / lifetime
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(inlineFunctionMoveConstructEmptiesSource) {
+  s32 calls = 0;
+  dc::InlineFunction<void()> a = [&calls] { ++calls; };
+  dc::InlineFunction<void()> b(dc::move(a));
+
+  ASSERT_TRUE(a.isEmpty());
+  ASSERT_FALSE(b.isEmpty());
+  b();
+  ASSERT_EQ(calls, 1);
+}
+
+DTEST(inlineFunctionMoveAssignDestroysOldCallable) {
+  s32 live = 0;
+  {
+    dc::InlineFunction<void()> a = [c = InstanceCounter(&live)] {};
+    dc::InlineFunction<void()> b = [c = InstanceCounter(&live)] {};
+    ASSERT_EQ(live, 2);
+
+    a = dc::move(b);
+    ASSERT_EQ(live, 1);
+    ASSERT_TRUE(b.isEmpty());
+  }
+  ASSERT_EQ(live, 0);
+}
+
+DTEST(inlineFunctionResetDestroysCallable) {
+  s32 live = 0;
+  dc::InlineFunction<void()> fn = [c = InstanceCounter(&live)] {};
+  ASSERT_EQ(live, 1);
+
+  fn.reset();
+  ASSERT_EQ(live, 0);
+  ASSERT_TRUE(fn.isEmpty());
+
+  fn.reset();
+  ASSERT_EQ(live, 0);
+}
+
+DTEST(inlineFunctionMoveChainKeepsSingleInstance) {
+  s32 live = 0;
+  {
+    dc::InlineFunction<void()> a = [c = InstanceCounter(&live)] {};
+    dc::InlineFunction<void()> b(dc::move(a));
+    dc::InlineFunction<void()> c;
+    c = dc::move(b);
+    ASSERT_EQ(live, 1);
+  }
+  ASSERT_EQ(live, 0);
+}
+
+DTEST(inlineFunctionFitsCapacityExactly) {
+  struct Payload {
+    u64 values[6];
+  };
+  Payload payload{{1, 2, 3, 4, 5, 6}};
+  dc::InlineFunction<u64(), 48> sum = [payload] {
+    u64 total = 0;
+    for (u64 v : payload.values) total += v;
+    return total;
+  };
+  ASSERT_EQ(sum(), 21u);
+  ASSERT_TRUE(sizeof(sum) <= 48 + sizeof(void*));
+}
@@ -23,14 +23,30 @@
  */
 
 #include <atomic>
+#include <chrono>
+#include <dc/cpu_topology.hpp>
 #include <dc/dtest.hpp>
 #include <dc/job_system.hpp>
 #include <dc/list.hpp>
 #include <dc/spsc_ring.hpp>
 #include <dc/time.hpp>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// Config for a JobSystem with threadCount workers. Tests set the policy they
+/// exercise on it.
+dc::JobSystemConfig threadConfig(u32 threadCount) {
+  dc::JobSystemConfig config;
+  config.threadCount = threadCount;
+  return config;
+}
+
+}  // namespace
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // SpscRing tests
@@ -201,7 +217,7 @@ DTEST(jobSystemShutdownDrainsWorkerRings) {
 
 DTEST(jobSystemOverflowRingHandlesFullWorkerRings) {
   // Use a single worker with 1 worker thread and submit more jobs than fit in
-  // one ring (Worker::kRingCapacity = 1024). The overflow ring should handle
+  // one ring (WorkerLane::kRingCapacity = 1024). The overflow ring should handle
   // the excess.
   constexpr s32 kJobCount = 2048;
   std::atomic<s32> counter{0};
@@ -296,14 +312,10 @@ DTEST(jobHandleCopySharesCompletion) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 DTEST(jobBatchSpreadAcrossWorkers) {
-  // Verify that a large batch of jobs is spread evenly across all workers via
-  // the round-robin chunk dispatch. With 400 jobs and 4 workers the ideal share
-  // is exactly 100 jobs per worker. We allow a ±40% tolerance around that
-  // ideal (i.e. 60–140 jobs per worker) to accommodate OS scheduling jitter
-  // while still catching a broken scheduler that routes everything to one
-  // worker.
+  // A large batch runs on the workers, and on nothing else. How many jobs
+  // each worker runs is up to the stealing, so only the total is exact.
   constexpr u32 kWorkerCount = 4;
-  constexpr s32 kJobCount = 400;  // 100 per worker on average
+  constexpr s32 kJobCount = 400;
 
   dc::JobSystem js(kWorkerCount);
 
@@ -319,24 +331,2104 @@ DTEST(jobBatchSpreadAcrossWorkers) {
     }});
   }
 
+  // Poll rather than await, which would help with the jobs on this thread.
+  dc::JobHandle handle = js.add(jobs);
+  while (!handle.isDone()) dc::sleepMs(1);
+
+  std::scoped_lock lock(mapMutex);
+  ASSERT_TRUE(jobsPerThread.size() <= kWorkerCount);
+  ASSERT_TRUE(jobsPerThread.find(std::this_thread::get_id()) ==
+              jobsPerThread.end());
+
+  s32 total = 0;
+  for (const auto& [id, count] : jobsPerThread) total += count;
+  ASSERT_EQ(total, kJobCount);
+}
+
+DTEST(jobLargeMixedPriorityBatchRunsEveryJobOnce) {
+  // Large enough to fill the inboxes, so the bulk add spills some of each
+  // slice onto other workers and the overflow ring. Priorities come in runs
+  // of varying length, each run is bulk added to its own lane.
+  constexpr u32 kJobCount = 10000;
+
+  dc::JobSystem js(4);
+
+  std::vector<std::atomic<s32>> ran(kJobCount);
+  for (auto& r : ran) r.store(0, std::memory_order_relaxed);
+
+  dc::List<dc::Job> jobs;
+  for (u32 i = 0; i < kJobCount; ++i) {
+    const auto priority =
+        static_cast<dc::JobPriority>((i / (i % 7 + 1)) % dc::kJobPriorityCount);
+    jobs.add(dc::Job{[&ran, i] { ran[i].fetch_add(1); }, priority});
+  }
+
   dc::JobHandle handle = js.add(jobs);
   handle.await();
 
-  // Every worker thread must have received work — round-robin guarantees this
-  // as long as jobCount >= workerCount.
-  ASSERT_EQ(static_cast<u32>(jobsPerThread.size()), kWorkerCount);
+  for (u32 i = 0; i < kJobCount; ++i) ASSERT_EQ(ran[i].load(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Work stealing tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobSystemIdleWorkersStealNestedJobs) {
+  // A single job fans out into many children from inside a worker. They all
+  // land on that worker's deque, so the only way the other workers can take
+  // part is by stealing.
+  constexpr u32 kWorkerCount = 4;
+  constexpr s32 kChildCount = 64;
+
+  dc::JobSystem js(kWorkerCount);
+  std::atomic<s32> counter{0};
+  std::mutex mapMutex;
+  std::unordered_map<std::thread::id, s32> jobsPerThread;
+
+  js.add(dc::Job{[&js, &counter, &mapMutex, &jobsPerThread] {
+    for (s32 i = 0; i < kChildCount; ++i) {
+      js.add(dc::Job{[&counter, &mapMutex, &jobsPerThread] {
+        {
+          std::scoped_lock lock(mapMutex);
+          jobsPerThread[std::this_thread::get_id()]++;
+        }
+        // Long enough that the owner cannot drain its deque alone before the
+        // others wake up.
+        dc::sleepMs(2);
+        counter.fetch_add(1, std::memory_order_release);
+      }});
+    }
+  }});
+
+  ASSERT_TRUE(waitForCount(counter, kChildCount, 5000));
+  ASSERT_TRUE(js.stealCount() > 0u);
+  ASSERT_TRUE(jobsPerThread.size() > 1u);
+}
+
+DTEST(jobSystemStealCountPerWorkerSumsToTotal) {
+  constexpr u32 kWorkerCount = 3;
+  dc::JobSystem js(kWorkerCount);
+  std::atomic<s32> counter{0};
+
+  js.add(dc::Job{[&js, &counter] {
+    for (s32 i = 0; i < 32; ++i) {
+      js.add(dc::Job{[&counter] {
+        dc::sleepMs(1);
+        counter.fetch_add(1, std::memory_order_release);
+      }});
+    }
+  }});
+
+  ASSERT_TRUE(waitForCount(counter, 32, 5000));
+
+  u64 sum = 0;
+  for (u32 i = 0; i < js.workerCount(); ++i) {
+    sum += js.stealCount(i);
+  }
+  ASSERT_EQ(sum, js.stealCount());
+}
+
+DTEST(jobHandleAwaitNestedBatchFromWorker) {
+  // A batch submitted from inside a job goes onto the submitting worker's
+  // deque; the handle must still complete once every job has run.
+  dc::JobSystem js(4);
+  constexpr s32 kJobCount = 200;
+  std::atomic<s32> counter{0};
+  std::atomic<bool> nestedDone{false};
+
+  js.add(dc::Job{[&js, &counter, &nestedDone] {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < kJobCount; ++i) {
+      jobs.add(dc::Job{
+          [&counter] { counter.fetch_add(1, std::memory_order_release); }});
+    }
+    dc::JobHandle handle = js.add(jobs);
+    // Busy-wait without blocking the worker on the handle: the other workers
+    // steal and finish the batch.
+    while (!handle.isDone()) std::this_thread::yield();
+    nestedDone.store(true, std::memory_order_release);
+  }});
+
+  ASSERT_TRUE(waitForCount(counter, kJobCount, 5000));
+  for (s32 i = 0; i < 5000 && !nestedDone.load(std::memory_order_acquire);
+       ++i) {
+    dc::sleepMs(1);
+  }
+  ASSERT_TRUE(nestedDone.load(std::memory_order_acquire));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Multi-producer submission tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobSystemManyProducersSingleAndBatchAdd) {
+  // A dozen producers mixing single and batch submission, with enough jobs
+  // to spill over the inboxes into the overflow ring.
+  constexpr u32 kWorkerCount = 2;
+  constexpr s32 kProducers = 12;
+  constexpr s32 kSingles = 200;
+  constexpr s32 kBatches = 4;
+  constexpr s32 kBatchSize = 100;
+  constexpr s32 kTotal = kProducers * (kSingles + kBatches * kBatchSize);
+
+  dc::JobSystem js(kWorkerCount);
+  std::atomic<s32> counter{0};
+
+  std::thread producers[kProducers];
+  for (s32 t = 0; t < kProducers; ++t) {
+    producers[t] = std::thread([&js, &counter] {
+      for (s32 b = 0; b < kBatches; ++b) {
+        for (s32 i = 0; i < kSingles / kBatches; ++i) {
+          js.add(dc::Job{
+              [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+        }
+
+        dc::List<dc::Job> jobs;
+        for (s32 i = 0; i < kBatchSize; ++i) {
+          jobs.add(dc::Job{
+              [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+        }
+        js.add(jobs).await();
+      }
+    });
+  }
+
+  for (s32 t = 0; t < kProducers; ++t) {
+    producers[t].join();
+  }
+
+  ASSERT_TRUE(waitForCount(counter, kTotal, 5000));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Continuation / dependency tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobHandleDefaultIsDone) {
+  dc::JobHandle handle;
+  ASSERT_TRUE(handle.isDone());
+  handle.await();  // must not block
+}
+
+DTEST(jobHandleThenRunsAfterBatch) {
+  dc::JobSystem js(4);
+  constexpr s32 kJobCount = 64;
+  std::atomic<s32> counter{0};
+  std::atomic<s32> seenByContinuation{-1};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < kJobCount; ++i) {
+    jobs.add(dc::Job{[&counter] {
+      dc::sleepMs(1);
+      counter.fetch_add(1, std::memory_order_relaxed);
+    }});
+  }
+
+  dc::JobHandle next =
+      js.add(jobs).then(dc::Job{[&counter, &seenByContinuation] {
+        seenByContinuation.store(counter.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+      }});
+  next.await();
+
+  // The continuation must observe every job of the first stage.
+  ASSERT_EQ(seenByContinuation.load(std::memory_order_relaxed), kJobCount);
+}
+
+DTEST(jobHandleThenOnCompletedHandleRunsImmediately) {
+  dc::JobSystem js(2);
+  std::atomic<s32> counter{0};
+
+  dc::List<dc::Job> jobs;
+  jobs.add(
+      dc::Job{[&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+  dc::JobHandle first = js.add(jobs);
+  first.await();
+
+  first
+      .then(dc::Job{
+          [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }})
+      .await();
+
+  ASSERT_EQ(counter.load(std::memory_order_relaxed), 2);
+}
+
+DTEST(jobHandleThenBatchFansOut) {
+  dc::JobSystem js(4);
+  constexpr s32 kStageTwo = 100;
+  std::atomic<bool> stageOneDone{false};
+  std::atomic<s32> ranAfterStageOne{0};
+
+  dc::List<dc::Job> stageOne;
+  stageOne.add(dc::Job{[&stageOneDone] {
+    dc::sleepMs(5);
+    stageOneDone.store(true, std::memory_order_relaxed);
+  }});
+
+  dc::List<dc::Job> stageTwo;
+  for (s32 i = 0; i < kStageTwo; ++i) {
+    stageTwo.add(dc::Job{[&stageOneDone, &ranAfterStageOne] {
+      if (stageOneDone.load(std::memory_order_relaxed)) {
+        ranAfterStageOne.fetch_add(1, std::memory_order_relaxed);
+      }
+    }});
+  }
+
+  js.add(stageOne).then(stageTwo).await();
+
+  ASSERT_EQ(ranAfterStageOne.load(std::memory_order_relaxed), kStageTwo);
+}
+
+DTEST(jobHandleChainedStagesRunInOrder) {
+  dc::JobSystem js(4);
+  std::mutex orderMutex;
+  dc::List<s32> order;
+
+  auto record = [&orderMutex, &order](s32 stage) {
+    return dc::Job{[&orderMutex, &order, stage] {
+      std::scoped_lock lock(orderMutex);
+      order.add(stage);
+    }};
+  };
+
+  dc::List<dc::Job> first;
+  first.add(record(0));
+  js.add(first).then(record(1)).then(record(2)).then(record(3)).await();
+
+  ASSERT_EQ(order.getSize(), 4u);
+  for (s32 i = 0; i < 4; ++i) {
+    ASSERT_EQ(order[static_cast<u64>(i)], i);
+  }
+}
+
+DTEST(whenAllDiamondDependency) {
+  // a -> (b, c) -> d
+  dc::JobSystem js(4);
+  std::atomic<s32> b{0};
+  std::atomic<s32> c{0};
+  std::atomic<s32> sumSeenByD{-1};
+
+  dc::List<dc::Job> aJobs;
+  aJobs.add(dc::Job{[] { dc::sleepMs(2); }});
+  dc::JobHandle a = js.add(aJobs);
+
+  dc::JobHandle bHandle = a.then(dc::Job{[&b] {
+    dc::sleepMs(2);
+    b.store(1, std::memory_order_relaxed);
+  }});
+  dc::JobHandle cHandle = a.then(dc::Job{[&c] {
+    dc::sleepMs(4);
+    c.store(2, std::memory_order_relaxed);
+  }});
+
+  dc::whenAll(bHandle, cHandle)
+      .then(dc::Job{[&b, &c, &sumSeenByD] {
+        sumSeenByD.store(b.load(std::memory_order_relaxed) +
+                             c.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+      }})
+      .await();
+
+  ASSERT_EQ(sumSeenByD.load(std::memory_order_relaxed), 3);
+}
+
+DTEST(whenAllOfCompletedAndEmptyHandlesIsDone) {
+  dc::JobSystem js(2);
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[] {}});
+  dc::JobHandle done = js.add(jobs);
+  done.await();
+
+  dc::JobHandle joined = dc::whenAll(done, dc::JobHandle{});
+  ASSERT_TRUE(joined.isDone());
+
+  std::atomic<s32> counter{0};
+  joined
+      .then(dc::Job{
+          [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }})
+      .await();
+  ASSERT_EQ(counter.load(std::memory_order_relaxed), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Inline job storage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobAcceptsMoveOnlyCapture) {
+  dc::JobSystem js(2);
+  std::atomic<s32> result{0};
+
+  dc::List<dc::Job> jobs;
+  auto value = std::make_unique<s32>(42);
+  jobs.add(dc::Job{[value = dc::move(value), &result] {
+    result.store(*value, std::memory_order_relaxed);
+  }});
+  js.add(jobs).await();
+
+  ASSERT_EQ(result.load(std::memory_order_relaxed), 42);
+}
+
+DTEST(jobBatchDestroysCapturesAfterRunning) {
+  dc::JobSystem js(4);
+  auto shared = std::make_shared<s32>(0);
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 100; ++i) {
+    jobs.add(dc::Job{[shared] { (void)shared; }});
+  }
+  js.add(jobs).await();
+
+  // Jobs are released back to their pool before the next one is picked up,
+  // so give the last worker a moment to drop its capture.
+  for (s32 i = 0; i < 100 && shared.use_count() > 1; ++i) dc::sleepMs(1);
+  ASSERT_EQ(shared.use_count(), 1);
+}
+
+DTEST(jobBatchCounterLivesUntilDone) {
+  std::shared_ptr<dc::JobCounter> counter = dc::JobCounter::makeBatch(3);
+  const std::weak_ptr<dc::JobCounter> weak = counter;
+  dc::JobCounter* const jobs = counter->jobRef().get();
+  counter.reset();
+
+  jobs->decrement(2);
+  ASSERT_FALSE(weak.expired());
+  jobs->decrement();
+  ASSERT_TRUE(weak.expired());
+}
+
+DTEST(jobBatchWithoutHandleRunsEveryJob) {
+  std::atomic<s32> ran{0};
+  {
+    dc::JobSystem js(4);
+    for (s32 round = 0; round < 10; ++round) {
+      dc::List<dc::Job> jobs;
+      for (s32 i = 0; i < 1000; ++i) {
+        jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+      }
+      // The handle is dropped right away, the batch keeps its counter.
+      [[maybe_unused]] const dc::JobHandle handle = js.add(jobs);
+    }
+  }
+  ASSERT_EQ(ran.load(), 10'000);
+}
+
+DTEST(jobContinuationBatchWithoutHandleRunsEveryJob) {
+  // A worker runs the first continuation while it helps, then stays busy. The
+  // other worker runs the rest and drops the last job that owns the counter,
+  // which must not leave a count behind on it.
+  std::atomic<s32> ran{0};
+  {
+    dc::JobSystem js(2);
+    for (s32 round = 0; round < 20; ++round) {
+      dc::List<dc::Job> outer;
+      outer.add(dc::Job{[&js, &ran] {
+        auto started = std::make_shared<dc::JobCounter>(1u, &js);
+        auto claimed = std::make_shared<std::atomic<bool>>(false);
+
+        dc::List<dc::Job> first;
+        first.add(dc::Job{[] {}});
+        dc::List<dc::Job> next;
+        for (s32 i = 0; i < 8; ++i) {
+          next.add(dc::Job{[&ran, started, claimed] {
+            if (!claimed->exchange(true)) started->decrement();
+            ran.fetch_add(1);
+          }});
+        }
+        [[maybe_unused]] const dc::JobHandle handle = js.add(first).then(next);
+
+        dc::JobHandle{started}.await();
+        dc::sleepMs(5);
+      }});
+      [[maybe_unused]] const dc::JobHandle handle = js.add(outer);
+      while (ran.load() < (round + 1) * 8) dc::sleepMs(1);
+    }
+  }
+  ASSERT_EQ(ran.load(), 160);
+}
+
+DTEST(jobNestedBatchesCountedOnEveryWorker) {
+  dc::JobSystem js(4);
+  std::atomic<s32> ran{0};
+
+  dc::List<dc::Job> outer;
+  for (s32 i = 0; i < 16; ++i) {
+    outer.add(dc::Job{[&js, &ran] {
+      dc::List<dc::Job> inner;
+      for (s32 j = 0; j < 500; ++j) {
+        inner.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+      }
+      js.add(inner).await();
+    }});
+  }
+  js.add(outer).await();
+
+  ASSERT_EQ(ran.load(), 16 * 500);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Idle policy
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobSystemConfigThreadCount) {
+  dc::JobSystemConfig config;
+  config.threadCount = 3;
+  dc::JobSystem js(config);
+  ASSERT_EQ(js.workerCount(), 3u);
+}
+
+DTEST(jobSystemParkImmediatelyPolicy) {
+  // No spinning or yielding, every idle worker parks straight away, so every
+  // add below has to wake a parked worker.
+  dc::JobSystemConfig config;
+  config.threadCount = 4;
+  config.idle = dc::IdlePolicy{.spinCount = 0, .yieldCount = 0};
+  dc::JobSystem js(config);
+
+  std::atomic<s32> counter{0};
+  for (s32 round = 0; round < 50; ++round) {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 8; ++i) {
+      jobs.add(dc::Job{
+          [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+    }
+    js.add(jobs).await();
+    // Let the workers park again before the next round.
+    if (round % 10 == 0) dc::sleepMs(1);
+  }
+
+  ASSERT_EQ(counter.load(std::memory_order_relaxed), 400);
+}
+
+DTEST(jobSystemLongSpinPolicy) {
+  dc::JobSystemConfig config;
+  config.threadCount = 2;
+  config.idle = dc::IdlePolicy{.spinCount = 100'000, .yieldCount = 100};
+  dc::JobSystem js(config);
+
+  std::atomic<s32> counter{0};
+  for (s32 round = 0; round < 100; ++round) {
+    dc::List<dc::Job> jobs;
+    jobs.add(dc::Job{
+        [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+    js.add(jobs).await();
+  }
+
+  ASSERT_EQ(counter.load(std::memory_order_relaxed), 100);
+}
+
+DTEST(jobSystemShutdownWakesParkedWorkers) {
+  dc::JobSystemConfig config;
+  config.threadCount = 4;
+  config.idle = dc::IdlePolicy{.spinCount = 0, .yieldCount = 0};
+  {
+    dc::JobSystem js(config);
+    // Give the workers time to park.
+    dc::sleepMs(10);
+  }
+  // Reaching this point means the destructor joined every parked worker.
+  ASSERT_TRUE(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helping await
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobAwaitNestedBatchOnSingleWorker) {
+  // With one worker, a job that awaits a nested batch can only make progress
+  // if await runs the nested jobs itself.
+  dc::JobSystem js(1);
+  std::atomic<s32> inner{0};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&js, &inner] {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 16; ++i) {
+      jobs.add(dc::Job{
+          [&inner] { inner.fetch_add(1, std::memory_order_relaxed); }});
+    }
+    js.add(jobs).await();
+  }});
+  js.add(outer).await();
+
+  ASSERT_EQ(inner.load(std::memory_order_relaxed), 16);
+}
+
+DTEST(jobAwaitDeeplyNestedFromEveryWorker) {
+  // Every worker blocks in a nested await at the same time. Without helping
+  // all of them would wait on jobs that sit in their own deques.
+  constexpr u32 kWorkers = 4;
+  dc::JobSystem js(kWorkers);
+  std::atomic<s32> leaves{0};
+
+  dc::List<dc::Job> outer;
+  for (u32 i = 0; i < kWorkers * 2; ++i) {
+    outer.add(dc::Job{[&js, &leaves] {
+      dc::List<dc::Job> middle;
+      for (s32 j = 0; j < 4; ++j) {
+        middle.add(dc::Job{[&js, &leaves] {
+          dc::List<dc::Job> inner;
+          for (s32 k = 0; k < 4; ++k) {
+            inner.add(dc::Job{
+                [&leaves] { leaves.fetch_add(1, std::memory_order_relaxed); }});
+          }
+          js.add(inner).await();
+        }});
+      }
+      js.add(middle).await();
+    }});
+  }
+  js.add(outer).await();
+
+  ASSERT_EQ(leaves.load(std::memory_order_relaxed),
+            static_cast<s32>(kWorkers * 2 * 4 * 4));
+}
+
+DTEST(jobAwaitFromOutsideHelpsRunJobs) {
+  // The awaiting thread steals from the workers' deques, so it should end up
+  // running some of the jobs when the only worker is busy.
+  dc::JobSystem js(1);
+  const std::thread::id self = std::this_thread::get_id();
+  std::atomic<s32> ranOnCaller{0};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&js, &ranOnCaller, self] {
+    // Spawned from the worker, so they land on its deque where the external
+    // thread can steal them.
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 64; ++i) {
+      jobs.add(dc::Job{[&ranOnCaller, self] {
+        if (std::this_thread::get_id() == self) {
+          ranOnCaller.fetch_add(1, std::memory_order_relaxed);
+        }
+        dc::sleepMs(1);
+      }});
+    }
+    dc::JobHandle handle = js.add(jobs);
+    // Keep the worker busy so that the caller gets to the deque first.
+    dc::sleepMs(20);
+    handle.await();
+  }});
+  js.add(outer).await();
+
+  ASSERT_TRUE(ranOnCaller.load(std::memory_order_relaxed) > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Priority lanes
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Occupies the only worker of a JobSystem until released, so that tests can
+/// queue up jobs behind it.
+struct WorkerGate {
+  explicit WorkerGate(dc::JobSystem& js) {
+    js.add(dc::Job{[this] {
+      started.store(true, std::memory_order_release);
+      while (!released.load(std::memory_order_acquire)) dc::sleepMs(1);
+    }});
+    while (!started.load(std::memory_order_acquire)) dc::sleepMs(1);
+  }
+
+  void release() { released.store(true, std::memory_order_release); }
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> released{false};
+};
+
+/// Wait for the handle without helping, so that every job runs on the worker
+/// and in the order it picks them.
+void awaitWithoutHelping(const dc::JobHandle& handle) {
+  while (!handle.isDone()) dc::sleepMs(1);
+}
+
+}  // namespace
+
+DTEST(jobPriorityHighRunsBeforeQueuedWork) {
+  dc::JobSystem js(1);
+  std::mutex orderMutex;
+  dc::List<s32> order;
+
+  WorkerGate gate(js);
 
-  const s32 idealPerWorker = kJobCount / static_cast<s32>(kWorkerCount);
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 8; ++i) {
+    jobs.add(dc::Job{[&orderMutex, &order] {
+                       std::scoped_lock lock(orderMutex);
+                       order.add(2);
+                     },
+                     dc::JobPriority::Background});
+    jobs.add(dc::Job{[&orderMutex, &order] {
+      std::scoped_lock lock(orderMutex);
+      order.add(1);
+    }});
+  }
+  jobs.add(dc::Job{[&orderMutex, &order] {
+                     std::scoped_lock lock(orderMutex);
+                     order.add(0);
+                   },
+                   dc::JobPriority::High});
+  dc::JobHandle handle = js.add(jobs);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+
+  // The high priority job was queued last but runs first, then all the
+  // normal jobs, then the background ones.
+  ASSERT_EQ(order.getSize(), 17u);
+  ASSERT_EQ(order[0], 0);
+  for (u64 i = 1; i < 9; ++i) ASSERT_EQ(order[i], 1);
+  for (u64 i = 9; i < 17; ++i) ASSERT_EQ(order[i], 2);
+}
+
+DTEST(jobPriorityBackgroundQuotaPreventsStarvation) {
+  constexpr u32 kQuota = 4;
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backgroundQuota = kQuota;
+  dc::JobSystem js(config);
+  std::atomic<s32> ran{0};
+  std::atomic<s32> backgroundRanAt{-1};
+
+  WorkerGate gate(js);
+
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[&ran, &backgroundRanAt] {
+                     backgroundRanAt.store(ran.fetch_add(1));
+                   },
+                   dc::JobPriority::Background});
+  for (s32 i = 0; i < 100; ++i) {
+    jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+  }
+  dc::JobHandle handle = js.add(jobs);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+
+  // The gate counts as the first job, so the background job is due after
+  // kQuota - 1 normal ones.
+  ASSERT_TRUE(backgroundRanAt.load() >= 0);
+  ASSERT_TRUE(backgroundRanAt.load() <= static_cast<s32>(kQuota));
+}
 
-  // No single worker should exceed 140% of the ideal share.
-  const s32 maxAllowed = idealPerWorker * 14 / 10;
-  for (const auto& [id, count] : jobsPerThread) {
-    ASSERT_TRUE(count <= maxAllowed);
+DTEST(jobPriorityZeroQuotaRunsBackgroundLast) {
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backgroundQuota = 0;
+  dc::JobSystem js(config);
+  std::atomic<s32> ran{0};
+  std::atomic<s32> backgroundRanAt{-1};
+
+  WorkerGate gate(js);
+
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[&ran, &backgroundRanAt] {
+                     backgroundRanAt.store(ran.fetch_add(1));
+                   },
+                   dc::JobPriority::Background});
+  for (s32 i = 0; i < 50; ++i) {
+    jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
   }
+  dc::JobHandle handle = js.add(jobs);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+
+  ASSERT_EQ(backgroundRanAt.load(), 50);
+}
+
+DTEST(jobPriorityKeptByContinuation) {
+  dc::JobSystem js(1);
+  std::atomic<s32> ran{0};
+  std::atomic<s32> continuationRanAt{-1};
 
-  // Each worker must receive at least 60% of the ideal share.
-  const s32 minRequired = idealPerWorker * 6 / 10;
-  for (const auto& [id, count] : jobsPerThread) {
-    ASSERT_TRUE(count >= minRequired);
+  WorkerGate gate(js);
+
+  // The continuation is released while normal jobs are still queued, and
+  // must jump ahead of them.
+  dc::List<dc::Job> first;
+  first.add(dc::Job{[&ran] { ran.fetch_add(1); }, dc::JobPriority::High});
+  dc::JobHandle continuation =
+      js.add(first).then(dc::Job{[&ran, &continuationRanAt] {
+                                   continuationRanAt.store(ran.fetch_add(1));
+                                 },
+                                 dc::JobPriority::High});
+
+  dc::List<dc::Job> rest;
+  for (s32 i = 0; i < 20; ++i) {
+    rest.add(dc::Job{[&ran] { ran.fetch_add(1); }});
   }
+  dc::JobHandle restHandle = js.add(rest);
+
+  gate.release();
+  awaitWithoutHelping(continuation);
+  awaitWithoutHelping(restHandle);
+
+  ASSERT_EQ(continuationRanAt.load(), 1);
+}
+
+DTEST(jobBatchDoneBeforeWorkerMovesOn) {
+  // The worker counts the jobs of a batch down together, but not while it
+  // runs a job of another batch.
+  dc::JobSystem js(1);
+  std::atomic<bool> sawDone{false};
+
+  WorkerGate gate(js);
+
+  dc::List<dc::Job> first;
+  for (s32 i = 0; i < 10; ++i) {
+    first.add(dc::Job{[] {}, dc::JobPriority::High});
+  }
+  dc::JobHandle handle = js.add(first);
+
+  dc::List<dc::Job> next;
+  next.add(dc::Job{[&handle, &sawDone] {
+    for (s32 i = 0; i < 2000 && !handle.isDone(); ++i) dc::sleepMs(1);
+    sawDone.store(handle.isDone());
+  }});
+  dc::JobHandle nextHandle = js.add(next);
+
+  gate.release();
+  awaitWithoutHelping(nextHandle);
+
+  ASSERT_TRUE(sawDone.load());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Worker affinity
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobAffinityPhysicalCoreOneWorkerPerCore) {
+  const dc::CpuTopology topology = dc::queryCpuTopology();
+
+  dc::JobSystemConfig config;
+  config.affinity = dc::WorkerAffinity::PhysicalCore;
+  dc::JobSystem js(config);
+
+  ASSERT_EQ(js.workerCount(), topology.coreCount());
+  for (u32 i = 0; i < js.workerCount(); ++i) {
+    ASSERT_TRUE(js.workerNode(i) < topology.nodeCount);
+  }
+}
+
+DTEST(jobAffinityMoreWorkersThanCpus) {
+  // Workers beyond the CPU count wrap around and share CPUs, which must not
+  // keep the stealing and nested awaits from working.
+  const dc::CpuTopology topology = dc::queryCpuTopology();
+
+  dc::JobSystemConfig config;
+  config.threadCount = topology.logicalCpuCount() * 2 + 1;
+  config.affinity = dc::WorkerAffinity::LogicalCpu;
+  dc::JobSystem js(config);
+
+  std::atomic<s32> counter{0};
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 64; ++i) {
+    jobs.add(dc::Job{[&js, &counter] {
+      dc::List<dc::Job> inner;
+      for (s32 j = 0; j < 16; ++j) {
+        inner.add(dc::Job{
+            [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+      }
+      js.add(inner).await();
+    }});
+  }
+  js.add(jobs).await();
+
+  ASSERT_EQ(counter.load(std::memory_order_relaxed), 64 * 16);
+}
+
+DTEST(jobAffinityUnpinnedWorkersOnNodeZero) {
+  dc::JobSystem js(3);
+  for (u32 i = 0; i < js.workerCount(); ++i) {
+    ASSERT_EQ(js.workerNode(i), 0u);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stats and tracing
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+u64 totalJobsRun(const dc::JobSystemStats& stats) {
+  u64 total = stats.externalJobsRun;
+  for (const dc::WorkerStats& worker : stats.workers) total += worker.jobsRun;
+  return total;
+}
+
+/// A job is counted just after it completes its batch, so give the counters a
+/// moment to catch up with an awaited batch.
+dc::JobSystemStats statsOnceRun(const dc::JobSystem& js, u64 jobCount) {
+  dc::JobSystemStats stats = js.stats();
+  for (s32 i = 0; i < 1000 && totalJobsRun(stats) < jobCount; ++i) {
+    dc::sleepMs(1);
+    stats = js.stats();
+  }
+  return stats;
+}
+
+}  // namespace
+
+DTEST(jobStatsCountJobsRun) {
+  dc::JobSystem js(4);
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 1000; ++i) jobs.add(dc::Job{[] {}});
+  js.add(jobs).await();
+
+  const dc::JobSystemStats stats = statsOnceRun(js, 1000);
+  ASSERT_EQ(stats.workers.getSize(), 4u);
+  ASSERT_EQ(totalJobsRun(stats), 1000u);
+  ASSERT_EQ(stats.overflowPushes, 0u);
+
+  u64 stolen = 0;
+  for (const dc::WorkerStats& worker : stats.workers) {
+    stolen += worker.jobsStolen;
+    ASSERT_TRUE(worker.inboxHighWater <= dc::WorkerLane::kRingCapacity);
+  }
+  ASSERT_EQ(stolen, js.stealCount());
+}
+
+DTEST(jobStatsOverflowAndHighWater) {
+  dc::JobSystem js(1);
+  constexpr u32 kExtra = 100;
+
+  WorkerGate gate(js);
+
+  // Fill the only inbox while the worker is held up, the rest spills.
+  dc::List<dc::Job> jobs;
+  for (u32 i = 0; i < dc::WorkerLane::kRingCapacity + kExtra; ++i) {
+    jobs.add(dc::Job{[] {}});
+  }
+  dc::JobHandle handle = js.add(jobs);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+
+  const dc::JobSystemStats stats = js.stats();
+  ASSERT_EQ(stats.overflowPushes, u64{kExtra});
+  ASSERT_EQ(stats.workers[0].inboxHighWater, dc::WorkerLane::kRingCapacity);
+}
+
+DTEST(jobInjectedJobsFromManyProducersAllRun) {
+  // Producers race to spill into the injection queue while the only worker
+  // is held up. Once it is released every job runs, with no further add()
+  // to push them along.
+  constexpr s32 kProducers = 4;
+  constexpr s32 kJobsPerProducer = 2000;
+
+  dc::JobSystem js(1);
+  std::atomic<s32> ran{0};
+
+  WorkerGate gate(js);
+
+  std::vector<std::thread> producers;
+  for (s32 p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&js, &ran] {
+      for (s32 i = 0; i < kJobsPerProducer; ++i) {
+        js.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+      }
+    });
+  }
+  for (std::thread& producer : producers) producer.join();
+
+  const s32 total = kProducers * kJobsPerProducer;
+  ASSERT_EQ(js.stats().overflowPushes,
+            static_cast<u64>(total) - dc::WorkerLane::kRingCapacity);
+
+  gate.release();
+  ASSERT_TRUE(waitForCount(ran, total, 5000));
+}
+
+DTEST(jobInjectedRunsUnderSteadyLoad) {
+  // Every job in the inbox queues another one until stopped, so the only
+  // worker never runs out of its own work. The job that spilled over the
+  // inbox still gets its turn.
+  std::atomic<bool> stop{false};
+  std::atomic<s32> injectedRan{0};
+  dc::JobSystem js(1);
+
+  struct Feeder {
+    static void run(dc::JobSystem& js, std::atomic<bool>& stop) {
+      if (stop.load()) return;
+      js.add(dc::Job{[&js, &stop] { run(js, stop); }});
+    }
+  };
+
+  WorkerGate gate(js);
+  for (u32 i = 0; i < dc::WorkerLane::kRingCapacity; ++i) {
+    js.add(dc::Job{[&js, &stop] { Feeder::run(js, stop); }});
+  }
+  js.add(dc::Job{[&injectedRan] { injectedRan.store(1); }});
+  ASSERT_EQ(js.stats().overflowPushes, 1u);
+
+  gate.release();
+  const bool ran = waitForCount(injectedRan, 1);
+  stop.store(true);
+  ASSERT_TRUE(ran);
+}
+
+DTEST(jobInjectedHighRunsBeforeQueuedNormal) {
+  dc::JobSystem js(1);
+  std::atomic<s32> normalRan{0};
+  std::atomic<s32> normalBeforeInjected{-1};
+
+  WorkerGate gate(js);
+  for (u32 i = 0; i < dc::WorkerLane::kRingCapacity; ++i) {
+    js.add(dc::Job{[&normalRan] { normalRan.fetch_add(1); }});
+  }
+  // Fill the high lane inbox too, so that the last high job spills over.
+  for (u32 i = 0; i < dc::WorkerLane::kRingCapacity; ++i) {
+    js.add(dc::Job{[] {}, dc::JobPriority::High});
+  }
+  js.add(dc::Job{[&normalRan, &normalBeforeInjected] {
+                   normalBeforeInjected.store(normalRan.load());
+                 },
+                 dc::JobPriority::High});
+  ASSERT_EQ(js.stats().overflowPushes, 1u);
+
+  gate.release();
+  ASSERT_TRUE(waitForCount(normalRan,
+                           static_cast<s32>(dc::WorkerLane::kRingCapacity)));
+  ASSERT_EQ(normalBeforeInjected.load(), 0);
+}
+
+DTEST(jobStatsParkedAndWokenUp) {
+  dc::JobSystemConfig config;
+  config.threadCount = 1;
+  config.idle = dc::IdlePolicy{.spinCount = 0, .yieldCount = 0};
+  dc::JobSystem js(config);
+
+  // Let the worker park, then wake it up.
+  dc::sleepMs(10);
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[] {}});
+  awaitWithoutHelping(js.add(jobs));
+
+  const dc::JobSystemStats stats = statsOnceRun(js, 1);
+  ASSERT_TRUE(stats.workers[0].wakeUps >= 1u);
+  ASSERT_TRUE(stats.workers[0].parkedNs > 0u);
+  ASSERT_TRUE(stats.workers[0].busyNs > 0u);
+}
+
+DTEST(jobTraceRecordsJobs) {
+  dc::JobSystemConfig config = threadConfig(1);
+  config.traceCapacity = 16;
+  dc::JobSystem js(config);
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 20; ++i) {
+    jobs.add(dc::Job{[] { dc::sleepMs(1); }, i % 2 == 0
+                                                  ? dc::JobPriority::High
+                                                  : dc::JobPriority::Normal});
+  }
+  awaitWithoutHelping(js.add(jobs));
+  const dc::JobSystemStats stats = statsOnceRun(js, 20);
+
+  // 16 fit, the last 4 are dropped.
+  ASSERT_EQ(stats.traceEventsDropped, 4u);
+
+  const dc::String trace = js.chromeTrace();
+  ASSERT_TRUE(trace.find("{\"traceEvents\":[").isSome());
+  ASSERT_TRUE(trace.endsWith('}'));
+  ASSERT_TRUE(trace.find("\"name\":\"worker 0\"").isSome());
+  ASSERT_TRUE(trace.find("\"cat\":\"high\"").isSome());
+
+  u32 events = 0;
+  u64 offset = 0;
+  while (auto found = trace.find("\"ph\":\"X\"", offset)) {
+    ++events;
+    offset = found.value() + 1;
+  }
+  ASSERT_EQ(events, 16u);
+}
+
+DTEST(jobTraceOffByDefault) {
+  dc::JobSystem js(2);
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[] {}});
+  js.add(jobs).await();
+
+  const dc::String trace = js.chromeTrace();
+  ASSERT_TRUE(trace.find("\"ph\":\"X\"").isNone());
+  ASSERT_EQ(js.stats().traceEventsDropped, 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fibers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Each job adds one child and waits for it, depth jobs deep.
+void nestedChain(dc::JobSystem& js, s32 depth, std::atomic<s32>& reached) {
+  reached.fetch_add(1, std::memory_order_relaxed);
+  if (depth == 0) return;
+
+  dc::List<dc::Job> child;
+  child.add(dc::Job{[&js, depth, &reached] {
+    nestedChain(js, depth - 1, reached);
+  }});
+  js.add(child).await();
+}
+
+}  // namespace
+
+#if DC_JOB_FIBERS
+DTEST(jobFiberWaitsDoNotNest) {
+  // The outer job waits for a child. Meanwhile the worker picks up the inner
+  // job, which waits for the outer job to finish. Waiting on the worker's own
+  // stack would run the inner job on top of the outer one, which then can
+  // never continue. A fiber is switched out instead.
+  dc::JobSystemConfig config = threadConfig(1);
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 16;
+  dc::JobSystem js(config);
+  auto gate = std::make_shared<dc::JobCounter>(1u, &js);
+  std::atomic<bool> outerStarted{false};
+  std::atomic<bool> innerQueued{false};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&js, gate, &outerStarted, &innerQueued] {
+    outerStarted.store(true);
+    while (!innerQueued.load()) dc::sleepMs(1);
+
+    // Background, so that the worker runs the high priority inner job first.
+    dc::List<dc::Job> child;
+    child.add(dc::Job{[] {}, dc::JobPriority::Background});
+    js.add(child).await();
+    gate->decrement();
+  }});
+  dc::JobHandle outerHandle = js.add(outer);
+  while (!outerStarted.load()) dc::sleepMs(1);
+
+  dc::List<dc::Job> inner;
+  inner.add(dc::Job{[gate] { dc::JobHandle{gate}.await(); },
+                    dc::JobPriority::High});
+  dc::JobHandle innerHandle = js.add(inner);
+  innerQueued.store(true);
+
+  awaitWithoutHelping(innerHandle);
+  awaitWithoutHelping(outerHandle);
+  ASSERT_TRUE(gate->isDone());
+}
+#endif
+
+DTEST(jobFiberDeepChain) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 256;
+  dc::JobSystem js(config);
+  std::atomic<s32> reached{0};
+
+  dc::List<dc::Job> root;
+  root.add(dc::Job{[&js, &reached] { nestedChain(js, 100, reached); }});
+  js.add(root).await();
+
+  ASSERT_EQ(reached.load(), 101);
+}
+
+DTEST(jobFiberPoolExhausted) {
+  // Far more waiting jobs than fibers. The rest run on the workers' stacks.
+  dc::JobSystemConfig config = threadConfig(2);
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 2;
+  dc::JobSystem js(config);
+  std::atomic<s32> counter{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 64; ++i) {
+    jobs.add(dc::Job{[&js, &counter] {
+      dc::List<dc::Job> inner;
+      for (s32 j = 0; j < 8; ++j) {
+        inner.add(dc::Job{
+            [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }});
+      }
+      js.add(inner).await();
+    }});
+  }
+  js.add(jobs).await();
+
+  ASSERT_EQ(counter.load(), 64 * 8);
+}
+
+DTEST(jobFiberStatsAndTrace) {
+  // A job that waits is switched out and may finish on another worker, it
+  // must still be counted and traced. Resuming it counts as a job too.
+  dc::JobSystemConfig config = threadConfig(3);
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 64;
+  config.traceCapacity = 1024;
+  dc::JobSystem js(config);
+  std::atomic<s32> reached{0};
+
+  dc::List<dc::Job> roots;
+  for (s32 i = 0; i < 8; ++i) {
+    roots.add(dc::Job{[&js, &reached] { nestedChain(js, 10, reached); }});
+  }
+  awaitWithoutHelping(js.add(roots));
+
+  const dc::JobSystemStats stats = statsOnceRun(js, 8 * 11);
+  ASSERT_TRUE(totalJobsRun(stats) >= u64{8 * 11});
+  ASSERT_EQ(stats.externalJobsRun, 0u);
+  ASSERT_EQ(stats.traceEventsDropped, 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobAddAfterWaitsForDelay) {
+  dc::JobSystem js(2);
+  dc::JobCounter done(1);
+  std::atomic<u64> ranAtNs{0};
+
+  const u64 startNs = dc::getTimeNs();
+  const dc::TimerId id =
+      js.addAfter(std::chrono::milliseconds(20), dc::Job{[&done, &ranAtNs] {
+                    ranAtNs.store(dc::getTimeNs());
+                    done.decrement();
+                  }});
+  ASSERT_TRUE(id.isValid());
+
+  done.wait();
+  ASSERT_TRUE(ranAtNs.load() - startNs >= 20'000'000u);
+  ASSERT_FALSE(js.cancelTimer(id));
+}
+
+DTEST(jobAddAtRunsInDeadlineOrder) {
+  dc::JobSystem js(1);
+  dc::JobCounter done(4);
+  std::mutex orderMutex;
+  std::vector<s32> order;
+
+  const u64 nowNs = dc::getTimeNs();
+  const u64 offsetsMs[] = {40, 10, 30, 20};
+  const s32 tags[] = {3, 0, 2, 1};
+  for (s32 i = 0; i < 4; ++i) {
+    js.addAt(nowNs + offsetsMs[i] * 1'000'000,
+             dc::Job{[&done, &orderMutex, &order, tag = tags[i]] {
+               {
+                 std::scoped_lock lock(orderMutex);
+                 order.push_back(tag);
+               }
+               done.decrement();
+             }});
+  }
+
+  done.wait();
+  ASSERT_EQ(order.size(), 4u);
+  for (s32 i = 0; i < 4; ++i) ASSERT_EQ(order[static_cast<usize>(i)], i);
+}
+
+DTEST(jobAddAtPastDeadlineRunsRightAway) {
+  dc::JobSystem js(2);
+  dc::JobCounter done(1);
+
+  js.addAt(0, dc::Job{[&done] { done.decrement(); }});
+  ASSERT_TRUE(done.waitFor(std::chrono::seconds(5)));
+}
+
+DTEST(jobCancelTimer) {
+  dc::JobSystem js(2);
+  std::atomic<bool> ran{false};
+
+  const dc::TimerId id = js.addAfter(std::chrono::milliseconds(30),
+                                     dc::Job{[&ran] { ran.store(true); }});
+  ASSERT_TRUE(js.cancelTimer(id));
+  ASSERT_FALSE(js.cancelTimer(id));
+
+  dc::sleepMs(60);
+  ASSERT_FALSE(ran.load());
+}
+
+DTEST(jobPeriodicRunsUntilCancelled) {
+  dc::JobSystem js(2);
+  std::atomic<s32> runs{0};
+
+  const dc::TimerId id = js.addPeriodic(
+      std::chrono::milliseconds(2), dc::Job{[&runs] { runs.fetch_add(1); }});
+  for (s32 i = 0; i < 5000 && runs.load() < 5; ++i) dc::sleepMs(1);
+  ASSERT_TRUE(runs.load() >= 5);
+
+  ASSERT_TRUE(js.cancelTimer(id));
+  // A run that had started when we cancelled may still finish.
+  dc::sleepMs(10);
+  const s32 runsAfterCancel = runs.load();
+  dc::sleepMs(20);
+  ASSERT_EQ(runs.load(), runsAfterCancel);
+}
+
+DTEST(jobTimerWakesParkedWorkers) {
+  // Every worker parks before there is a timer to watch.
+  dc::JobSystemConfig config;
+  config.threadCount = 3;
+  config.idle.spinCount = 0;
+  config.idle.yieldCount = 0;
+  dc::JobSystem js(config);
+  dc::sleepMs(20);
+
+  dc::JobCounter done(2);
+  js.addAfter(std::chrono::milliseconds(5),
+              dc::Job{[&done] { done.decrement(); }});
+  js.addAfter(std::chrono::milliseconds(30),
+              dc::Job{[&done] { done.decrement(); }});
+  ASSERT_TRUE(done.waitFor(std::chrono::seconds(5)));
+}
+
+DTEST(jobTimerAddedFromJob) {
+  dc::JobSystem js(2);
+  dc::JobCounter done(1);
+
+  js.add(dc::Job{[&js, &done] {
+    js.addAfter(std::chrono::milliseconds(5),
+                dc::Job{[&done] { done.decrement(); }});
+  }});
+  ASSERT_TRUE(done.waitFor(std::chrono::seconds(5)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Elastic pool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Submit jobs that take a while each, from outside the pool, and wait for
+/// them. Returns the most workers seen running meanwhile.
+u32 runLoad(dc::JobSystem& js, s32 jobCount) {
+  std::atomic<u32> mostActive{0};
+  std::atomic<s32> ran{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < jobCount; ++i) {
+    jobs.add(dc::Job{[&js, &mostActive, &ran] {
+      const u64 endNs = dc::getTimeNs() + 100'000;
+      while (dc::getTimeNs() < endNs) {
+      }
+      u32 most = mostActive.load();
+      const u32 active = js.activeWorkerCount();
+      while (active > most && !mostActive.compare_exchange_weak(most, active)) {
+      }
+      ran.fetch_add(1);
+    }});
+  }
+  dc::JobHandle handle = js.add(jobs);
+  handle.await();
+
+  return ran.load() == jobCount ? mostActive.load() : 0;
+}
+
+/// Wait up to 5 seconds for the pool to shrink to the count.
+bool waitForActive(const dc::JobSystem& js, u32 count) {
+  for (s32 i = 0; i < 5000 && js.activeWorkerCount() != count; ++i) {
+    dc::sleepMs(1);
+  }
+  return js.activeWorkerCount() == count;
+}
+
+}  // namespace
+
+DTEST(jobElasticStartsAtMinimum) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 1;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+  ASSERT_EQ(js.workerCount(), 4u);
+  ASSERT_EQ(js.activeWorkerCount(), 1u);
+
+  dc::JobCounter done(1);
+  js.add(dc::Job{[&done] { done.decrement(); }});
+  ASSERT_TRUE(done.waitFor(std::chrono::seconds(5)));
+}
+
+DTEST(jobElasticMinimumOfAllIsFixed) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 4;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+  ASSERT_EQ(js.activeWorkerCount(), 4u);
+}
+
+DTEST(jobElasticGrowsUnderLoad) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 1;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+
+  const u32 mostActive = runLoad(js, 400);
+  ASSERT_TRUE(mostActive > 1u);
+  ASSERT_TRUE(js.activeWorkerCount() <= js.workerCount());
+}
+
+DTEST(jobElasticShrinksWhenIdleAndGrowsAgain) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 1;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+
+  for (s32 round = 0; round < 3; ++round) {
+    ASSERT_TRUE(runLoad(js, 400) > 1u);
+    ASSERT_TRUE(waitForActive(js, 1));
+  }
+}
+
+DTEST(jobElasticStaysAboveMinimum) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 2;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+  ASSERT_TRUE(runLoad(js, 400) > 0u);
+  ASSERT_TRUE(waitForActive(js, 2));
+
+  // Idle well past shrinkAfter, nothing below the minimum retires.
+  dc::sleepMs(100);
+  ASSERT_EQ(js.activeWorkerCount(), 2u);
+}
+
+DTEST(jobElasticSubmitWhileShrinking) {
+  // Submitters racing with workers that retire must not lose jobs.
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 1;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  config.elastic.shrinkAfter = std::chrono::nanoseconds(0);
+  config.idle.spinCount = 0;
+  config.idle.yieldCount = 0;
+  dc::JobSystem js(config);
+
+  std::atomic<s32> ran{0};
+  for (s32 round = 0; round < 200; ++round) {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 64; ++i) {
+      jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+    }
+    dc::JobHandle handle = js.add(jobs);
+    for (s32 i = 0; i < 16; ++i) js.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+    handle.await();
+  }
+
+  for (s32 i = 0; i < 5000 && ran.load() != 200 * 80; ++i) dc::sleepMs(1);
+  ASSERT_EQ(ran.load(), 200 * 80);
+}
+
+DTEST(jobElasticDestroyUnderLoad) {
+  for (s32 round = 0; round < 10; ++round) {
+    std::atomic<s32> ran{0};
+    {
+      dc::JobSystemConfig config = threadConfig(4);
+      config.elastic.minThreads = 1;
+      config.elastic.growQueueDepth = 8;
+      config.elastic.growAfter = std::chrono::nanoseconds(0);
+      config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+      config.elastic.shrinkAfter = std::chrono::milliseconds(1);
+      dc::JobSystem js(config);
+      for (s32 i = 0; i < 200; ++i) {
+        js.add(dc::Job{[&ran] {
+          const u64 endNs = dc::getTimeNs() + 20'000;
+          while (dc::getTimeNs() < endNs) {
+          }
+          ran.fetch_add(1);
+        }});
+      }
+    }
+    // The destructor finishes every job, however many workers were running.
+    ASSERT_EQ(ran.load(), 200);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cancellation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobCancellationTokenSharesFlag) {
+  const dc::CancellationToken empty;
+  ASSERT_FALSE(empty.canBeCancelled());
+  ASSERT_FALSE(empty.isCancelled());
+
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  const dc::CancellationToken copy = token;
+  ASSERT_TRUE(copy.canBeCancelled());
+  ASSERT_FALSE(copy.isCancelled());
+
+  token.cancel();
+  ASSERT_TRUE(token.isCancelled());
+  ASSERT_TRUE(copy.isCancelled());
+}
+
+DTEST(jobCancelSkipsQueuedJobs) {
+  dc::JobSystem js(1);
+  std::atomic<s32> ran{0};
+
+  WorkerGate gate(js);
+
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 1000; ++i) {
+    jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+  }
+  dc::JobHandle handle = js.add(jobs, token);
+  ASSERT_FALSE(handle.isCancelled());
+
+  token.cancel();
+  gate.release();
+  handle.await();
+
+  ASSERT_TRUE(handle.isDone());
+  ASSERT_TRUE(handle.isCancelled());
+  ASSERT_EQ(ran.load(), 0);
+}
+
+DTEST(jobCancelRunningJobsPollToken) {
+  dc::JobSystem js(4);
+  std::atomic<s32> started{0};
+
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 4; ++i) {
+    jobs.add(dc::Job{[&started, token] {
+      started.fetch_add(1);
+      while (!token.isCancelled()) dc::sleepMs(1);
+    }});
+  }
+  dc::JobHandle handle = js.add(jobs, token);
+
+  while (started.load() == 0) dc::sleepMs(1);
+  token.cancel();
+  handle.await();
+  ASSERT_TRUE(handle.isDone());
+}
+
+DTEST(jobCancelSkipsContinuations) {
+  dc::JobSystem js(2);
+  std::atomic<s32> ran{0};
+  std::atomic<bool> release{false};
+
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[&release] {
+    while (!release.load()) dc::sleepMs(1);
+  }});
+  dc::JobHandle first = js.add(jobs, token);
+  dc::JobHandle second = first.then(dc::Job{[&ran] { ran.fetch_add(1); }});
+  ASSERT_FALSE(second.isCancelled());
+
+  token.cancel();
+  release.store(true);
+  second.await();
+
+  ASSERT_TRUE(second.isCancelled());
+  ASSERT_EQ(ran.load(), 0);
+}
+
+DTEST(jobUncancelledTokenRunsEveryJob) {
+  dc::JobSystem js(4);
+  std::atomic<s32> ran{0};
+
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 500; ++i) {
+    jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+  }
+  js.add(jobs, token).await();
+  ASSERT_EQ(ran.load(), 500);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pinned and owner jobs
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Add count jobs for the worker, each recording the thread it ran on.
+dc::JobHandle addRecordingThread(dc::JobSystem& js, u32 workerIndex,
+                                 std::vector<std::thread::id>& ids,
+                                 s32 count) {
+  ids.resize(static_cast<usize>(count));
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < count; ++i) {
+    std::thread::id* id = &ids[static_cast<usize>(i)];
+    jobs.add(dc::Job{[id] { *id = std::this_thread::get_id(); }});
+  }
+  return js.addToWorker(workerIndex, jobs);
+}
+
+}  // namespace
+
+DTEST(jobPinnedRunsOnItsWorker) {
+  dc::JobSystem js(4);
+  std::vector<std::thread::id> ids[4];
+  dc::JobHandle handles[4];
+  for (u32 w = 0; w < 4; ++w) {
+    handles[w] = addRecordingThread(js, w, ids[w], 100);
+  }
+  for (dc::JobHandle& handle : handles) handle.await();
+
+  for (u32 w = 0; w < 4; ++w) {
+    for (const std::thread::id& id : ids[w]) ASSERT_TRUE(id == ids[w][0]);
+    for (u32 other = 0; other < w; ++other) {
+      ASSERT_TRUE(ids[w][0] != ids[other][0]);
+    }
+  }
+}
+
+DTEST(jobPinnedWaitsForBusyWorker) {
+  // The other workers are idle, but must not take the pinned jobs.
+  dc::JobSystem js(4);
+  std::atomic<bool> release{false};
+  std::atomic<s32> ran{0};
+
+  js.addToWorker(1, dc::Job{[&release] {
+    while (!release.load()) dc::sleepMs(1);
+  }});
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 20; ++i) {
+    jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+  }
+  dc::JobHandle handle = js.addToWorker(1, jobs);
+
+  dc::sleepMs(20);
+  ASSERT_EQ(ran.load(), 0);
+  release.store(true);
+  handle.await();
+  ASSERT_EQ(ran.load(), 20);
+}
+
+DTEST(jobPinnedFromJobs) {
+  dc::JobSystem js(4);
+  std::vector<std::thread::id> ids;
+  std::thread::id expected;
+
+  dc::JobHandle first = addRecordingThread(js, 2, ids, 1);
+  first.await();
+  expected = ids[0];
+
+  std::atomic<s32> onWorker{0};
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 64; ++i) {
+    jobs.add(dc::Job{[&js, &onWorker, expected] {
+      js.addToWorker(2, dc::Job{[&onWorker, expected] {
+        if (std::this_thread::get_id() == expected) onWorker.fetch_add(1);
+      }});
+    }});
+  }
+  js.add(jobs).await();
+  for (s32 i = 0; i < 5000 && onWorker.load() < 64; ++i) dc::sleepMs(1);
+  ASSERT_EQ(onWorker.load(), 64);
+}
+
+#if DC_JOB_FIBERS
+DTEST(jobPinnedAwaitStaysOnWorker) {
+  // Fibers may resume on another worker, pinned jobs must not move.
+  dc::JobSystemConfig config = threadConfig(4);
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 64;
+  dc::JobSystem js(config);
+  std::atomic<s32> moved{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 16; ++i) {
+    jobs.add(dc::Job{[&js, &moved] {
+      const std::thread::id before = std::this_thread::get_id();
+      dc::List<dc::Job> children;
+      for (s32 j = 0; j < 8; ++j) {
+        children.add(dc::Job{[] { dc::sleepMs(0); }});
+      }
+      js.add(children).await();
+      if (std::this_thread::get_id() != before) moved.fetch_add(1);
+    }});
+  }
+  js.addToWorker(3, jobs).await();
+  ASSERT_EQ(moved.load(), 0);
+}
+#endif
+
+DTEST(jobPinnedStartsStoppedWorker) {
+  dc::JobSystemConfig config = threadConfig(4);
+  config.elastic.minThreads = 1;
+  config.elastic.growQueueDepth = 8;
+  config.elastic.growAfter = std::chrono::nanoseconds(0);
+  config.elastic.shrinkAfter = std::chrono::milliseconds(20);
+  dc::JobSystem js(config);
+  ASSERT_EQ(js.activeWorkerCount(), 1u);
+
+  std::vector<std::thread::id> ids;
+  addRecordingThread(js, 3, ids, 10).await();
+  for (const std::thread::id& id : ids) ASSERT_TRUE(id == ids[0]);
+  ASSERT_TRUE(ids[0] != std::this_thread::get_id());
+}
+
+DTEST(jobOwnerQueueRunsOnPump) {
+  dc::JobSystem js(4);
+  ASSERT_TRUE(js.isOwnerThread());
+  std::atomic<s32> onOwner{0};
+  const std::thread::id owner = std::this_thread::get_id();
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 32; ++i) {
+    jobs.add(dc::Job{[&js, &onOwner, owner] {
+      js.addToOwner(dc::Job{[&onOwner, owner] {
+        if (std::this_thread::get_id() == owner) onOwner.fetch_add(1);
+      }});
+    }});
+  }
+  // Awaited from another thread, an await on the owner thread pumps.
+  dc::JobHandle handle = js.add(jobs);
+  std::thread([&handle] { handle.await(); }).join();
+  ASSERT_EQ(onOwner.load(), 0);
+
+  ASSERT_EQ(js.pumpOwnerQueue(10), 10u);
+  ASSERT_EQ(onOwner.load(), 10);
+  ASSERT_EQ(js.pumpOwnerQueue(), 22u);
+  ASSERT_EQ(onOwner.load(), 32);
+  ASSERT_EQ(js.pumpOwnerQueue(), 0u);
+}
+
+DTEST(jobOwnerQueuePumpsWhatWasQueued) {
+  // A job that adds itself again runs once per pump.
+  dc::JobSystem js(2);
+  s32 runs = 0;
+
+  struct Again {
+    dc::JobSystem* js;
+    s32* runs;
+    void operator()() const {
+      ++*runs;
+      js->addToOwner(dc::Job{Again{js, runs}});
+    }
+  };
+  js.addToOwner(dc::Job{Again{&js, &runs}});
+
+  ASSERT_EQ(js.pumpOwnerQueue(), 1u);
+  ASSERT_EQ(js.pumpOwnerQueue(), 1u);
+  ASSERT_EQ(runs, 2);
+}
+
+DTEST(jobOwnerAwaitRunsOwnerJobs) {
+  dc::JobSystem js(2);
+  s32 ran = 0;
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 8; ++i) jobs.add(dc::Job{[&ran] { ++ran; }});
+  js.addToOwner(jobs).await();
+  ASSERT_EQ(ran, 8);
+}
+
+DTEST(jobMakeOwnerThread) {
+  dc::JobSystem js(2);
+  std::atomic<bool> owned{false};
+  std::atomic<bool> ranOnOwner{false};
+
+  std::thread other([&] {
+    js.makeOwnerThread();
+    owned.store(true);
+    const std::thread::id self = std::this_thread::get_id();
+    js.addToOwner(dc::Job{[&ranOnOwner, self] {
+      ranOnOwner.store(std::this_thread::get_id() == self);
+    }});
+    while (js.pumpOwnerQueue() == 0) dc::sleepMs(1);
+  });
+  while (!owned.load()) dc::sleepMs(1);
+  ASSERT_FALSE(js.isOwnerThread());
+  other.join();
+  ASSERT_TRUE(ranOnOwner.load());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Blocking jobs
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(jobBlockingLeavesWorkersFree) {
+  // Every blocking job is stuck, compute jobs still get through.
+  dc::JobSystemConfig config = threadConfig(1);
+  config.blocking.maxThreads = 8;
+  dc::JobSystem js(config);
+  std::atomic<bool> release{false};
+
+  dc::List<dc::Job> blocking;
+  for (s32 i = 0; i < 4; ++i) {
+    blocking.add(dc::Job{[&release] {
+      while (!release.load()) dc::sleepMs(1);
+    }});
+  }
+  dc::JobHandle blocked = js.addBlocking(blocking);
+
+  std::atomic<s32> computed{0};
+  dc::List<dc::Job> compute;
+  for (s32 i = 0; i < 100; ++i) {
+    compute.add(dc::Job{[&computed] { computed.fetch_add(1); }});
+  }
+  js.add(compute).await();
+  ASSERT_EQ(computed.load(), 100);
+  ASSERT_FALSE(blocked.isDone());
+
+  release.store(true);
+  blocked.await();
+}
+
+DTEST(jobBlockingGrowsPastCores) {
+  // More blocking jobs than workers run at the same time.
+  dc::JobSystemConfig config = threadConfig(1);
+  config.blocking.maxThreads = 8;
+  dc::JobSystem js(config);
+  std::atomic<s32> started{0};
+  std::atomic<s32> sawAll{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 8; ++i) {
+    jobs.add(dc::Job{[&started, &sawAll] {
+      started.fetch_add(1);
+      for (s32 k = 0; k < 5000 && started.load() < 8; ++k) dc::sleepMs(1);
+      if (started.load() == 8) sawAll.fetch_add(1);
+    }});
+  }
+  js.addBlocking(jobs).await();
+
+  ASSERT_EQ(sawAll.load(), 8);
+
+  // Counted after the job, which may be after the await returns.
+  for (s32 i = 0; i < 5000 && js.stats().blockingJobsRun < 8; ++i) {
+    dc::sleepMs(1);
+  }
+  ASSERT_EQ(js.stats().blockingJobsRun, 8u);
+}
+
+DTEST(jobBlockingRespectsMaxThreads) {
+  dc::JobSystemConfig config = threadConfig(2);
+  config.blocking.maxThreads = 2;
+  dc::JobSystem js(config);
+  std::atomic<s32> running{0};
+  std::atomic<s32> mostRunning{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 12; ++i) {
+    jobs.add(dc::Job{[&running, &mostRunning] {
+      const s32 now = running.fetch_add(1) + 1;
+      s32 most = mostRunning.load();
+      while (now > most && !mostRunning.compare_exchange_weak(most, now)) {
+      }
+      dc::sleepMs(1);
+      running.fetch_sub(1);
+    }});
+  }
+  js.addBlocking(jobs).await();
+
+  ASSERT_TRUE(mostRunning.load() <= 2);
+  ASSERT_TRUE(js.stats().blockingThreads <= 2u);
+}
+
+DTEST(jobBlockingThreadsStopWhenIdle) {
+  dc::JobSystemConfig config = threadConfig(1);
+  config.blocking.maxThreads = 4;
+  config.blocking.idleTimeout = std::chrono::milliseconds(5);
+  dc::JobSystem js(config);
+
+  for (s32 round = 0; round < 3; ++round) {
+    dc::List<dc::Job> jobs;
+    jobs.add(dc::Job{[] { dc::sleepMs(1); }});
+    js.addBlocking(jobs).await();
+
+    for (s32 i = 0; i < 5000 && js.stats().blockingThreads > 0; ++i) {
+      dc::sleepMs(1);
+    }
+    ASSERT_EQ(js.stats().blockingThreads, 0u);
+  }
+}
+
+DTEST(jobBlockingHandsWorkToWorkers) {
+  dc::JobSystemConfig config = threadConfig(2);
+  config.blocking.maxThreads = 4;
+  dc::JobSystem js(config);
+  std::atomic<s32> sum{0};
+
+  dc::List<dc::Job> load;
+  load.add(dc::Job{[&js, &sum] {
+    dc::List<dc::Job> parse;
+    for (s32 i = 1; i <= 10; ++i) {
+      parse.add(dc::Job{[&sum, i] { sum.fetch_add(i); }});
+    }
+    js.add(parse).await();
+  }});
+  js.addBlocking(load).await();
+
+  ASSERT_EQ(sum.load(), 55);
+}
+
+DTEST(jobBlockingFinishesBeforeDestruction) {
+  std::atomic<s32> ran{0};
+  {
+    dc::JobSystemConfig config = threadConfig(1);
+    config.blocking.maxThreads = 2;
+    dc::JobSystem js(config);
+    for (s32 i = 0; i < 6; ++i) {
+      js.addBlocking(dc::Job{[&js, &ran] {
+        dc::sleepMs(1);
+        js.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+      }});
+    }
+  }
+  ASSERT_EQ(ran.load(), 6);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backpressure
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+void waitForBacklog(dc::JobSystem& js, u32 backlog) {
+  for (s32 i = 0; i < 5000 && js.backlog() != backlog; ++i) dc::sleepMs(1);
+}
+
+}  // namespace
+
+DTEST(jobBacklogNotCountedWithoutPolicy) {
+  dc::JobSystem js(1);
+  WorkerGate gate(js);
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 5; ++i) jobs.add(dc::Job{[] {}});
+  dc::JobHandle handle = js.add(jobs);
+  js.add(dc::Job{[] {}});
+  ASSERT_EQ(js.backlog(), 0u);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+}
+
+DTEST(jobBacklogCountsUnstartedJobs) {
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 100;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+  ASSERT_EQ(js.backlog(), 0u);
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 5; ++i) jobs.add(dc::Job{[] {}});
+  dc::JobHandle handle = js.add(jobs);
+  js.add(dc::Job{[] {}});
+  ASSERT_EQ(js.backlog(), 6u);
+  ASSERT_EQ(js.stats().backlog, 6u);
+
+  gate.release();
+  awaitWithoutHelping(handle);
+  waitForBacklog(js, 0);
+  ASSERT_EQ(js.backlog(), 0u);
+}
+
+DTEST(jobTryAddFailsWhenFull) {
+  std::atomic<s32> ran{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 4;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+
+  for (s32 i = 0; i < 4; ++i) {
+    ASSERT_TRUE(js.tryAdd(dc::Job{[&ran] { ran.fetch_add(1); }}));
+  }
+  dc::Job job{[&ran] { ran.fetch_add(1); }};
+  ASSERT_FALSE(js.tryAdd(dc::move(job)));
+  ASSERT_TRUE(static_cast<bool>(job.fn));
+  ASSERT_EQ(js.backlog(), 4u);
+
+  gate.release();
+  while (!js.tryAdd(dc::move(job))) dc::sleepMs(1);
+  for (s32 i = 0; i < 5000 && ran.load() < 5; ++i) dc::sleepMs(1);
+  ASSERT_EQ(ran.load(), 5);
+}
+
+DTEST(jobAddForTimesOut) {
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 1;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+  ASSERT_TRUE(js.tryAdd(dc::Job{[] {}}));
+
+  const u64 beginNs = dc::getTimeNs();
+  ASSERT_FALSE(js.addFor(dc::Job{[] {}}, std::chrono::milliseconds(20)));
+  ASSERT_TRUE(dc::getTimeNs() - beginNs >= 15'000'000u);
+
+  // Waits for the worker to make room.
+  std::thread releaser([&gate] {
+    dc::sleepMs(10);
+    gate.release();
+  });
+  ASSERT_TRUE(js.addFor(dc::Job{[] {}}, std::chrono::seconds(10)));
+  releaser.join();
+}
+
+DTEST(jobAddWaitsForRoom) {
+  std::atomic<s32> ran{0};
+  std::atomic<u32> mostBacklog{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 2;
+  dc::JobSystem js(config);
+
+  for (s32 i = 0; i < 200; ++i) {
+    js.add(dc::Job{[&ran, i] {
+      if (i % 20 == 0) dc::sleepMs(1);
+      ran.fetch_add(1);
+    }});
+    mostBacklog.store(dc::max(mostBacklog.load(), js.backlog()));
+  }
+  for (s32 i = 0; i < 5000 && ran.load() < 200; ++i) dc::sleepMs(1);
+
+  ASSERT_EQ(ran.load(), 200);
+  ASSERT_TRUE(mostBacklog.load() <= 2u);
+}
+
+DTEST(jobBatchLargerThanBacklog) {
+  std::atomic<bool> added{false};
+  std::atomic<s32> ran{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 4;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+  ASSERT_TRUE(js.tryAdd(dc::Job{[] {}}));
+
+  // Waits for the backlog to empty, rather than forever.
+  std::thread producer([&js, &added, &ran] {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 10; ++i) {
+      jobs.add(dc::Job{[&ran] { ran.fetch_add(1); }});
+    }
+    dc::JobHandle handle = js.add(jobs);
+    added.store(true);
+    handle.await();
+  });
+  dc::sleepMs(20);
+  ASSERT_FALSE(added.load());
+
+  gate.release();
+  producer.join();
+  ASSERT_EQ(ran.load(), 10);
+}
+
+DTEST(jobHighWaterCallback) {
+  std::atomic<s32> calls{0};
+  std::atomic<u32> seen{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.highWater = 4;
+  config.backpressure.onHighWater = [&calls, &seen](u32 backlog) noexcept {
+    seen.store(backlog);
+    calls.fetch_add(1);
+  };
+  dc::JobSystem js(config);
+
+  for (s32 round = 1; round <= 2; ++round) {
+    WorkerGate gate(js);
+    for (s32 i = 0; i < 8; ++i) js.add(dc::Job{[] {}});
+    ASSERT_EQ(calls.load(), round);
+    ASSERT_EQ(seen.load(), 4u);
+
+    // The jobs start after the gate is done with its flag.
+    gate.release();
+    waitForBacklog(js, 0);
+    ASSERT_EQ(js.backlog(), 0u);
+  }
+}
+
+DTEST(jobAddFromJobsIgnoresBacklog) {
+  std::atomic<s32> ran{0};
+  std::atomic<s32> refused{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 1;
+  dc::JobSystem js(config);
+
+  js.add(dc::Job{[&js, &ran, &refused] {
+    for (s32 i = 0; i < 100; ++i) {
+      if (!js.tryAdd(dc::Job{[&ran] { ran.fetch_add(1); }})) {
+        refused.fetch_add(1);
+      }
+    }
+  }});
+  for (s32 i = 0; i < 5000 && ran.load() < 100; ++i) dc::sleepMs(1);
+
+  ASSERT_EQ(refused.load(), 0);
+  ASSERT_EQ(ran.load(), 100);
+  ASSERT_EQ(js.backlog(), 0u);
+}
+
+DTEST(jobAddFromBatchJobsToOtherSystemIgnoresBacklog) {
+  // The jobs of a batch add to another JobSystem, whose backlog is full.
+  // add() would wait for room there, and hold up the worker.
+  std::atomic<s32> added{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 1;
+  dc::JobSystem other(config);
+  WorkerGate gate(other);
+  ASSERT_TRUE(other.tryAdd(dc::Job{[] {}}));
+
+  {
+    dc::JobSystem js(1);
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 4; ++i) {
+      jobs.add(dc::Job{[&other, &added] {
+        if (other.tryAdd(dc::Job{[] {}})) added.fetch_add(1);
+      }});
+    }
+    awaitWithoutHelping(js.add(jobs));
+  }
+  const u32 backlog = other.backlog();
+  gate.release();
+
+  ASSERT_EQ(added.load(), 4);
+  ASSERT_EQ(backlog, 1u);
+}
+
+DTEST(jobAddFromBlockingAndOwnerJobsIgnoresBacklog) {
+  std::atomic<s32> ran{0};
+  std::atomic<s32> added{0};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 1;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+  ASSERT_TRUE(js.tryAdd(dc::Job{[] {}}));
+
+  auto addFromJob = [&js, &ran, &added] {
+    if (js.tryAdd(dc::Job{[&ran] { ran.fetch_add(1); }})) added.fetch_add(1);
+  };
+  js.addBlocking(dc::Job{addFromJob});
+  js.addToOwner(dc::Job{addFromJob});
+  ASSERT_EQ(js.pumpOwnerQueue(), 1u);
+  for (s32 i = 0; i < 5000 && js.stats().blockingJobsRun < 1; ++i) {
+    dc::sleepMs(1);
+  }
+  const u32 backlog = js.backlog();
+  gate.release();
+
+  ASSERT_EQ(added.load(), 2);
+  ASSERT_EQ(backlog, 1u);
+  for (s32 i = 0; i < 5000 && ran.load() < 2; ++i) dc::sleepMs(1);
+  ASSERT_EQ(ran.load(), 2);
+}
+
+DTEST(jobContinuationsIgnoreBacklog) {
+  std::atomic<bool> ran{false};
+  dc::JobSystemConfig config = threadConfig(1);
+  config.backpressure.maxBacklog = 1;
+  dc::JobSystem js(config);
+  WorkerGate gate(js);
+  ASSERT_TRUE(js.tryAdd(dc::Job{[] {}}));
+
+  // Released on this thread, outside of any job, while the backlog is full.
+  auto counter = std::make_shared<dc::JobCounter>(1u, &js);
+  dc::JobHandle next =
+      dc::JobHandle{counter}.then(dc::Job{[&ran] { ran.store(true); }});
+  counter->decrement();
+  ASSERT_EQ(js.backlog(), 1u);
+
+  gate.release();
+  next.await();
+  ASSERT_TRUE(ran.load());
 }
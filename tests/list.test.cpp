@@ -1,5 +1,6 @@
 #include <dc/dtest.hpp>
 #include <dc/list.hpp>
+#include <memory>
 
 using namespace dc;
 using namespace dtest;
@@ -98,7 +99,8 @@ DTEST(removeByReference) {
   ASSERT_EQ(list.getSize(), 0);
   ASSERT_EQ(stats.copies, 0);
   // ASSERT_EQ(stats.moves, 0);
-  ASSERT_EQ(stats.destructs, destructsBefore + 3);
+  // 3 lookup temporaries and the 3 removed elements
+  ASSERT_EQ(stats.destructs, destructsBefore + 6);
 }
 
 DTEST(removeIfHappyPath) {
@@ -299,6 +301,28 @@ DTEST(addRangeForTrivialElementType) {
   ASSERT_TRUE(strcmp(v.begin(), "hello world") == 0);
 }
 
+DTEST(addRangeForWideTrivialElementType) {
+  List<u32> v(TEST_ALLOCATOR);
+  v.add(1);
+
+  const u32 more[] = {2, 3, 0x01020304};
+  v.addRange(more, more + 3);
+
+  ASSERT_EQ(v.getSize(), 4);
+  ASSERT_EQ(v[1], 2u);
+  ASSERT_EQ(v[2], 3u);
+  ASSERT_EQ(v[3], 0x01020304u);
+}
+
+DTEST(addDefaultConstructs) {
+  List<LifetimeTracker<int>> list(TEST_ALLOCATOR);
+  LifetimeTracker<int>& elem = list.add();
+  elem.object = 5;
+
+  ASSERT_EQ(list.getSize(), 1);
+  ASSERT_EQ(list[0], 5);
+}
+
 DTEST(addRangeForNonTrivialElementType) {
   struct A {
     int a;
@@ -491,6 +515,58 @@ DTEST(clearNonTrivialCallsDestructors) {
   }
 }
 
+DTEST(inlineElementsDestroyedOnce) {
+  LifetimeStats::resetInstance();
+  LifetimeStats& stats = LifetimeStats::getInstance();
+
+  int destructsBefore = 0;
+  {
+    List<LifetimeTracker<int>, 4> list(TEST_ALLOCATOR);
+    list.add(1);
+    list.add(2);
+    destructsBefore = stats.destructs;
+  }
+
+  ASSERT_EQ(stats.destructs, destructsBefore + 2);
+  ASSERT_EQ(stats.destructs, stats.constructs);
+}
+
+DTEST(movedFromElementsAreDestroyed) {
+  LifetimeStats::resetInstance();
+  LifetimeStats& stats = LifetimeStats::getInstance();
+
+  {
+    List<LifetimeTracker<int>, 2> inlineList(TEST_ALLOCATOR);
+    inlineList.add(1);
+    inlineList.add(2);
+
+    List<LifetimeTracker<int>, 2> moved(dc::move(inlineList));
+    List<LifetimeTracker<int>, 2> assigned(TEST_ALLOCATOR);
+    assigned = dc::move(moved);
+
+    assigned.reserve(8);
+    assigned.add(3);
+    assigned.remove(LifetimeTracker<int>(1));
+    assigned.removeAt(0);
+    ASSERT_EQ(assigned.getSize(), 1);
+    ASSERT_EQ(assigned[0], 3);
+  }
+
+  ASSERT_EQ(stats.destructs, stats.constructs);
+}
+
+DTEST(inlineSharedElementReleasedOnce) {
+  std::shared_ptr<int> shared = std::make_shared<int>(7);
+
+  {
+    List<std::shared_ptr<int>, 2> list(TEST_ALLOCATOR);
+    list.add(shared);
+    ASSERT_EQ(shared.use_count(), 2);
+  }
+
+  ASSERT_EQ(shared.use_count(), 1);
+}
+
 DTEST(moveConstructTrivialUsesMemcpy) {
   // When moving from internal buffer, trivially relocatable types use memcpy
   List<int, 4> list1(TEST_ALLOCATOR);
@@ -0,0 +1,291 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/mpmc_ring.hpp>
+#include <dc/string.hpp>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(mpmcRingConstructor) {
+  dc::MpmcRing<s32> ring(4);
+  ASSERT_TRUE(ring.isEmpty());
+  ASSERT_FALSE(ring.isFull());
+  ASSERT_EQ(ring.size(), 0u);
+  ASSERT_EQ(ring.capacity(), 4u);
+}
+
+DTEST(mpmcRingRoundsUpCapacityToPowerOfTwo) {
+  dc::MpmcRing<s32> ring5(5);
+  ASSERT_EQ(ring5.capacity(), 8u);
+
+  dc::MpmcRing<s32> ring1(1);
+  ASSERT_EQ(ring1.capacity(), 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// add / remove
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(mpmcRingAddAndRemove) {
+  dc::MpmcRing<s32> ring(4);
+
+  s32 val = 42;
+  ASSERT_TRUE(ring.add(dc::move(val)));
+  ASSERT_EQ(ring.size(), 1u);
+
+  s32 out = 0;
+  ASSERT_TRUE(ring.remove(out));
+  ASSERT_EQ(out, 42);
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+DTEST(mpmcRingReturnsFalseWhenFull) {
+  dc::MpmcRing<s32> ring(2);
+
+  s32 a = 1, b = 2, c = 3;
+  ASSERT_TRUE(ring.add(dc::move(a)));
+  ASSERT_TRUE(ring.add(dc::move(b)));
+  ASSERT_TRUE(ring.isFull());
+  ASSERT_FALSE(ring.add(dc::move(c)));
+  ASSERT_EQ(ring.size(), 2u);
+}
+
+DTEST(mpmcRingReturnsFalseWhenEmpty) {
+  dc::MpmcRing<s32> ring(4);
+  s32 out = 7;
+  ASSERT_FALSE(ring.remove(out));
+  ASSERT_EQ(out, 7);
+}
+
+DTEST(mpmcRingFIFOOrderAndWraparound) {
+  dc::MpmcRing<s32> ring(4);
+
+  for (s32 round = 0; round < 10; ++round) {
+    for (s32 i = 0; i < 4; ++i) {
+      s32 v = i + round * 4;
+      ASSERT_TRUE(ring.add(dc::move(v)));
+    }
+    ASSERT_TRUE(ring.isFull());
+    for (s32 i = 0; i < 4; ++i) {
+      s32 out = -1;
+      ASSERT_TRUE(ring.remove(out));
+      ASSERT_EQ(out, i + round * 4);
+    }
+    ASSERT_TRUE(ring.isEmpty());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bulk operations
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(mpmcRingAddBulkAndRemoveBulk) {
+  dc::MpmcRing<s32> ring(8);
+
+  s32 in[5] = {0, 1, 2, 3, 4};
+  ASSERT_EQ(ring.addBulk(in, 5), 5u);
+  ASSERT_EQ(ring.size(), 5u);
+
+  s32 out[8] = {};
+  ASSERT_EQ(ring.removeBulk(out, 3), 3u);
+  ASSERT_EQ(out[0], 0);
+  ASSERT_EQ(out[1], 1);
+  ASSERT_EQ(out[2], 2);
+
+  ASSERT_EQ(ring.removeBulk(out, 8), 2u);
+  ASSERT_EQ(out[0], 3);
+  ASSERT_EQ(out[1], 4);
+  ASSERT_EQ(ring.removeBulk(out, 8), 0u);
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+DTEST(mpmcRingAddBulkStopsWhenFull) {
+  dc::MpmcRing<s32> ring(4);
+
+  s32 in[6] = {0, 1, 2, 3, 4, 5};
+  ASSERT_EQ(ring.addBulk(in, 6), 4u);
+  ASSERT_TRUE(ring.isFull());
+  ASSERT_EQ(ring.addBulk(in + 4, 2), 0u);
+
+  s32 out[4] = {};
+  ASSERT_EQ(ring.removeBulk(out, 4), 4u);
+  for (s32 i = 0; i < 4; ++i) ASSERT_EQ(out[i], i);
+}
+
+DTEST(mpmcRingBulkWraparound) {
+  dc::MpmcRing<s32> ring(4);
+
+  for (s32 round = 0; round < 10; ++round) {
+    s32 in[3] = {round * 3, round * 3 + 1, round * 3 + 2};
+    ASSERT_EQ(ring.addBulk(in, 3), 3u);
+    s32 single = -1;
+    ASSERT_TRUE(ring.remove(single));
+    ASSERT_EQ(single, round * 3);
+    s32 out[3] = {};
+    ASSERT_EQ(ring.removeBulk(out, 3), 2u);
+    ASSERT_EQ(out[0], round * 3 + 1);
+    ASSERT_EQ(out[1], round * 3 + 2);
+  }
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Non-trivial element type
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(mpmcRingStringElementType) {
+  dc::MpmcRing<dc::String> ring(4);
+
+  dc::String s1("hello");
+  dc::String s2("world");
+  ring.add(dc::move(s1));
+  ring.add(dc::move(s2));
+
+  dc::String out;
+  ASSERT_TRUE(ring.remove(out));
+  ASSERT_EQ(out.toView(), "hello");
+  ASSERT_TRUE(ring.remove(out));
+  ASSERT_EQ(out.toView(), "world");
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread safety: multiple producers / multiple consumers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(mpmcRingThreadedProducersAndConsumers) {
+  // Every element must be removed exactly once. A small ring forces many
+  // full/empty transitions and index wraparounds.
+  constexpr s32 kProducers = 4;
+  constexpr s32 kConsumers = 4;
+  constexpr s32 kItemsPerProducer = 5000;
+  constexpr s32 kItemCount = kProducers * kItemsPerProducer;
+
+  dc::MpmcRing<s32> ring(16);
+  std::vector<std::atomic<s32>> seen(kItemCount);
+  for (auto& s : seen) s.store(0, std::memory_order_relaxed);
+  std::atomic<s32> consumed{0};
+
+  std::vector<std::thread> threads;
+  for (s32 c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&ring, &seen, &consumed] {
+      while (consumed.load(std::memory_order_relaxed) < kItemCount) {
+        s32 item;
+        if (ring.remove(item)) {
+          seen[static_cast<usize>(item)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+          consumed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (s32 p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&ring, p] {
+      for (s32 i = 0; i < kItemsPerProducer; ++i) {
+        s32 v = p * kItemsPerProducer + i;
+        while (!ring.add(dc::move(v))) std::this_thread::yield();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  ASSERT_EQ(consumed.load(std::memory_order_relaxed), kItemCount);
+  for (s32 i = 0; i < kItemCount; ++i) {
+    ASSERT_EQ(seen[static_cast<usize>(i)].load(std::memory_order_relaxed), 1);
+  }
+}
+
+DTEST(mpmcRingThreadedBulkProducersAndConsumers) {
+  // Same as above with batches on both sides, mixed with single adds.
+  constexpr s32 kProducers = 4;
+  constexpr s32 kConsumers = 4;
+  constexpr s32 kItemsPerProducer = 5000;
+  constexpr s32 kItemCount = kProducers * kItemsPerProducer;
+  constexpr u32 kBatch = 5;
+
+  dc::MpmcRing<s32> ring(16);
+  std::vector<std::atomic<s32>> seen(kItemCount);
+  for (auto& s : seen) s.store(0, std::memory_order_relaxed);
+  std::atomic<s32> consumed{0};
+
+  std::vector<std::thread> threads;
+  for (s32 c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&ring, &seen, &consumed] {
+      s32 out[kBatch];
+      while (consumed.load(std::memory_order_relaxed) < kItemCount) {
+        const u32 removed = ring.removeBulk(out, kBatch);
+        for (u32 i = 0; i < removed; ++i) {
+          seen[static_cast<usize>(out[i])].fetch_add(1,
+                                                     std::memory_order_relaxed);
+        }
+        if (removed > 0) {
+          consumed.fetch_add(static_cast<s32>(removed),
+                             std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (s32 p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&ring, p] {
+      s32 in[kBatch];
+      for (s32 next = 0; next < kItemsPerProducer;) {
+        if (next % 3 == 0) {
+          s32 v = p * kItemsPerProducer + next;
+          while (!ring.add(dc::move(v))) std::this_thread::yield();
+          ++next;
+          continue;
+        }
+        const u32 count =
+            dc::min(kBatch, static_cast<u32>(kItemsPerProducer - next));
+        for (u32 i = 0; i < count; ++i) {
+          in[i] = p * kItemsPerProducer + next + static_cast<s32>(i);
+        }
+        u32 added = 0;
+        while (added < count) {
+          const u32 n = ring.addBulk(in + added, count - added);
+          if (n == 0) std::this_thread::yield();
+          added += n;
+        }
+        next += static_cast<s32>(count);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  ASSERT_EQ(consumed.load(std::memory_order_relaxed), kItemCount);
+  for (s32 i = 0; i < kItemCount; ++i) {
+    ASSERT_EQ(seen[static_cast<usize>(i)].load(std::memory_order_relaxed), 1);
+  }
+}
@@ -0,0 +1,329 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/parallel.hpp>
+#include <dc/time.hpp>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelFor
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelForVisitsEveryIndexOnce) {
+  dc::JobSystem js(4);
+  constexpr usize kCount = 10'000;
+  std::vector<std::atomic<s32>> visits(kCount);
+
+  dc::parallelFor(js, usize{0}, kCount, [&visits](usize i) {
+    visits[i].fetch_add(1, std::memory_order_relaxed);
+  });
+
+  for (usize i = 0; i < kCount; ++i) {
+    ASSERT_EQ(visits[i].load(std::memory_order_relaxed), 1);
+  }
+}
+
+DTEST(parallelForIndexRangeWithOffset) {
+  dc::JobSystem js(4);
+  std::atomic<u64> sum{0};
+
+  dc::parallelFor(
+      js, usize{100}, usize{200},
+      [&sum](usize i) { sum.fetch_add(i, std::memory_order_relaxed); }, 7);
+
+  // 100 + 101 + ... + 199
+  ASSERT_EQ(sum.load(std::memory_order_relaxed), 14950u);
+}
+
+DTEST(parallelForEmptyRange) {
+  dc::JobSystem js(2);
+  std::atomic<s32> calls{0};
+
+  dc::parallelFor(js, usize{5}, usize{5}, [&calls](usize) { ++calls; });
+  dc::List<s32> empty;
+  dc::parallelFor(js, empty, [&calls](s32&) { ++calls; });
+
+  ASSERT_EQ(calls.load(), 0);
+}
+
+DTEST(parallelForList) {
+  dc::JobSystem js(4);
+  dc::List<s32> list;
+  for (s32 i = 0; i < 1000; ++i) list.add(i);
+
+  dc::parallelFor(js, list, [](s32& value) { value *= 2; });
+
+  for (s32 i = 0; i < 1000; ++i) {
+    ASSERT_EQ(list[static_cast<u64>(i)], i * 2);
+  }
+}
+
+DTEST(parallelForGrainSizeOfOne) {
+  dc::JobSystem js(4);
+  constexpr usize kCount = 257;
+  std::vector<s32> values(kCount, 0);
+
+  dc::parallelFor(
+      js, values.data(), values.data() + kCount, [](s32& value) { ++value; },
+      1);
+
+  for (usize i = 0; i < kCount; ++i) {
+    ASSERT_EQ(values[i], 1);
+  }
+}
+
+DTEST(parallelForRunsOnSeveralWorkers) {
+  dc::JobSystem js(4);
+  std::atomic<s32> inFlight{0};
+  std::atomic<s32> maxInFlight{0};
+
+  dc::parallelFor(
+      js, usize{0}, usize{16},
+      [&inFlight, &maxInFlight](usize) {
+        const s32 now = inFlight.fetch_add(1) + 1;
+        s32 seen = maxInFlight.load();
+        while (now > seen && !maxInFlight.compare_exchange_weak(seen, now)) {
+        }
+        dc::sleepMs(5);
+        inFlight.fetch_sub(1);
+      },
+      1);
+
+  ASSERT_TRUE(maxInFlight.load() > 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelReduce
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelReduceSum) {
+  dc::JobSystem js(4);
+  dc::List<s64> list;
+  for (s64 i = 1; i <= 100'000; ++i) list.add(i);
+
+  const s64 sum = dc::parallelReduce(js, list, 0, std::plus<>{});
+
+  ASSERT_EQ(sum, s64{100'000} * 100'001 / 2);
+}
+
+DTEST(parallelReduceEmptyReturnsIdentity) {
+  dc::JobSystem js(2);
+  dc::List<s32> empty;
+  ASSERT_EQ(dc::parallelReduce(js, empty, 42, std::plus<>{}), 42);
+}
+
+DTEST(parallelReduceKeepsOrderForNonCommutativeOp) {
+  dc::JobSystem js(4);
+  std::vector<std::string> letters;
+  std::string expected;
+  for (s32 i = 0; i < 26 * 8; ++i) {
+    letters.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+    expected += letters.back();
+  }
+
+  const std::string joined = dc::parallelReduce(
+      js, letters.data(), letters.data() + letters.size(), std::string{},
+      [](std::string acc, const std::string& s) { return acc + s; }, 5);
+
+  ASSERT_TRUE(joined == expected);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelTransform
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelTransformList) {
+  dc::JobSystem js(4);
+  dc::List<s32> in;
+  for (s32 i = 0; i < 5000; ++i) in.add(i);
+
+  dc::List<s64> out;
+  dc::parallelTransform(js, in, out,
+                        [](s32 v) { return static_cast<s64>(v) * v; });
+
+  ASSERT_EQ(out.getSize(), in.getSize());
+  for (s32 i = 0; i < 5000; ++i) {
+    ASSERT_EQ(out[static_cast<u64>(i)], static_cast<s64>(i) * i);
+  }
+}
+
+DTEST(parallelTransformInPlace) {
+  dc::JobSystem js(4);
+  std::vector<s32> values(1000);
+  for (usize i = 0; i < values.size(); ++i) values[i] = static_cast<s32>(i);
+
+  dc::parallelTransform(js, values.data(), values.data() + values.size(),
+                        values.data(), [](s32 v) { return -v; });
+
+  for (usize i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], -static_cast<s32>(i));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelSort
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelSortRandomData) {
+  dc::JobSystem js(4);
+  std::mt19937 rng(1234);
+  dc::List<u32> list;
+  for (s32 i = 0; i < 50'000; ++i) list.add(static_cast<u32>(rng()));
+
+  dc::parallelSort(js, list);
+
+  for (u64 i = 1; i < list.getSize(); ++i) {
+    ASSERT_TRUE(list[i - 1] <= list[i]);
+  }
+}
+
+DTEST(parallelSortCustomCompareAndOddSizes) {
+  dc::JobSystem js(3);
+  std::mt19937 rng(99);
+
+  // Sizes that don't divide evenly into chunks, and a grain size that leaves
+  // an odd run out of every merge pass.
+  for (usize count : {0u, 1u, 2u, 17u, 1000u, 4097u}) {
+    std::vector<s32> values(count);
+    for (s32& v : values) v = static_cast<s32>(rng() % 1000);
+
+    dc::parallelSort(js, values.data(), values.data() + count,
+                     std::greater<>{}, 3);
+
+    for (usize i = 1; i < count; ++i) {
+      ASSERT_TRUE(values[i - 1] >= values[i]);
+    }
+  }
+}
+
+DTEST(parallelSortMoveOnlyElements) {
+  dc::JobSystem js(4);
+  std::vector<std::unique_ptr<s32>> values;
+  for (s32 i = 0; i < 500; ++i) {
+    values.push_back(std::make_unique<s32>((i * 7919) % 500));
+  }
+
+  dc::parallelSort(
+      js, values.data(), values.data() + values.size(),
+      [](const std::unique_ptr<s32>& a, const std::unique_ptr<s32>& b) {
+        return *a < *b;
+      },
+      16);
+
+  for (s32 i = 0; i < 500; ++i) {
+    ASSERT_EQ(*values[static_cast<usize>(i)], i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// parallelScan
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelScanInclusiveSum) {
+  dc::JobSystem js(4);
+  dc::List<s64> in;
+  for (s64 i = 0; i < 10'000; ++i) in.add(i % 13);
+
+  dc::List<s64> out;
+  dc::parallelScan(js, in, out, 0, std::plus<>{}, 64);
+
+  ASSERT_EQ(out.getSize(), in.getSize());
+  s64 running = 0;
+  for (u64 i = 0; i < in.getSize(); ++i) {
+    running += in[i];
+    ASSERT_EQ(out[i], running);
+  }
+}
+
+DTEST(parallelScanInPlaceNonCommutative) {
+  dc::JobSystem js(4);
+  std::vector<std::string> values;
+  for (s32 i = 0; i < 40; ++i) {
+    values.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+  }
+  const std::vector<std::string> in = values;
+
+  dc::parallelScan(
+      js, values.data(), values.data() + values.size(), values.data(),
+      std::string{},
+      [](std::string acc, const std::string& s) { return acc + s; }, 3);
+
+  std::string running;
+  for (usize i = 0; i < in.size(); ++i) {
+    running += in[i];
+    ASSERT_TRUE(values[i] == running);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Nesting
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(parallelForNested) {
+  dc::JobSystem js(2);
+  constexpr usize kOuter = 16;
+  constexpr usize kInner = 64;
+  std::atomic<s32> calls{0};
+
+  dc::parallelFor(
+      js, usize{0}, kOuter,
+      [&js, &calls](usize) {
+        dc::parallelFor(
+            js, usize{0}, kInner,
+            [&calls](usize) { calls.fetch_add(1, std::memory_order_relaxed); },
+            4);
+      },
+      1);
+
+  ASSERT_EQ(calls.load(std::memory_order_relaxed),
+            static_cast<s32>(kOuter * kInner));
+}
+
+DTEST(parallelSortInsideJobOnSingleWorker) {
+  dc::JobSystem js(1);
+  std::vector<s32> values(1000);
+  for (usize i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<s32>((i * 7919) % 1000);
+  }
+
+  dc::List<dc::Job> jobs;
+  jobs.add(dc::Job{[&js, &values] {
+    dc::parallelSort(js, values.data(), values.data() + values.size(),
+                     std::less<>{}, 50);
+  }});
+  js.add(jobs).await();
+
+  for (usize i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], static_cast<s32>(i));
+  }
+}
@@ -0,0 +1,241 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/pipeline.hpp>
+#include <dc/time.hpp>
+#include <vector>
+
+namespace {
+
+/// Raise max to value if it is larger.
+void raiseTo(std::atomic<s32>& max, s32 value) {
+  s32 seen = max.load();
+  while (value > seen && !max.compare_exchange_weak(seen, value)) {
+  }
+}
+
+}  // namespace
+
+DTEST(pipelineRunsEveryItemInOrder) {
+  dc::JobSystem js(4);
+  s32 next = 0;
+  std::vector<s32> out;
+
+  dc::Pipeline<s32> pipeline(js, 8);
+  pipeline
+      .source([&next](s32& item) {
+        if (next == 1000) return false;
+        item = next++;
+        return true;
+      })
+      .stage(dc::StageMode::Parallel, [](s32& item) { item *= 2; })
+      .stage(dc::StageMode::SerialInOrder,
+             [&out](s32& item) { out.push_back(item); });
+  pipeline.run();
+
+  ASSERT_EQ(out.size(), 1000u);
+  for (s32 i = 0; i < 1000; ++i) ASSERT_EQ(out[static_cast<usize>(i)], i * 2);
+}
+
+DTEST(pipelineInOrderAfterUnevenParallelStage) {
+  // Later items overtake earlier ones in the parallel stage, the serial stage
+  // puts them back in order.
+  dc::JobSystem js(4);
+  s32 next = 0;
+  std::vector<s32> out;
+
+  dc::Pipeline<s32> pipeline(js, 6);
+  pipeline
+      .source([&next](s32& item) {
+        if (next == 60) return false;
+        item = next++;
+        return true;
+      })
+      .stage(dc::StageMode::Parallel,
+             [](s32& item) {
+               if (item % 3 == 0) dc::sleepMs(2);
+             })
+      .stage(dc::StageMode::SerialInOrder,
+             [&out](s32& item) { out.push_back(item); });
+  pipeline.run();
+
+  ASSERT_EQ(out.size(), 60u);
+  for (s32 i = 0; i < 60; ++i) ASSERT_EQ(out[static_cast<usize>(i)], i);
+}
+
+DTEST(pipelineSerialStagesRunOneAtATime) {
+  dc::JobSystem js(4);
+  s32 next = 0;
+  std::atomic<s32> inStage{0};
+  std::atomic<s32> maxInStage{0};
+  std::atomic<s64> sum{0};
+
+  dc::Pipeline<s32> pipeline(js, 8);
+  pipeline
+      .source([&next](s32& item) {
+        if (next == 200) return false;
+        item = next++;
+        return true;
+      })
+      .stage(dc::StageMode::SerialOutOfOrder,
+             [&](s32& item) {
+               raiseTo(maxInStage, inStage.fetch_add(1) + 1);
+               sum.fetch_add(item);
+               inStage.fetch_sub(1);
+             })
+      .stage(dc::StageMode::Parallel, [](s32&) {});
+  pipeline.run();
+
+  ASSERT_EQ(maxInStage.load(), 1);
+  ASSERT_EQ(sum.load(), 199 * 200 / 2);
+}
+
+DTEST(pipelineBoundsItemsInFlight) {
+  dc::JobSystem js(4);
+  constexpr u32 kTokens = 3;
+  s32 next = 0;
+  std::atomic<s32> inFlight{0};
+  std::atomic<s32> maxInFlight{0};
+  std::atomic<s32> done{0};
+
+  dc::Pipeline<s32> pipeline(js, kTokens);
+  pipeline
+      .source([&](s32& item) {
+        if (next == 100) return false;
+        item = next++;
+        raiseTo(maxInFlight, inFlight.fetch_add(1) + 1);
+        return true;
+      })
+      .stage(dc::StageMode::Parallel, [](s32&) { dc::sleepMs(0); })
+      .stage(dc::StageMode::Parallel, [&](s32&) {
+        done.fetch_add(1);
+        inFlight.fetch_sub(1);
+      });
+  pipeline.run();
+
+  ASSERT_EQ(done.load(), 100);
+  ASSERT_TRUE(maxInFlight.load() <= static_cast<s32>(kTokens));
+}
+
+DTEST(pipelineReaderOverlapsWriter) {
+  // A slow serial reader and a slow serial writer work at the same time,
+  // rather than taking turns.
+  dc::JobSystem js(2);
+  s32 next = 0;
+  std::atomic<bool> reading{false};
+  std::atomic<bool> writing{false};
+  std::atomic<bool> overlapped{false};
+
+  dc::Pipeline<s32> pipeline(js, 4);
+  pipeline
+      .source([&](s32& item) {
+        if (next == 20) return false;
+        reading.store(true);
+        if (writing.load()) overlapped.store(true);
+        dc::sleepMs(2);
+        reading.store(false);
+        item = next++;
+        return true;
+      })
+      .stage(dc::StageMode::SerialInOrder, [&](s32&) {
+        writing.store(true);
+        if (reading.load()) overlapped.store(true);
+        dc::sleepMs(2);
+        writing.store(false);
+      });
+  pipeline.run();
+
+  ASSERT_TRUE(overlapped.load());
+}
+
+DTEST(pipelineEmptySource) {
+  dc::JobSystem js(2);
+  std::atomic<s32> staged{0};
+
+  dc::Pipeline<s32> pipeline(js, 4);
+  pipeline.source([](s32&) { return false; })
+      .stage(dc::StageMode::SerialInOrder, [&staged](s32&) { ++staged; });
+  pipeline.run();
+
+  ASSERT_EQ(staged.load(), 0);
+}
+
+DTEST(pipelineReusesItemsAcrossRuns) {
+  // Items keep their buffers from one use to the next.
+  dc::JobSystem js(2);
+  s32 next = 0;
+  s32 total = 0;
+  std::atomic<s32> reused{0};
+
+  dc::Pipeline<dc::List<s32>> pipeline(js, 2);
+  pipeline
+      .source([&](dc::List<s32>& item) {
+        if (next == 10) return false;
+        if (item.getCapacity() >= 64) reused.fetch_add(1);
+        item.clear();
+        for (s32 i = 0; i < 64; ++i) item.add(next);
+        ++next;
+        return true;
+      })
+      .stage(dc::StageMode::SerialOutOfOrder, [&total](dc::List<s32>& item) {
+        for (s32 value : item) total += value;
+      });
+
+  pipeline.run();
+  ASSERT_EQ(total, 64 * 45);
+
+  next = 0;
+  total = 0;
+  pipeline.run();
+  ASSERT_EQ(total, 64 * 45);
+  ASSERT_TRUE(reused.load() >= 10);
+}
+
+DTEST(pipelineFromJob) {
+  dc::JobSystem js(2);
+  std::atomic<s32> sum{0};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&js, &sum] {
+    s32 next = 0;
+    dc::Pipeline<s32> pipeline(js, 4);
+    pipeline
+        .source([&next](s32& item) {
+          if (next == 50) return false;
+          item = next++;
+          return true;
+        })
+        .stage(dc::StageMode::SerialInOrder,
+               [&sum](s32& item) { sum.fetch_add(item); });
+    pipeline.run();
+  }});
+  js.add(outer).await();
+
+  ASSERT_EQ(sum.load(), 49 * 50 / 2);
+}
@@ -0,0 +1,254 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <cstring>
+#include <dc/dtest.hpp>
+#include <dc/job/scratch_arena.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/time.hpp>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ScratchArena
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(scratchArenaAllocIsAligned) {
+  dc::ScratchArena arena(1024);
+  for (usize align : {usize{8}, usize{16}, usize{64}}) {
+    void* data = arena.alloc(3, align);
+    ASSERT_NE(data, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr>(data) % align, 0u);
+  }
+  ASSERT_EQ(arena.bytesUsed(), 9u);
+}
+
+DTEST(scratchArenaFreeGivesBackMostRecent) {
+  dc::ScratchArena arena(1024);
+  void* first = arena.alloc(32);
+  void* second = arena.alloc(32);
+
+  // Not the most recent, stays in use.
+  arena.free(first);
+  ASSERT_EQ(arena.bytesUsed(), 64u);
+
+  arena.free(second);
+  ASSERT_EQ(arena.bytesUsed(), 32u);
+  ASSERT_EQ(arena.alloc(32), second);
+}
+
+DTEST(scratchArenaReallocGrowsInPlace) {
+  dc::ScratchArena arena(1024);
+  auto* data = static_cast<u8*>(arena.alloc(16));
+  std::memset(data, 7, 16);
+
+  auto* grown = static_cast<u8*>(arena.realloc(data, 64));
+  ASSERT_EQ(grown, data);
+  ASSERT_EQ(arena.bytesUsed(), 64u);
+
+  // Something on top, so the next realloc has to move.
+  ASSERT_NE(arena.alloc(8), nullptr);
+  auto* moved = static_cast<u8*>(arena.realloc(grown, 128));
+  ASSERT_NE(moved, grown);
+  for (usize i = 0; i < 16; ++i) ASSERT_EQ(moved[i], 7);
+}
+
+DTEST(scratchArenaResetReusesChunks) {
+  dc::ScratchArena arena(1024);
+  for (s32 i = 0; i < 100; ++i) ASSERT_NE(arena.alloc(100), nullptr);
+  const usize reserved = arena.bytesReserved();
+  ASSERT_TRUE(reserved >= 100u * 100u);
+
+  arena.reset();
+  ASSERT_TRUE(arena.isEmpty());
+  ASSERT_EQ(arena.bytesReserved(), reserved);
+
+  for (s32 i = 0; i < 100; ++i) ASSERT_NE(arena.alloc(100), nullptr);
+  ASSERT_EQ(arena.bytesReserved(), reserved);
+}
+
+DTEST(scratchArenaLargeAllocation) {
+  dc::ScratchArena arena(1024);
+  auto* data = static_cast<u8*>(arena.alloc(4096));
+  ASSERT_NE(data, nullptr);
+  std::memset(data, 1, 4096);
+  ASSERT_TRUE(arena.bytesReserved() >= 4096u);
+
+  arena.reset();
+  ASSERT_EQ(arena.bytesReserved(), 0u);
+}
+
+DTEST(scratchArenaBacksList) {
+  dc::ScratchArena arena(256);
+  dc::List<s32> list(arena);
+  for (s32 i = 0; i < 1000; ++i) list.add(i);
+
+  s64 sum = 0;
+  for (s32 value : list) sum += value;
+  ASSERT_EQ(sum, 999 * 1000 / 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// currentWorkerArena
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(scratchWorkerArenaOutsideJobIsDefault) {
+  dc::JobSystem js(1);
+  ASSERT_EQ(&dc::currentWorkerArena(), &dc::getDefaultAllocator());
+}
+
+DTEST(scratchWorkerArenaInJob) {
+  dc::JobSystem js(4);
+  std::atomic<s64> sum{0};
+  std::atomic<u32> onArena{0};
+
+  dc::List<dc::Job> jobs;
+  for (s32 i = 0; i < 256; ++i) {
+    jobs.add(dc::Job{[&sum, &onArena, i] {
+      dc::IAllocator& arena = dc::currentWorkerArena();
+      if (&arena != &dc::getDefaultAllocator()) onArena.fetch_add(1);
+
+      dc::List<s32> values(arena);
+      for (s32 j = 0; j <= i; ++j) values.add(j);
+      s64 local = 0;
+      for (s32 value : values) local += value;
+      sum.fetch_add(local);
+    }});
+  }
+  js.add(jobs).await();
+
+  s64 expected = 0;
+  for (s64 i = 0; i < 256; ++i) expected += i * (i + 1) / 2;
+  ASSERT_EQ(sum.load(), expected);
+  ASSERT_EQ(onArena.load(), 256u);
+}
+
+DTEST(scratchWorkerArenaResetBetweenJobs) {
+  dc::JobSystem js(1);
+  std::atomic<usize> usedBefore{~usize{0}};
+
+  dc::List<dc::Job> first;
+  first.add(dc::Job{[] { (void)dc::currentWorkerArena().alloc(512); }});
+  js.add(first).await();
+
+  dc::List<dc::Job> second;
+  second.add(dc::Job{[&usedBefore] {
+    auto& arena = static_cast<dc::ScratchArena&>(dc::currentWorkerArena());
+    usedBefore.store(arena.bytesUsed());
+  }});
+  js.add(second).await();
+
+  ASSERT_EQ(usedBefore.load(), 0u);
+}
+
+DTEST(scratchWorkerArenaKeptWhileJobWaits) {
+  // The outer job waits while other jobs run on the same worker and finish.
+  // Its memory must survive their resets.
+  dc::JobSystemConfig config;
+  config.threadCount = 1;
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 16;
+  dc::JobSystem js(config);
+  std::atomic<bool> intact{false};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&js, &intact] {
+    auto* data = static_cast<u8*>(dc::currentWorkerArena().alloc(256));
+    std::memset(data, 0xab, 256);
+
+    dc::List<dc::Job> children;
+    for (s32 i = 0; i < 16; ++i) {
+      children.add(dc::Job{[] {
+        auto* scratch = static_cast<u8*>(dc::currentWorkerArena().alloc(256));
+        std::memset(scratch, 0, 256);
+      }});
+    }
+    js.add(children).await();
+
+    bool same = true;
+    for (usize i = 0; i < 256; ++i) same = same && data[i] == 0xab;
+    intact.store(same);
+  }});
+  js.add(outer).await();
+
+  ASSERT_TRUE(intact.load());
+}
+
+DTEST(scratchWorkerArenaJobStaysOnItsWorker) {
+  // The job allocates, then waits while its worker is busy with a pinned
+  // job. Resumed on the other worker, it would use the first worker's arena
+  // from there.
+  dc::JobSystemConfig config;
+  config.threadCount = 2;
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 16;
+  dc::JobSystem js(config);
+
+  std::thread::id firstWorker;
+  dc::List<dc::Job> probe;
+  probe.add(dc::Job{
+      [&firstWorker] { firstWorker = std::this_thread::get_id(); }});
+  js.addToWorker(0, probe).await();
+
+  std::atomic<bool> resumed{false};
+  std::atomic<bool> sameArena{false};
+  std::atomic<bool> intact{false};
+
+  dc::List<dc::Job> outer;
+  outer.add(dc::Job{[&] {
+    const u32 self = std::this_thread::get_id() == firstWorker ? 0u : 1u;
+
+    dc::IAllocator& arena = dc::currentWorkerArena();
+    dc::List<s32> values(arena);
+    for (s32 i = 0; i < 64; ++i) values.add(i);
+
+    std::atomic<bool> busy{false};
+    dc::List<dc::Job> child;
+    child.add(dc::Job{[&js, &resumed, &busy, self] {
+      js.addToWorker(self, dc::Job{[&resumed, &busy] {
+        busy.store(true);
+        for (s32 i = 0; i < 100 && !resumed.load(); ++i) dc::sleepMs(1);
+      }});
+      while (!busy.load()) dc::sleepMs(1);
+    }});
+    js.addToWorker(1 - self, child).await();
+    resumed.store(true);
+
+    // Grows the list, on the arena it came from.
+    for (s32 i = 64; i < 256; ++i) values.add(i);
+    bool same = true;
+    for (s32 i = 0; i < 256; ++i) same = same && values[i] == i;
+    intact.store(same);
+    // Not the thread id, which the compiler may keep across the switch.
+    sameArena.store(&dc::currentWorkerArena() == &arena);
+  }});
+  // Not await(), which could run the job on this thread.
+  const dc::JobHandle handle = js.add(outer);
+  while (!handle.isDone()) dc::sleepMs(1);
+
+  ASSERT_TRUE(sameArena.load());
+  ASSERT_TRUE(intact.load());
+}
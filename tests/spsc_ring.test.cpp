@@ -224,6 +224,75 @@ DTEST(spscRingPartialFillWraparound) {
   ASSERT_TRUE(ring.isEmpty());
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bulk operations
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(spscRingAddBulkAndRemoveBulk) {
+  dc::SpscRing<s32> ring(8);
+
+  s32 in[5] = {0, 1, 2, 3, 4};
+  ASSERT_EQ(ring.addBulk(in, 5), 5u);
+  ASSERT_EQ(ring.size(), 5u);
+
+  s32 out[8] = {};
+  ASSERT_EQ(ring.removeBulk(out, 3), 3u);
+  ASSERT_EQ(out[0], 0);
+  ASSERT_EQ(out[1], 1);
+  ASSERT_EQ(out[2], 2);
+
+  // Asking for more than is there returns what is left.
+  ASSERT_EQ(ring.removeBulk(out, 8), 2u);
+  ASSERT_EQ(out[0], 3);
+  ASSERT_EQ(out[1], 4);
+  ASSERT_EQ(ring.removeBulk(out, 8), 0u);
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+DTEST(spscRingAddBulkStopsWhenFull) {
+  dc::SpscRing<s32> ring(4);
+
+  s32 in[6] = {0, 1, 2, 3, 4, 5};
+  ASSERT_EQ(ring.addBulk(in, 6), 4u);
+  ASSERT_TRUE(ring.isFull());
+  ASSERT_EQ(ring.addBulk(in + 4, 2), 0u);
+
+  s32 out[4] = {};
+  ASSERT_EQ(ring.removeBulk(out, 4), 4u);
+  for (s32 i = 0; i < 4; ++i) ASSERT_EQ(out[i], i);
+}
+
+DTEST(spscRingBulkWraparound) {
+  dc::SpscRing<s32> ring(4);
+
+  for (s32 round = 0; round < 10; ++round) {
+    s32 in[3] = {round * 3, round * 3 + 1, round * 3 + 2};
+    ASSERT_EQ(ring.addBulk(in, 3), 3u);
+    s32 out[3] = {};
+    ASSERT_EQ(ring.removeBulk(out, 3), 3u);
+    for (s32 i = 0; i < 3; ++i) ASSERT_EQ(out[i], round * 3 + i);
+  }
+  ASSERT_TRUE(ring.isEmpty());
+}
+
+DTEST(spscRingBulkMixesWithSingleOperations) {
+  dc::SpscRing<dc::String> ring(4);
+
+  dc::String in[2] = {dc::String("a"), dc::String("b")};
+  ASSERT_EQ(ring.addBulk(in, 2), 2u);
+  dc::String c("c");
+  ASSERT_TRUE(ring.add(dc::move(c)));
+
+  const dc::String* first = ring.remove();
+  ASSERT_NE(first, nullptr);
+  ASSERT_EQ(first->toView(), "a");
+
+  dc::String out[4];
+  ASSERT_EQ(ring.removeBulk(out, 4), 2u);
+  ASSERT_EQ(out[0].toView(), "b");
+  ASSERT_EQ(out[1].toView(), "c");
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Non-trivial element type
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -317,3 +386,45 @@ DTEST(spscRingThreadedSmallRingHighContention) {
 
   ASSERT_EQ(consumed.load(std::memory_order_acquire), kItemCount);
 }
+
+DTEST(spscRingThreadedBulkProducerConsumer) {
+  constexpr s32 kItemCount = 10000;
+  constexpr u32 kBatch = 7;
+  dc::SpscRing<s32> ring(16);
+  std::atomic<s32> consumed{0};
+
+  std::thread consumer([&ring, &consumed] {
+    s32 expected = 0;
+    s32 out[kBatch];
+    while (expected < kItemCount) {
+      const u32 removed = ring.removeBulk(out, kBatch);
+      if (removed == 0) std::this_thread::yield();
+      for (u32 i = 0; i < removed; ++i) {
+        if (out[i] != expected) return;
+        ++expected;
+      }
+      consumed.fetch_add(static_cast<s32>(removed), std::memory_order_release);
+    }
+  });
+
+  std::thread producer([&ring] {
+    s32 in[kBatch];
+    for (s32 next = 0; next < kItemCount;) {
+      const u32 count =
+          dc::min(kBatch, static_cast<u32>(kItemCount - next));
+      for (u32 i = 0; i < count; ++i) in[i] = next + static_cast<s32>(i);
+      u32 added = 0;
+      while (added < count) {
+        const u32 n = ring.addBulk(in + added, count - added);
+        if (n == 0) std::this_thread::yield();
+        added += n;
+      }
+      next += static_cast<s32>(count);
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.load(std::memory_order_acquire), kItemCount);
+}
@@ -0,0 +1,193 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/job_system.hpp>
+#include <dc/list.hpp>
+#include <dc/task.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// See dc/task.hpp.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Task
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+dc::Task<s32> answer() { co_return 42; }
+
+dc::Task<s32> addAnswers() {
+  const s32 a = co_await answer();
+  const s32 b = co_await answer();
+  co_return a + b;
+}
+
+dc::Task<s32> recurse(s32 depth) {
+  if (depth == 0) co_return 0;
+  co_return 1 + co_await recurse(depth - 1);
+}
+
+}  // namespace
+
+DTEST(taskReturnsValue) {
+  dc::JobSystem js(2);
+  ASSERT_EQ(dc::syncAwait(js, answer()), 42);
+}
+
+DTEST(taskAwaitsOtherTasks) {
+  dc::JobSystem js(2);
+  ASSERT_EQ(dc::syncAwait(js, addAnswers()), 84);
+}
+
+DTEST(taskDeepChain) {
+  // Each level starts its child, and completes straight into its parent,
+  // without going through the JobSystem.
+  dc::JobSystem js(1);
+  ASSERT_EQ(dc::syncAwait(js, recurse(1'000)), 1'000);
+}
+
+DTEST(taskMoveOnlyResult) {
+  dc::JobSystem js(2);
+  auto make = []() -> dc::Task<std::unique_ptr<s32>> {
+    co_return std::make_unique<s32>(7);
+  };
+  std::unique_ptr<s32> value = dc::syncAwait(js, make());
+  ASSERT_TRUE(value != nullptr);
+  ASSERT_EQ(*value, 7);
+}
+
+DTEST(taskNotAwaitedIsDestroyed) {
+  // The frame holds the shared_ptr copy, destroying the task must free it.
+  auto shared = std::make_shared<s32>(1);
+  {
+    auto make = [](std::shared_ptr<s32> held) -> dc::Task<void> {
+      (void)held;
+      co_return;
+    };
+    dc::Task<void> task = make(shared);
+    ASSERT_EQ(shared.use_count(), 2);
+  }
+  ASSERT_EQ(shared.use_count(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Awaitables
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(taskScheduleOnMovesToWorker) {
+  dc::JobSystem js(2);
+  const std::thread::id caller = std::this_thread::get_id();
+
+  auto body = [](dc::JobSystem& system) -> dc::Task<std::thread::id> {
+    co_await dc::scheduleOn(system, dc::JobPriority::High);
+    co_return std::this_thread::get_id();
+  };
+  ASSERT_TRUE(dc::syncAwait(js, body(js)) != caller);
+}
+
+DTEST(taskAwaitsJobHandle) {
+  dc::JobSystem js(4);
+  std::atomic<s32> counter{0};
+
+  auto body = [](dc::JobSystem& system,
+                 std::atomic<s32>& count) -> dc::Task<s32> {
+    dc::List<dc::Job> jobs;
+    for (s32 i = 0; i < 100; ++i) {
+      jobs.add(dc::Job{
+          [&count] { count.fetch_add(1, std::memory_order_relaxed); }});
+    }
+    co_await system.add(jobs);
+    // Everything in the batch is visible once we resume.
+    co_return count.load(std::memory_order_relaxed);
+  };
+
+  ASSERT_EQ(dc::syncAwait(js, body(js, counter)), 100);
+}
+
+DTEST(taskAwaitsEmptyHandle) {
+  dc::JobSystem js(1);
+  auto body = []() -> dc::Task<s32> {
+    co_await dc::JobHandle{};
+    co_return 1;
+  };
+  ASSERT_EQ(dc::syncAwait(js, body()), 1);
+}
+
+DTEST(taskSuspendedDoesNotHoldWorker) {
+  // Many more tasks than workers, all suspended on the same gate. If a waiting
+  // task held on to its worker the job opening the gate could never run.
+  dc::JobSystem js(2);
+  auto gate = std::make_shared<dc::JobCounter>(1u, &js);
+  std::atomic<s32> resumed{0};
+
+  auto body = [](dc::JobHandle wait,
+                 std::atomic<s32>& count) -> dc::Task<void> {
+    co_await wait;
+    count.fetch_add(1, std::memory_order_relaxed);
+  };
+
+  std::vector<dc::JobHandle> tasks;
+  for (s32 i = 0; i < 64; ++i) {
+    tasks.push_back(dc::spawn(js, body(dc::JobHandle{gate}, resumed)));
+  }
+  ASSERT_EQ(resumed.load(), 0);
+
+  // Poll rather than await, so that this thread can not be the one running
+  // the job.
+  dc::List<dc::Job> open;
+  open.add(dc::Job{[gate] { gate->decrement(); }});
+  dc::JobHandle opened = js.add(open);
+  while (!opened.isDone()) std::this_thread::yield();
+
+  for (const dc::JobHandle& task : tasks) task.await();
+  ASSERT_EQ(resumed.load(), 64);
+}
+
+DTEST(taskSpawnHandleChains) {
+  dc::JobSystem js(2);
+  std::atomic<s32> order{0};
+  std::atomic<s32> taskAt{-1};
+  std::atomic<s32> thenAt{-1};
+
+  auto body = [](std::atomic<s32>& counter,
+                 std::atomic<s32>& at) -> dc::Task<void> {
+    at.store(counter.fetch_add(1));
+    co_return;
+  };
+
+  dc::spawn(js, body(order, taskAt))
+      .then(dc::Job{[&order, &thenAt] { thenAt.store(order.fetch_add(1)); }})
+      .await();
+
+  ASSERT_EQ(taskAt.load(), 0);
+  ASSERT_EQ(thenAt.load(), 1);
+}
@@ -0,0 +1,196 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/job/cancellation_token.hpp>
+#include <dc/job_system.hpp>
+#include <dc/task_group.hpp>
+#include <dc/time.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+u64 fibSerial(u32 n) { return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2); }
+
+/// Fork-join fibonacci, one child per level.
+u64 fib(dc::JobSystem& js, u32 n) {
+  if (n < 12) return fibSerial(n);
+  u64 a = 0;
+  dc::TaskGroup group(js);
+  group.run([&js, &a, n] { a = fib(js, n - 1); });
+  const u64 b = fib(js, n - 2);
+  group.wait();
+  return a + b;
+}
+
+/// Sums [begin, end) by splitting it in halves down to single elements.
+void sumRange(dc::JobSystem& js, const std::vector<u32>& values, usize begin,
+              usize end, std::atomic<u64>& sum) {
+  if (end - begin == 1) {
+    sum.fetch_add(values[begin], std::memory_order_relaxed);
+    return;
+  }
+  const usize mid = begin + (end - begin) / 2;
+  dc::TaskGroup group(js);
+  group.run([&js, &values, &sum, begin, mid] {
+    sumRange(js, values, begin, mid, sum);
+  });
+  group.run(
+      [&js, &values, &sum, mid, end] { sumRange(js, values, mid, end, sum); });
+}
+
+/// Each child spawns two more into the same group until depth is 0.
+void spread(dc::TaskGroup& group, s32 depth, std::atomic<s32>& ran) {
+  ran.fetch_add(1, std::memory_order_relaxed);
+  if (depth == 0) return;
+  group.run([&group, &ran, depth] { spread(group, depth - 1, ran); });
+  group.run([&group, &ran, depth] { spread(group, depth - 1, ran); });
+}
+
+}  // namespace
+
+DTEST(taskGroupRunsEveryChild) {
+  dc::JobSystem js(4);
+  std::atomic<s32> ran{0};
+
+  dc::TaskGroup group(js);
+  for (s32 i = 0; i < 1000; ++i) {
+    group.run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+  }
+  group.wait();
+
+  ASSERT_EQ(ran.load(), 1000);
+}
+
+DTEST(taskGroupWaitWithoutChildren) {
+  dc::JobSystem js(2);
+  dc::TaskGroup group(js);
+  group.wait();
+  group.wait();
+  ASSERT_TRUE(true);
+}
+
+DTEST(taskGroupRecursiveFib) {
+  dc::JobSystem js(4);
+  ASSERT_EQ(fib(js, 24), fibSerial(24));
+}
+
+DTEST(taskGroupDestructorWaits) {
+  dc::JobSystem js(4);
+  constexpr usize kCount = 1 << 14;
+  std::vector<u32> values(kCount);
+  u64 expected = 0;
+  for (usize i = 0; i < kCount; ++i) {
+    values[i] = static_cast<u32>(i * 7 % 13);
+    expected += values[i];
+  }
+
+  // sumRange never calls wait(), its groups wait when they go out of scope.
+  std::atomic<u64> sum{0};
+  sumRange(js, values, 0, kCount, sum);
+
+  ASSERT_EQ(sum.load(), expected);
+}
+
+DTEST(taskGroupChildrenSpawnIntoSameGroup) {
+  dc::JobSystem js(4);
+  std::atomic<s32> ran{0};
+
+  dc::TaskGroup group(js);
+  group.run([&group, &ran] { spread(group, 10, ran); });
+  group.wait();
+
+  ASSERT_EQ(ran.load(), (1 << 11) - 1);
+}
+
+DTEST(taskGroupReusedAfterWait) {
+  dc::JobSystem js(2);
+  std::atomic<s32> ran{0};
+  dc::TaskGroup group(js);
+
+  for (s32 round = 1; round <= 3; ++round) {
+    for (s32 i = 0; i < 10; ++i) {
+      group.run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+    }
+    group.wait();
+    ASSERT_EQ(ran.load(), round * 10);
+  }
+}
+
+DTEST(taskGroupWaitFromManyThreads) {
+  dc::JobSystem js(2);
+  std::atomic<s32> ran{0};
+
+  std::vector<std::thread> threads;
+  for (s32 t = 0; t < 4; ++t) {
+    threads.emplace_back([&js, &ran] {
+      dc::TaskGroup group(js);
+      for (s32 i = 0; i < 100; ++i) {
+        group.run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+      }
+      group.wait();
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  ASSERT_EQ(ran.load(), 400);
+}
+
+DTEST(taskGroupCancelSkipsUnstartedChildren) {
+  dc::JobSystem js(1);
+  const dc::CancellationToken token = dc::CancellationToken::create();
+  std::atomic<bool> started{false};
+  std::atomic<bool> release{false};
+  std::atomic<s32> ran{0};
+
+  // Keeps the only worker busy until the other children are cancelled.
+  dc::TaskGroup group(js, token);
+  group.run([&started, &release] {
+    started.store(true);
+    while (!release.load()) dc::sleepMs(1);
+  });
+  while (!started.load()) dc::sleepMs(1);
+  for (s32 i = 0; i < 10; ++i) {
+    group.run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+  }
+  token.cancel();
+  release.store(true);
+  group.wait();
+
+  ASSERT_TRUE(group.isCancelled());
+  ASSERT_EQ(ran.load(), 0);
+}
+
+DTEST(taskGroupRecursiveFibOnFibers) {
+  dc::JobSystemConfig config;
+  config.threadCount = 4;
+  config.fibers.enabled = true;
+  config.fibers.maxFibers = 64;
+  dc::JobSystem js(config);
+
+  ASSERT_EQ(fib(js, 22), fibSerial(22));
+}
@@ -24,6 +24,27 @@ DTEST(getTimeUsNoReorder) {
   ASSERT_TRUE(net > 0);
 }
 
+DTEST(getTimeNsCountsNanoseconds) {
+  const u64 beforeNs = dc::getTimeNs();
+  dc::sleepMs(50);
+  const u64 net = dc::getTimeNs() - beforeNs;
+
+  ASSERT_TRUE(net >= 40'000'000);
+  ASSERT_TRUE(net < 1'000'000'000);
+}
+
+DTEST(getTimeNsIsMonotonic) {
+  // Long enough to cross into the next second.
+  u64 previousNs = dc::getTimeNs();
+  const u64 endNs = previousNs + 1'100'000'000;
+  while (previousNs < endNs) {
+    dc::sleepMs(1);
+    const u64 nowNs = dc::getTimeNs();
+    ASSERT_TRUE(nowNs >= previousNs);
+    previousNs = nowNs;
+  }
+}
+
 DTEST(timestamp) {
   const auto a = dc::makeTimestamp();
   std::atomic_signal_fence(
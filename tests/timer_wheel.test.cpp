@@ -0,0 +1,286 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <dc/dtest.hpp>
+#include <dc/job/timer_wheel.hpp>
+#include <dc/list.hpp>
+
+namespace {
+
+/// A job that records the tag when run.
+dc::Job tagJob(dc::List<s32>& ran, s32 tag) {
+  return dc::Job{[&ran, tag] { ran.add(tag); }};
+}
+
+/// Advance the wheel and run what came due, in order.
+void advanceAndRun(dc::TimerWheel& wheel, u64 nowTick) {
+  dc::List<dc::Job> due;
+  dc::List<dc::DuePeriodicTimer> duePeriodic;
+  wheel.advance(nowTick, due, duePeriodic);
+  for (dc::Job& job : due) job.fn();
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// add / advance
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(timerWheelEmpty) {
+  dc::TimerWheel wheel;
+  ASSERT_EQ(wheel.size(), 0u);
+  ASSERT_EQ(wheel.nextTick(), dc::TimerWheel::kNever);
+
+  advanceAndRun(wheel, 1000);
+  ASSERT_EQ(wheel.currentTick(), 1001u);
+}
+
+DTEST(timerWheelFiresAtDeadline) {
+  dc::TimerWheel wheel;
+  dc::List<s32> ran;
+  const dc::TimerId id = wheel.add(10, tagJob(ran, 1));
+  ASSERT_TRUE(id.isValid());
+  ASSERT_EQ(wheel.size(), 1u);
+  ASSERT_EQ(wheel.nextTick(), 10u);
+
+  advanceAndRun(wheel, 9);
+  ASSERT_TRUE(ran.isEmpty());
+
+  advanceAndRun(wheel, 10);
+  ASSERT_EQ(ran.getSize(), 1u);
+  ASSERT_EQ(wheel.size(), 0u);
+  ASSERT_EQ(wheel.nextTick(), dc::TimerWheel::kNever);
+}
+
+DTEST(timerWheelPastDeadlineFiresNext) {
+  dc::TimerWheel wheel(100);
+  dc::List<s32> ran;
+  wheel.add(5, tagJob(ran, 1));
+  ASSERT_EQ(wheel.nextTick(), 100u);
+
+  advanceAndRun(wheel, 100);
+  ASSERT_EQ(ran.getSize(), 1u);
+}
+
+DTEST(timerWheelFiresInDeadlineOrder) {
+  // Deadlines on every level, including past the end of the wheel.
+  const u64 deadlines[] = {3,          63,        64,         65,
+                           4095,       4096,      300'000,    17'000'000,
+                           1ull << 36, 1ull << 40};
+
+  dc::TimerWheel wheel;
+  dc::List<s32> ran;
+  for (s32 i = 9; i >= 0; --i) wheel.add(deadlines[i], tagJob(ran, i));
+
+  for (s32 i = 0; i < 10; ++i) {
+    const u64 deadline = deadlines[i];
+    ASSERT_TRUE(wheel.nextTick() <= deadline);
+
+    advanceAndRun(wheel, deadline - 1);
+    ASSERT_EQ(ran.getSize(), static_cast<usize>(i));
+
+    advanceAndRun(wheel, deadline);
+    ASSERT_EQ(ran.getSize(), static_cast<usize>(i + 1));
+    ASSERT_EQ(ran.getLast(), i);
+  }
+  ASSERT_EQ(wheel.size(), 0u);
+}
+
+DTEST(timerWheelLargeStep) {
+  // Everything due in one long advance, as after an idle stretch.
+  dc::TimerWheel wheel(7);
+  dc::List<s32> ran;
+  for (s32 i = 0; i < 1000; ++i) {
+    wheel.add(7 + static_cast<u64>(i) * 997, tagJob(ran, i));
+  }
+
+  advanceAndRun(wheel, 7 + 999 * 997);
+  ASSERT_EQ(ran.getSize(), 1000u);
+  for (s32 i = 0; i < 1000; ++i) ASSERT_EQ(ran[static_cast<usize>(i)], i);
+}
+
+DTEST(timerWheelRandomDeadlines) {
+  // Compare against the deadlines themselves, with steps of every size.
+  dc::TimerWheel wheel;
+  dc::List<u64> deadlines;
+  dc::List<u64> firedAt;
+  dc::List<u64> firedAfter;
+  u64 now = 0;
+  u64 before = 0;
+
+  u64 seed = 12345;
+  auto next = [&seed] {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return seed >> 33;
+  };
+
+  for (s32 i = 0; i < 2000; ++i) {
+    const u64 deadline = now + (next() % 3 == 0 ? next() % 100 : next());
+    const usize index = deadlines.getSize();
+    deadlines.add(deadline);
+    firedAt.add(dc::TimerWheel::kNever);
+    firedAfter.add(0);
+    wheel.add(deadline, dc::Job{[&firedAt, &firedAfter, &now, &before, index] {
+      firedAt[index] = now;
+      firedAfter[index] = before;
+    }});
+  }
+
+  while (wheel.size() > 0) {
+    const u64 lowerBound = wheel.nextTick();
+    before = now;
+    now += next() % 3 == 0 ? next() % 70 : next() % 100'000'000;
+
+    dc::List<dc::Job> due;
+    dc::List<dc::DuePeriodicTimer> duePeriodic;
+    wheel.advance(now, due, duePeriodic);
+    for (dc::Job& job : due) job.fn();
+
+    // Nothing fired before the bound said it could.
+    if (lowerBound > now) ASSERT_TRUE(due.isEmpty());
+  }
+
+  // Each fired in the first advance that reached its deadline.
+  for (usize i = 0; i < deadlines.getSize(); ++i) {
+    ASSERT_TRUE(firedAt[i] >= deadlines[i]);
+    ASSERT_TRUE(firedAfter[i] < deadlines[i] || deadlines[i] == 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// cancel
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(timerWheelCancel) {
+  dc::TimerWheel wheel;
+  dc::List<s32> ran;
+  const dc::TimerId a = wheel.add(10, tagJob(ran, 1));
+  const dc::TimerId b = wheel.add(10, tagJob(ran, 2));
+  const dc::TimerId c = wheel.add(5000, tagJob(ran, 3));
+
+  ASSERT_TRUE(wheel.cancel(a));
+  ASSERT_FALSE(wheel.cancel(a));
+  ASSERT_TRUE(wheel.cancel(c));
+  ASSERT_EQ(wheel.size(), 1u);
+
+  advanceAndRun(wheel, 10'000);
+  ASSERT_EQ(ran.getSize(), 1u);
+  ASSERT_EQ(ran[0], 2);
+
+  // Fired, so it is gone.
+  ASSERT_FALSE(wheel.cancel(b));
+  ASSERT_FALSE(wheel.cancel(dc::TimerId{}));
+}
+
+DTEST(timerWheelReusedNodeHasNewId) {
+  dc::TimerWheel wheel;
+  dc::List<s32> ran;
+  const dc::TimerId first = wheel.add(10, tagJob(ran, 1));
+  ASSERT_TRUE(wheel.cancel(first));
+
+  const dc::TimerId second = wheel.add(10, tagJob(ran, 2));
+  ASSERT_TRUE(first.value != second.value);
+  ASSERT_FALSE(wheel.cancel(first));
+
+  advanceAndRun(wheel, 10);
+  ASSERT_EQ(ran.getSize(), 1u);
+  ASSERT_EQ(ran[0], 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Periodic
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(timerWheelPeriodic) {
+  dc::TimerWheel wheel;
+  s32 runs = 0;
+  const dc::TimerId id =
+      wheel.add(100, dc::Job{[&runs] { ++runs; }}, 100);
+
+  dc::List<dc::Job> due;
+  dc::List<dc::DuePeriodicTimer> duePeriodic;
+  for (u64 now = 100; now <= 500; now += 100) {
+    wheel.advance(now - 1, due, duePeriodic);
+    ASSERT_TRUE(duePeriodic.isEmpty());
+
+    wheel.advance(now, due, duePeriodic);
+    ASSERT_TRUE(due.isEmpty());
+    ASSERT_EQ(duePeriodic.getSize(), 1u);
+    ASSERT_EQ(duePeriodic[0].id.value, id.value);
+    duePeriodic.clear();
+
+    dc::Job job;
+    ASSERT_TRUE(wheel.takePeriodic(id, job));
+    job.fn();
+    ASSERT_TRUE(wheel.rearm(id, dc::move(job), now));
+  }
+  ASSERT_EQ(runs, 5);
+
+  // Late by two and a half periods, the missed runs are skipped.
+  wheel.advance(850, due, duePeriodic);
+  ASSERT_EQ(duePeriodic.getSize(), 1u);
+  duePeriodic.clear();
+  dc::Job job;
+  ASSERT_TRUE(wheel.takePeriodic(id, job));
+  ASSERT_TRUE(wheel.rearm(id, dc::move(job), 850));
+
+  wheel.advance(899, due, duePeriodic);
+  ASSERT_TRUE(duePeriodic.isEmpty());
+  wheel.advance(900, due, duePeriodic);
+  ASSERT_EQ(duePeriodic.getSize(), 1u);
+
+  ASSERT_TRUE(wheel.cancel(id));
+  ASSERT_EQ(wheel.size(), 0u);
+}
+
+DTEST(timerWheelCancelPeriodicWhileRunning) {
+  dc::TimerWheel wheel;
+  const dc::TimerId id = wheel.add(10, dc::Job{[] {}}, 10);
+
+  dc::List<dc::Job> due;
+  dc::List<dc::DuePeriodicTimer> duePeriodic;
+  wheel.advance(10, due, duePeriodic);
+  ASSERT_EQ(duePeriodic.getSize(), 1u);
+
+  dc::Job job;
+  ASSERT_TRUE(wheel.takePeriodic(id, job));
+  ASSERT_TRUE(wheel.cancel(id));
+  ASSERT_FALSE(wheel.rearm(id, dc::move(job), 10));
+  ASSERT_EQ(wheel.size(), 0u);
+  ASSERT_EQ(wheel.nextTick(), dc::TimerWheel::kNever);
+}
+
+DTEST(timerWheelCancelPeriodicWhileDue) {
+  dc::TimerWheel wheel;
+  const dc::TimerId id = wheel.add(10, dc::Job{[] {}}, 10);
+
+  dc::List<dc::Job> due;
+  dc::List<dc::DuePeriodicTimer> duePeriodic;
+  wheel.advance(10, due, duePeriodic);
+  ASSERT_TRUE(wheel.cancel(id));
+
+  dc::Job job;
+  ASSERT_FALSE(wheel.takePeriodic(id, job));
+}
@@ -0,0 +1,201 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2026 Christoffer Gustafsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <dc/dtest.hpp>
+#include <dc/work_stealing_deque.hpp>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(workStealingDequeConstructor) {
+  dc::WorkStealingDeque<s32> deque(4);
+  ASSERT_TRUE(deque.isEmpty());
+  ASSERT_EQ(deque.size(), 0u);
+  ASSERT_EQ(deque.capacity(), 4u);
+}
+
+DTEST(workStealingDequeRoundsUpCapacityToPowerOfTwo) {
+  dc::WorkStealingDeque<s32> deque(5);
+  ASSERT_EQ(deque.capacity(), 8u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// push / pop / steal
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(workStealingDequePopIsLIFO) {
+  dc::WorkStealingDeque<s32> deque(8);
+  s32 values[] = {0, 1, 2, 3, 4};
+
+  for (s32& v : values) deque.push(&v);
+  ASSERT_EQ(deque.size(), 5u);
+
+  for (s32 i = 4; i >= 0; --i) {
+    const s32* out = deque.pop();
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(*out, i);
+  }
+  ASSERT_TRUE(deque.isEmpty());
+}
+
+DTEST(workStealingDequeStealIsFIFO) {
+  dc::WorkStealingDeque<s32> deque(8);
+  s32 values[] = {0, 1, 2, 3, 4};
+
+  for (s32& v : values) deque.push(&v);
+
+  for (s32 i = 0; i < 5; ++i) {
+    const s32* out = deque.steal();
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(*out, i);
+  }
+  ASSERT_TRUE(deque.isEmpty());
+}
+
+DTEST(workStealingDequeReturnsNullptrWhenEmpty) {
+  dc::WorkStealingDeque<s32> deque(4);
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+
+  s32 v = 7;
+  deque.push(&v);
+  ASSERT_EQ(deque.pop(), &v);
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+}
+
+DTEST(workStealingDequePopAndStealFromBothEnds) {
+  dc::WorkStealingDeque<s32> deque(8);
+  s32 values[] = {0, 1, 2, 3};
+
+  for (s32& v : values) deque.push(&v);
+
+  ASSERT_EQ(deque.steal(), &values[0]);
+  ASSERT_EQ(deque.pop(), &values[3]);
+  ASSERT_EQ(deque.steal(), &values[1]);
+  ASSERT_EQ(deque.pop(), &values[2]);
+  ASSERT_TRUE(deque.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Growth
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(workStealingDequeGrowsWhenFull) {
+  dc::WorkStealingDeque<s32> deque(2);
+  s32 values[16];
+
+  for (s32 i = 0; i < 16; ++i) {
+    values[i] = i;
+    deque.push(&values[i]);
+  }
+  ASSERT_EQ(deque.size(), 16u);
+  ASSERT_TRUE(deque.capacity() >= 16u);
+
+  // Growing must preserve both ends.
+  ASSERT_EQ(deque.steal(), &values[0]);
+  for (s32 i = 15; i >= 1; --i) {
+    ASSERT_EQ(deque.pop(), &values[i]);
+  }
+  ASSERT_TRUE(deque.isEmpty());
+}
+
+DTEST(workStealingDequeWraparound) {
+  dc::WorkStealingDeque<s32> deque(4);
+  s32 values[4] = {0, 1, 2, 3};
+
+  // Steal moves top forward, so repeated push/steal walks the indices around
+  // the buffer many times without growing.
+  for (s32 round = 0; round < 50; ++round) {
+    for (s32& v : values) deque.push(&v);
+    for (s32 i = 0; i < 4; ++i) {
+      ASSERT_EQ(deque.steal(), &values[i]);
+    }
+  }
+  ASSERT_EQ(deque.capacity(), 4u);
+  ASSERT_TRUE(deque.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread safety: one owner, many thieves
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DTEST(workStealingDequeThreadedOwnerAndThieves) {
+  // Every element must be taken exactly once, either by the owner or by one
+  // of the thieves, even while the buffer grows underneath the thieves.
+  constexpr s32 kItemCount = 20000;
+  constexpr s32 kThieves = 3;
+
+  dc::WorkStealingDeque<s32> deque(4);
+  std::vector<s32> items(kItemCount);
+  std::vector<std::atomic<s32>> taken(kItemCount);
+  for (s32 i = 0; i < kItemCount; ++i) {
+    items[static_cast<usize>(i)] = i;
+    taken[static_cast<usize>(i)].store(0, std::memory_order_relaxed);
+  }
+
+  std::atomic<s32> takenCount{0};
+  std::atomic<bool> done{false};
+
+  auto take = [&taken, &takenCount](const s32* item) {
+    taken[static_cast<usize>(*item)].fetch_add(1, std::memory_order_relaxed);
+    takenCount.fetch_add(1, std::memory_order_relaxed);
+  };
+
+  std::vector<std::thread> thieves;
+  for (s32 t = 0; t < kThieves; ++t) {
+    thieves.emplace_back([&deque, &done, &take] {
+      while (!done.load(std::memory_order_acquire)) {
+        if (const s32* item = deque.steal()) take(item);
+      }
+    });
+  }
+
+  for (s32 i = 0; i < kItemCount; ++i) {
+    deque.push(&items[static_cast<usize>(i)]);
+    // Pop now and then so the owner races the thieves on both ends.
+    if (i % 3 == 0) {
+      if (const s32* item = deque.pop()) take(item);
+    }
+  }
+  while (const s32* item = deque.pop()) take(item);
+
+  // The deque is empty from the owner's side, but a thief may still hold an
+  // element it has not counted yet.
+  while (takenCount.load(std::memory_order_relaxed) < kItemCount) {
+    std::this_thread::yield();
+  }
+  done.store(true, std::memory_order_release);
+  for (auto& thief : thieves) thief.join();
+
+  ASSERT_EQ(takenCount.load(std::memory_order_relaxed), kItemCount);
+  for (s32 i = 0; i < kItemCount; ++i) {
+    ASSERT_EQ(taken[static_cast<usize>(i)].load(std::memory_order_relaxed), 1);
+  }
+}